@@ -11,19 +11,24 @@ CONFIG += c++11
 source_dir = src
 forms_dir = ui
 
+include($${source_dir}/engine/engine.pri)
+
 SOURCES += \
     $${source_dir}/main.cpp \
     $${source_dir}/mainwindow.cpp \
     $${source_dir}/Building.cpp \
     $${source_dir}/Elevator.cpp \
-    $${source_dir}/DataButton.cpp
+    $${source_dir}/DataButton.cpp \
+    $${source_dir}/ButtonDelegate.cpp \
+    $${source_dir}/EventLogModel.cpp
 
 HEADERS += \
     $${source_dir}/mainwindow.h \
     $${source_dir}/Building.h \
     $${source_dir}/Elevator.h \
-    $${source_dir}/DataButton.h
-    $${source_dir}/Direction.h
+    $${source_dir}/DataButton.h \
+    $${source_dir}/ButtonDelegate.h \
+    $${source_dir}/EventLogModel.h
 
 FORMS += \
     $${forms_dir}/mainwindow.ui
@@ -0,0 +1,47 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "BenchRunner.h"
+
+/* Replacement global allocation functions counting heap allocations, so
+ * benchmarks can report allocations per operation. Atomic, since the Monte
+ * Carlo cases allocate from several threads. */
+
+namespace {
+
+std::atomic<unsigned long long> allocationCount(0);
+
+void *countedAlloc(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+}  // namespace
+
+unsigned long long benchAllocations() { return allocationCount; }
+
+void *operator new(std::size_t size) {
+    void *ptr = countedAlloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void *operator new[](std::size_t size) {
+    void *ptr = countedAlloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return countedAlloc(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
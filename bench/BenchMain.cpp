@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "BenchRunner.h"
+
+#ifdef BENCH_MODEL
+#include <QApplication>
+#endif
+
+/* Benchmark suite entry point.
+ *
+ * Usage: bench [--quick] [--filter NAME] [--min-time MS] [--json FILE]
+ *              [--csv FILE]
+ *
+ *  --quick      Small grid and short runs, for a fast sanity check.
+ *  --filter     Only run cases whose name contains NAME.
+ *  --min-time   Minimum duration of each timed run, in ms (default 50).
+ *  --json/--csv Also write every result to FILE, to compare builds. */
+
+// Benchmark cases, one function per source file.
+bool runHallCallBenchmarks(BenchRunner &, const BenchRunner::Grid &);
+void runDispatchBenchmarks(BenchRunner &, const BenchRunner::Grid &);
+void runFleetBenchmarks(BenchRunner &, bool quick);
+bool runEtaMatrixBenchmarks(BenchRunner &, bool quick);
+void runMonteCarloBenchmarks(BenchRunner &, bool quick);
+void runMotionBenchmarks(BenchRunner &, bool quick);
+bool runPolicyBenchmarks(BenchRunner &, const BenchRunner::Grid &);
+#ifdef BENCH_MODEL
+void runModelBenchmarks(BenchRunner &, const BenchRunner::Grid &);
+#endif
+
+namespace {
+
+bool writeResults(const BenchRunner &runner, const std::string &path,
+                  bool json) {
+    if (path.empty()) return true;
+
+    std::ofstream out(path);
+    if (json)
+        runner.writeJson(out);
+    else
+        runner.writeCsv(out);
+
+    if (!out) {
+        std::fprintf(stderr, "Could not write %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+#ifdef BENCH_MODEL
+    // The model needs widgets, but never shows them.
+    if (!std::getenv("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+#endif
+
+    bool quick = false;
+    double minTimeMs = 50;
+    std::string filter, jsonPath, csvPath;
+
+    for (int a_ind = 1; a_ind < argc; ++a_ind) {
+        const char *arg = argv[a_ind];
+        bool hasValue = a_ind + 1 < argc;
+
+        if (!std::strcmp(arg, "--quick")) {
+            quick = true;
+        } else if (!std::strcmp(arg, "--filter") && hasValue) {
+            filter = argv[++a_ind];
+        } else if (!std::strcmp(arg, "--min-time") && hasValue) {
+            minTimeMs = std::atof(argv[++a_ind]);
+        } else if (!std::strcmp(arg, "--json") && hasValue) {
+            jsonPath = argv[++a_ind];
+        } else if (!std::strcmp(arg, "--csv") && hasValue) {
+            csvPath = argv[++a_ind];
+        } else {
+            std::fprintf(stderr,
+                         "Usage: %s [--quick] [--filter NAME] [--min-time MS] "
+                         "[--json FILE] [--csv FILE]\n",
+                         argv[0]);
+            return 2;
+        }
+    }
+
+    BenchRunner::Grid grid;
+    if (quick) {
+        grid = {{10, 1000}, {1, 16}, {0.1}};
+        minTimeMs = std::min(minTimeMs, 5.0);
+    } else {
+        grid = {{10, 100, 1000, 10000}, {1, 4, 16, 64, 256},
+                {0.01, 0.1, 0.5}};
+    }
+
+    BenchRunner runner(minTimeMs);
+    runner.setFilter(filter);
+
+    std::printf("%-20s %-13s %6s %4s %6s %14s %10s\n", "benchmark", "variant",
+                "floors", "cars", "calls", "ns/op", "allocs/op");
+
+    if (!runHallCallBenchmarks(runner, grid)) {
+        std::fprintf(stderr, "Hall call scan and index disagree\n");
+        return 1;
+    }
+    runDispatchBenchmarks(runner, grid);
+    runFleetBenchmarks(runner, quick);
+    if (!runEtaMatrixBenchmarks(runner, quick)) {
+        std::fprintf(stderr, "ETA matrix kernel and estimate disagree\n");
+        return 1;
+    }
+    runMonteCarloBenchmarks(runner, quick);
+    runMotionBenchmarks(runner, quick);
+    if (!runPolicyBenchmarks(runner, grid)) {
+        std::fprintf(stderr, "Dispatch policy and previous path disagree\n");
+        return 1;
+    }
+#ifdef BENCH_MODEL
+    runModelBenchmarks(runner, grid);
+#endif
+
+    if (!writeResults(runner, jsonPath, true) ||
+        !writeResults(runner, csvPath, false))
+        return 1;
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "BenchRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+volatile long long sink;
+
+double elapsedMs(Clock::time_point start) {
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    return elapsed.count();
+}
+
+// Names and variants are plain identifiers, but escape anyway.
+std::string jsonString(const std::string &text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+}  // namespace
+
+void benchSink(long long value) { sink = value; }
+
+int BenchRunner::Grid::callsFor(int floorCount, double density) {
+    return std::max(1, int(std::lround(floorCount * density)));
+}
+
+BenchRunner::BenchRunner(double minTimeMs) : minTimeMs(minTimeMs) {}
+
+void BenchRunner::setFilter(const std::string &newFilter) {
+    filter = newFilter;
+}
+
+bool BenchRunner::selected(const std::string &name) const {
+    return filter.empty() || name.find(filter) != std::string::npos;
+}
+
+void BenchRunner::run(const std::string &name, const Params &params,
+                      const Body &body) {
+    if (!selected(name)) return;
+
+    // Warm up, then grow the iteration count until a run is long enough.
+    body(1);
+    long long iterations = 1;
+    double ms = 0;
+    for (;;) {
+        Clock::time_point start = Clock::now();
+        body(iterations);
+        ms = elapsedMs(start);
+        if (ms >= minTimeMs / 10) break;
+        iterations *= 10;
+    }
+
+    // Timed run, scaled from the calibration to reach the minimum time.
+    if (ms < minTimeMs)
+        iterations = (long long)std::ceil(iterations * minTimeMs /
+                                          std::max(ms, 1e-3));
+
+    unsigned long long allocationsBefore = benchAllocations();
+    Clock::time_point start = Clock::now();
+    body(iterations);
+    ms = elapsedMs(start);
+    unsigned long long allocations = benchAllocations() - allocationsBefore;
+
+    Result result{name, params, iterations, ms * 1e6 / iterations,
+                  double(allocations) / iterations};
+    results.push_back(result);
+
+    std::printf("%-20s %-13s %6d %4d %6d %14.1f %10.2f\n", name.c_str(),
+                params.variant.c_str(), params.floors, params.cars,
+                params.calls, result.nsPerOp, result.allocsPerOp);
+    std::fflush(stdout);
+}
+
+const std::vector<BenchRunner::Result> &BenchRunner::getResults() const {
+    return results;
+}
+
+void BenchRunner::writeJson(std::ostream &out) const {
+    out << "{\n  \"results\": [";
+    for (size_t r_ind = 0; r_ind < results.size(); ++r_ind) {
+        const Result &result = results[r_ind];
+        out << (r_ind ? ",\n" : "\n") << "    {\"name\": "
+            << jsonString(result.name)
+            << ", \"variant\": " << jsonString(result.params.variant)
+            << ", \"floors\": " << result.params.floors
+            << ", \"cars\": " << result.params.cars
+            << ", \"calls\": " << result.params.calls
+            << ", \"ops\": " << result.ops
+            << ", \"ns_per_op\": " << result.nsPerOp
+            << ", \"allocs_per_op\": " << result.allocsPerOp << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+void BenchRunner::writeCsv(std::ostream &out) const {
+    out << "name,variant,floors,cars,calls,ops,ns_per_op,allocs_per_op\n";
+    for (const Result &result : results)
+        out << result.name << ',' << result.params.variant << ','
+            << result.params.floors << ',' << result.params.cars << ','
+            << result.params.calls << ',' << result.ops << ','
+            << result.nsPerOp << ',' << result.allocsPerOp << '\n';
+}
@@ -0,0 +1,109 @@
+#ifndef BENCHRUNNER_H
+#define BENCHRUNNER_H
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/** Times benchmark cases and collects their results.
+ *
+ * Each case is a body running its operation a given number of times. The
+ * runner grows the count until a run takes long enough to time reliably,
+ * then reports the time and heap allocations per operation of that run.
+ * Results are printed as they come, and can be written as JSON or CSV to
+ * compare builds.
+ *
+ * Data Members:
+ * + Params: struct
+ *      Point of the parameter grid a case ran at. Parameters a case doesn't
+ *      depend on are 0.
+ *      - floors, cars: building size.
+ *      - calls: hall calls active during the run.
+ *      - variant: case-specific setting, such as the dispatch mode.
+ * + Result: struct
+ *      Measurement of one case at one grid point.
+ * + Body: std::function<void(long long)>
+ *      Runs the measured operation the given number of times.
+ *
+ * + Grid: struct
+ *      Parameter grid the cases iterate over.
+ *      - floors, cars: building sizes.
+ *      - densities: fraction of floors with a hall call.
+ *      - callsFor(int, double): number of calls for a floor count and
+ *        density, at least one.
+ *
+ * - minTimeMs: double
+ *      Duration a timed run must reach.
+ * - filter: std::string
+ *      Only cases whose name contains it are run. Empty runs every case.
+ * - results: std::vector<Result>
+ *      Results collected so far.
+ *
+ * Class Methods:
+ * + setFilter(std::string): void
+ * + selected(std::string): bool
+ *      Set the case name filter, or check if a case passes it.
+ * + run(std::string, Params, Body): void
+ *      Measures a case at a grid point, if selected.
+ * + getResults(): const std::vector<Result> &
+ *
+ * + writeJson(std::ostream &): void
+ * + writeCsv(std::ostream &): void
+ *      Write every result collected, one record per result.
+ */
+class BenchRunner {
+   public:
+    /* Public data structs */
+    typedef struct Params {
+        int floors;
+        int cars;
+        int calls;
+        std::string variant;
+    } Params;
+
+    typedef struct Result {
+        std::string name;
+        Params params;
+        long long ops;
+        double nsPerOp;
+        double allocsPerOp;
+    } Result;
+
+    typedef std::function<void(long long iterations)> Body;
+
+    typedef struct Grid {
+        std::vector<int> floors;
+        std::vector<int> cars;
+        std::vector<double> densities;
+
+        static int callsFor(int floorCount, double density);
+    } Grid;
+
+    explicit BenchRunner(double minTimeMs);
+
+    /* Public methods */
+    void setFilter(const std::string &);
+    bool selected(const std::string &name) const;
+
+    void run(const std::string &name, const Params &, const Body &);
+    const std::vector<Result> &getResults() const;
+
+    void writeJson(std::ostream &) const;
+    void writeCsv(std::ostream &) const;
+
+   private:
+    /* Private data members */
+    double minTimeMs;
+    std::string filter;
+    std::vector<Result> results;
+};
+
+/* Heap allocations made by the process so far, counted by the replacement
+ * global operator new in BenchAlloc.cpp. */
+unsigned long long benchAllocations();
+
+/* Keeps a value from being optimized away. */
+void benchSink(long long);
+
+#endif /* BENCHRUNNER_H */
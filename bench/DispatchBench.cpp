@@ -0,0 +1,155 @@
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "BenchRunner.h"
+#include "SimBuilding.h"
+#include "SimElevator.h"
+
+/* Dispatch hot path benchmarks.
+ *
+ * Time the engine work behind every button press on buildings across the
+ * parameter grid: a car recomputing its movement, listing queued floors,
+ * finding the nearest queued floors on either side of a car (the lookups
+ * its dispatch policy picks between), and a full hall call press and clear
+ * including the dispatch passes they trigger. Car movement cases run in both
+ * dispatch modes. */
+
+namespace {
+
+const char *modeName(SimBuilding::DispatchMode mode) {
+    return mode == SimBuilding::DispatchMode::GROUP ? "group" : "nearest";
+}
+
+// Building with cars spread evenly over the floors, and hall calls on random
+// floors without a car, dispatched so every car is already on its way.
+std::unique_ptr<SimBuilding> makeBuilding(int floorCount, int carCount,
+                                          int calls,
+                                          SimBuilding::DispatchMode mode) {
+    std::vector<int> initialFloorNums(carCount);
+    std::vector<char> occupied(floorCount, false);
+    for (int e_ind = 0; e_ind < carCount; ++e_ind) {
+        int floorNum = 1 + int((long long)e_ind * floorCount / carCount);
+        initialFloorNums[e_ind] = floorNum;
+        occupied[floorNum - 1] = true;
+    }
+
+    std::unique_ptr<SimBuilding> building(
+        new SimBuilding(floorCount, carCount, initialFloorNums));
+    building->setDispatchMode(mode);
+
+    std::mt19937 rng(floorCount * 31 + carCount * 7 + calls);
+    std::uniform_int_distribution<int> floorDist(1, floorCount);
+    for (int placed = 0, tries = 0; placed < calls && tries < 8 * calls;
+         ++tries) {
+        int floorNum = floorDist(rng);
+        if (occupied[floorNum - 1]) continue;
+
+        Direction dir = (rng() & 1) ? Direction::UP : Direction::DOWN;
+        if (floorNum == floorCount) dir = Direction::DOWN;
+        if (floorNum == 1) dir = Direction::UP;
+        if (building->hasHallCall(floorNum, dir)) continue;
+
+        building->setHallCall(floorNum, dir, true);
+        ++placed;
+    }
+
+    // Run the dispatch pass, but not the cars' timers.
+    building->getScheduler().runUntil(0);
+    return building;
+}
+
+}  // namespace
+
+void runDispatchBenchmarks(BenchRunner &runner,
+                           const BenchRunner::Grid &grid) {
+    const SimBuilding::DispatchMode modes[] = {
+        SimBuilding::DispatchMode::GROUP,
+        SimBuilding::DispatchMode::NEAREST_CALL};
+
+    for (int floorCount : grid.floors) {
+        for (double density : grid.densities) {
+            int calls = BenchRunner::Grid::callsFor(floorCount, density);
+
+            // Queued floors only depend on the calls.
+            if (runner.selected("getQueuedFloors")) {
+                std::unique_ptr<SimBuilding> building = makeBuilding(
+                    floorCount, 1, calls, SimBuilding::DispatchMode::GROUP);
+
+                runner.run("getQueuedFloors", {floorCount, 1, calls, "any"},
+                           [&](long long iterations) {
+                               long long total = 0;
+                               for (long long i = 0; i < iterations; ++i)
+                                   total += building->getQueuedFloors().size();
+                               benchSink(total);
+                           });
+            }
+
+            for (int carCount : grid.cars) {
+                for (SimBuilding::DispatchMode mode : modes) {
+                    std::unique_ptr<SimBuilding> building =
+                        makeBuilding(floorCount, carCount, calls, mode);
+                    BenchRunner::Params params{floorCount, carCount, calls,
+                                               modeName(mode)};
+
+                    // One car recomputing, cycling through the cars.
+                    runner.run("determineMovement", params,
+                               [&](long long iterations) {
+                                   for (long long i = 0; i < iterations; ++i)
+                                       building
+                                           ->getElevator_byCarId(
+                                               1 + int(i % carCount))
+                                           .determineMovement();
+                               });
+
+                    // Nearest floors on both sides a car would stop at.
+                    runner.run(
+                        "queuedFloorLookup", params, [&](long long iterations) {
+                            long long total = 0;
+                            for (long long i = 0; i < iterations; ++i) {
+                                const SimElevator &car =
+                                    building->getElevator_byCarId(
+                                        1 + int(i % carCount));
+                                total += building->nearestServedHallCall(
+                                             car, Direction::UP) +
+                                         building->nearestServedHallCall(
+                                             car, Direction::DOWN) +
+                                         car.getCarCalls().nextAtOrAbove(
+                                             car.currentFloorNum) +
+                                         car.getCarCalls().nextAtOrBelow(
+                                             car.currentFloorNum);
+                            }
+                            benchSink(total);
+                        });
+
+                    // Press and clear a hall call, each followed by the
+                    // dispatch pass it schedules.
+                    std::vector<int> pressFloors(256);
+                    std::mt19937 rng(calls);
+                    std::uniform_int_distribution<int> floorDist(
+                        2, floorCount > 1 ? floorCount : 2);
+                    for (int &floorNum : pressFloors)
+                        floorNum = floorCount > 1 ? floorDist(rng) : 1;
+
+                    SimScheduler &scheduler = building->getScheduler();
+                    runner.run(
+                        "hallCallPress", params, [&](long long iterations) {
+                            for (long long i = 0; i < iterations; ++i) {
+                                int floorNum = pressFloors[i & 255];
+                                if (floorNum == 1 ||
+                                    building->hasHallCall(floorNum,
+                                                          Direction::DOWN))
+                                    continue;
+                                building->setHallCall(floorNum,
+                                                      Direction::DOWN, true);
+                                scheduler.runUntil(scheduler.now());
+                                building->setHallCall(floorNum,
+                                                      Direction::DOWN, false);
+                                scheduler.runUntil(scheduler.now());
+                            }
+                        });
+                }
+            }
+        }
+    }
+}
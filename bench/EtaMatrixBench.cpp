@@ -0,0 +1,104 @@
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "BenchRunner.h"
+#include "EtaMatrix.h"
+#include "SimBuilding.h"
+#include "SimElevator.h"
+
+/* ETA matrix benchmarks.
+ *
+ * Time computing the arrival estimate of 256 cars to 4,096 hall call floors:
+ * one estimateArrivalMs() call per cell ("reference"), then the EtaMatrix
+ * kernels this CPU supports. ns/op is per matrix. Every kernel must match
+ * the reference bit for bit before it is timed. */
+
+namespace {
+
+const int matrixCars = 256;
+const int matrixCalls = 4096;
+
+// Building with cars moving both ways, doors in every state, destination
+// calls and assigned hall calls, so every branch of the estimate is taken.
+std::unique_ptr<SimBuilding> makeBuilding(int floorCount) {
+    std::mt19937 rng(floorCount + matrixCars);
+    std::uniform_int_distribution<int> floorDist(1, floorCount);
+
+    std::vector<int> initialFloorNums(matrixCars);
+    for (int &floorNum : initialFloorNums) floorNum = floorDist(rng);
+
+    std::unique_ptr<SimBuilding> building(
+        new SimBuilding(floorCount, matrixCars, initialFloorNums));
+    for (int carId = 1; carId <= matrixCars; ++carId)
+        for (int c_ind = int(rng() % 4); c_ind > 0; --c_ind)
+            building->getElevator_byCarId(carId).setCarCall(floorDist(rng),
+                                                            true);
+    for (int c_ind = 0; c_ind < matrixCars / 2; ++c_ind) {
+        int floorNum = floorDist(rng);
+        Direction dir = floorNum == floorCount ? Direction::DOWN
+                                               : Direction::UP;
+        building->setHallCall(floorNum, dir, true);
+    }
+
+    // Let the cars start moving and their doors start cycling.
+    building->getScheduler().runUntil(1700);
+    return building;
+}
+
+}  // namespace
+
+bool runEtaMatrixBenchmarks(BenchRunner &runner, bool quick) {
+    if (!runner.selected("etaMatrix")) return true;
+
+    const int floorCount = quick ? 100 : 1000;
+    std::unique_ptr<SimBuilding> building = makeBuilding(floorCount);
+
+    std::vector<int> callFloors(matrixCalls);
+    std::mt19937 rng(floorCount);
+    std::uniform_int_distribution<int> floorDist(1, floorCount);
+    for (int &floorNum : callFloors) floorNum = floorDist(rng);
+
+    // Every kernel must agree with the estimate of each car, bit for bit.
+    const EtaMatrix::Kernel kernels[] = {EtaMatrix::Kernel::SCALAR,
+                                         EtaMatrix::Kernel::SSE2,
+                                         EtaMatrix::Kernel::AVX2};
+    EtaMatrix matrix;
+    for (EtaMatrix::Kernel kernel : kernels) {
+        if (!EtaMatrix::kernelSupported(kernel)) continue;
+
+        matrix.compute(*building, callFloors, kernel);
+        for (int e_ind = 0; e_ind < matrixCars; ++e_ind) {
+            const SimElevator &car = building->getElevator_byCarId(e_ind + 1);
+            for (int c_ind = 0; c_ind < matrixCalls; ++c_ind)
+                if (matrix.at(e_ind, c_ind) !=
+                    building->estimateArrivalMs(car, callFloors[c_ind]))
+                    return false;
+        }
+    }
+
+    BenchRunner::Params params{floorCount, matrixCars, matrixCalls,
+                               "reference"};
+    runner.run("etaMatrix", params, [&](long long iterations) {
+        long long total = 0;
+        for (long long i = 0; i < iterations; ++i)
+            for (int carId = 1; carId <= matrixCars; ++carId) {
+                const SimElevator &car = building->getElevator_byCarId(carId);
+                for (int floorNum : callFloors)
+                    total += building->estimateArrivalMs(car, floorNum);
+            }
+        benchSink(total);
+    });
+
+    for (EtaMatrix::Kernel kernel : kernels) {
+        if (!EtaMatrix::kernelSupported(kernel)) continue;
+
+        params.variant = EtaMatrix::kernelName(kernel);
+        runner.run("etaMatrix", params, [&](long long iterations) {
+            for (long long i = 0; i < iterations; ++i)
+                matrix.compute(*building, callFloors, kernel);
+            benchSink(matrix.values().back());
+        });
+    }
+    return true;
+}
@@ -0,0 +1,97 @@
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "BenchRunner.h"
+#include "SimBuilding.h"
+#include "SimElevator.h"
+
+/* Fleet layout benchmarks.
+ *
+ * Time one dispatch round on 1,000 cars: picking the car arriving soonest
+ * for each of a batch of hall calls. The "objects" variant visits every car
+ * object through its getters, as the dispatcher used to; the "fleet" variant
+ * scans the structure-of-arrays FleetState. Both pick the same cars. ns/op is
+ * per round. */
+
+namespace {
+
+const int fleetCars = 1000;
+const int roundCalls = 64;
+
+// Building with cars spread over the floors, some moving, some with doors
+// cycling and some with destination calls, so every branch of the estimate
+// is taken.
+std::unique_ptr<SimBuilding> makeFleet(int floorCount) {
+    std::mt19937 rng(floorCount);
+    std::uniform_int_distribution<int> floorDist(1, floorCount);
+
+    std::vector<int> initialFloorNums(fleetCars);
+    for (int &floorNum : initialFloorNums) floorNum = floorDist(rng);
+
+    std::unique_ptr<SimBuilding> building(
+        new SimBuilding(floorCount, fleetCars, initialFloorNums));
+    for (int carId = 1; carId <= fleetCars; ++carId)
+        if (rng() % 4 == 0)
+            building->getElevator_byCarId(carId).setCarCall(floorDist(rng),
+                                                            true);
+
+    // Let the cars start moving and their doors start cycling.
+    building->getScheduler().runUntil(1500);
+    return building;
+}
+
+// Same choice as SimBuilding::soonestArrivingCar(), one car object at a time.
+int soonestCarByObject(const SimBuilding &building, int floorNum) {
+    int bestCarId = 0;
+    long long bestEtaMs = 0;
+    for (int carId = 1; carId <= building.elevatorCount; ++carId) {
+        const SimElevator &car = building.getElevator_byCarId(carId);
+        if (!building.canServeHallCalls(car)) continue;
+
+        long long etaMs = building.estimateArrivalMs(car, floorNum);
+        if (bestCarId == 0 || etaMs < bestEtaMs) {
+            bestCarId = carId;
+            bestEtaMs = etaMs;
+        }
+    }
+    return bestCarId;
+}
+
+}  // namespace
+
+void runFleetBenchmarks(BenchRunner &runner, bool quick) {
+    const std::vector<int> floorCounts =
+        quick ? std::vector<int>{100} : std::vector<int>{100, 1000};
+
+    for (int floorCount : floorCounts) {
+        if (!runner.selected("dispatchRound")) return;
+
+        std::unique_ptr<SimBuilding> building = makeFleet(floorCount);
+
+        std::vector<int> callFloors(roundCalls);
+        std::mt19937 rng(floorCount * 7);
+        std::uniform_int_distribution<int> floorDist(1, floorCount);
+        for (int &floorNum : callFloors) floorNum = floorDist(rng);
+
+        runner.run("dispatchRound",
+                   {floorCount, fleetCars, roundCalls, "objects"},
+                   [&](long long iterations) {
+                       long long total = 0;
+                       for (long long i = 0; i < iterations; ++i)
+                           for (int floorNum : callFloors)
+                               total += soonestCarByObject(*building, floorNum);
+                       benchSink(total);
+                   });
+
+        runner.run("dispatchRound",
+                   {floorCount, fleetCars, roundCalls, "fleet"},
+                   [&](long long iterations) {
+                       long long total = 0;
+                       for (long long i = 0; i < iterations; ++i)
+                           for (int floorNum : callFloors)
+                               total += building->soonestArrivingCar(floorNum);
+                       benchSink(total);
+                   });
+    }
+}
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "BenchRunner.h"
+#include "FloorBitset.h"
+
+/* Hall-call lookup benchmarks.
+ *
+ * Compare finding the floor to visit next from a car's floor by scanning
+ * every floor's buttons (the previous getQueuedFloors() + sort + unique +
+ * closest-floor path) against nearest-call queries on the incremental
+ * FloorBitset index, and time the index's incremental updates. */
+
+namespace {
+
+const int queryCount = 4096;
+
+// Previous path: scan both buttons of every floor, then pick the closest.
+int scanClosest(const std::vector<char> &up, const std::vector<char> &down,
+                int currentFloorNum) {
+    std::vector<int> floors;
+    for (int f_ind = 0, end = int(up.size()); f_ind < end; ++f_ind)
+        if (up[f_ind] || down[f_ind]) floors.push_back(f_ind + 1);
+
+    std::sort(floors.begin(), floors.end());
+    floors.erase(std::unique(floors.begin(), floors.end()), floors.end());
+
+    if (floors.empty()) return FloorBitset::NO_FLOOR;
+    if (currentFloorNum <= floors.front()) return floors.front();
+    if (currentFloorNum >= floors.back()) return floors.back();
+
+    auto it = std::adjacent_find(
+        floors.begin(), floors.end(), [currentFloorNum](int before, int after) {
+            return currentFloorNum >= before && currentFloorNum <= after;
+        });
+    return (currentFloorNum - *it <= *(it + 1) - currentFloorNum) ? *it
+                                                                   : *(it + 1);
+}
+
+// Indexed path: nearest call on either side from both direction sets.
+int indexClosest(const FloorBitset &up, const FloorBitset &down,
+                 int currentFloorNum) {
+    int above = up.nextAtOrAbove(currentFloorNum);
+    int downAbove = down.nextAtOrAbove(currentFloorNum);
+    if (above == FloorBitset::NO_FLOOR || (downAbove != FloorBitset::NO_FLOOR &&
+                                           downAbove < above))
+        above = downAbove;
+    int below = std::max(up.nextAtOrBelow(currentFloorNum),
+                         down.nextAtOrBelow(currentFloorNum));
+
+    if (below == FloorBitset::NO_FLOOR) return above;
+    if (above == FloorBitset::NO_FLOOR) return below;
+    return (currentFloorNum - below <= above - currentFloorNum) ? below : above;
+}
+
+}  // namespace
+
+bool runHallCallBenchmarks(BenchRunner &runner,
+                           const BenchRunner::Grid &grid) {
+    for (int floorCount : grid.floors) {
+        for (double density : grid.densities) {
+            int calls = BenchRunner::Grid::callsFor(floorCount, density);
+
+            std::mt19937 rng(floorCount + calls);
+            std::uniform_int_distribution<int> floorDist(1, floorCount);
+
+            std::vector<char> upButtons(floorCount, false);
+            std::vector<char> downButtons(floorCount, false);
+            FloorBitset upIndex(floorCount);
+            FloorBitset downIndex(floorCount);
+
+            for (int i = 0; i < calls; ++i) {
+                int floorNum = floorDist(rng);
+                bool goingUp = rng() & 1;
+                (goingUp ? upButtons : downButtons)[floorNum - 1] = true;
+                (goingUp ? upIndex : downIndex).set(floorNum, true);
+            }
+
+            std::vector<int> queries(queryCount);
+            for (int &q : queries) q = floorDist(rng);
+
+            // Both paths must agree before their timings mean anything.
+            for (int q : queries)
+                if (scanClosest(upButtons, downButtons, q) !=
+                    indexClosest(upIndex, downIndex, q))
+                    return false;
+
+            BenchRunner::Params params{floorCount, 0, calls, "-"};
+
+            runner.run("hallCallScan", params, [&](long long iterations) {
+                long long total = 0;
+                for (long long i = 0; i < iterations; ++i)
+                    total += scanClosest(upButtons, downButtons,
+                                         queries[i % queryCount]);
+                benchSink(total);
+            });
+
+            runner.run("hallCallIndex", params, [&](long long iterations) {
+                long long total = 0;
+                for (long long i = 0; i < iterations; ++i)
+                    total += indexClosest(upIndex, downIndex,
+                                          queries[i % queryCount]);
+                benchSink(total);
+            });
+
+            // Incremental update: press or clear a call.
+            runner.run("hallCallUpdate", params, [&](long long iterations) {
+                long long total = 0;
+                for (long long i = 0; i < iterations; ++i)
+                    total += upIndex.set(queries[(i >> 1) % queryCount],
+                                         !(i & 1));
+                benchSink(total);
+            });
+        }
+    }
+    return true;
+}
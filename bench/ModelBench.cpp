@@ -0,0 +1,56 @@
+#include <QModelIndex>
+#include <QVariant>
+#include <memory>
+#include <vector>
+
+#include "BenchRunner.h"
+#include "Building.h"
+#include "BuildingConfig.h"
+
+/* Table model benchmark.
+ *
+ * Times Building::data() as the view calls it while repainting: one call per
+ * cell and role, sweeping the whole table. Only built with the Qt widgets
+ * module (see bench.pro), since the model owns its buttons. Every car has a
+ * destination button per floor, so large grid points are skipped. */
+
+namespace {
+
+const long long maxButtons = 16384;
+
+}  // namespace
+
+void runModelBenchmarks(BenchRunner &runner, const BenchRunner::Grid &grid) {
+    if (!runner.selected("Building::data")) return;
+
+    const int roles[] = {Qt::DisplayRole, Qt::BackgroundRole,
+                         Qt::TextAlignmentRole};
+
+    for (int floorCount : grid.floors) {
+        for (int carCount : grid.cars) {
+            if ((long long)floorCount * carCount > maxButtons) continue;
+
+            BuildingConfig config;
+            config.floorCount = floorCount;
+            config.elevatorCount = carCount;
+            std::unique_ptr<Building> model(new Building(config, 4, 1));
+
+            std::vector<QModelIndex> cells;
+            for (int row = 0; row < model->rowCount(); ++row)
+                for (int col = 0; col < model->columnCount(); ++col)
+                    cells.push_back(model->index(row, col));
+
+            runner.run("Building::data", {floorCount, carCount, 0, "sweep"},
+                       [&](long long iterations) {
+                           long long total = 0;
+                           for (long long i = 0; i < iterations; ++i) {
+                               const QModelIndex &cell =
+                                   cells[i % cells.size()];
+                               total += model->data(cell, roles[i % 3])
+                                            .isValid();
+                           }
+                           benchSink(total);
+                       });
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <string>
+#include <thread>
+
+#include "BenchRunner.h"
+#include "MonteCarloRunner.h"
+
+/* Monte Carlo batch benchmarks.
+ *
+ * Time a batch of 32 independent replications, an hour of up-peak traffic
+ * each, on one worker thread and on one per hardware thread. ns/op is per
+ * batch; with near-linear scaling the second is the first divided by the
+ * thread count. */
+
+namespace {
+
+const int batchSize = 32;
+
+}  // namespace
+
+void runMonteCarloBenchmarks(BenchRunner &runner, bool quick) {
+    if (!runner.selected("monteCarlo")) return;
+
+    MonteCarloRunner::Scenario scenario;
+    scenario.floorCount = 20;
+    scenario.elevatorCount = 4;
+    scenario.profile = TrafficGenerator::Profile::UP_PEAK;
+    scenario.rates = {{0, 30.0}};
+    scenario.durationMs = (quick ? 5 : 60) * 60 * 1000;
+
+    unsigned hardwareThreads =
+        std::max(1u, std::thread::hardware_concurrency());
+    const unsigned threadCounts[] = {1, hardwareThreads};
+
+    for (int t_ind = 0; t_ind < (hardwareThreads > 1 ? 2 : 1); ++t_ind) {
+        MonteCarloRunner monteCarlo(threadCounts[t_ind]);
+        std::string variant =
+            "threads=" + std::to_string(threadCounts[t_ind]);
+
+        runner.run("monteCarlo", {scenario.floorCount, scenario.elevatorCount,
+                                  0, variant},
+                   [&](long long iterations) {
+                       long long total = 0;
+                       for (long long i = 0; i < iterations; ++i)
+                           total += monteCarlo
+                                        .run(scenario, batchSize, unsigned(i))
+                                        .journeyTimes.count();
+                       benchSink(total);
+                   });
+    }
+}
@@ -0,0 +1,60 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BenchRunner.h"
+#include "CarConfig.h"
+#include "SimBuilding.h"
+#include "SimElevator.h"
+#include "SimScheduler.h"
+
+/* Motion model benchmarks.
+ *
+ * Time a round trip of one car from the bottom floor to the top and back,
+ * with a car without a motion profile ("perFloor", one timer event per floor
+ * passed) and with a kinematic one ("kinematic", one event per run, timed
+ * from its FlightTable). ns/op is per round trip, every event of it run. */
+
+namespace {
+
+const int motionFloors[] = {100, 1000, 10000};
+
+void roundTrip(SimBuilding &building) {
+    SimElevator &car = building.getElevator_byCarId(1);
+    SimScheduler &scheduler = building.getScheduler();
+
+    car.setCarCall(building.floorCount, true);
+    while (scheduler.runNext()) {
+    }
+    car.setCarCall(1, true);
+    while (scheduler.runNext()) {
+    }
+}
+
+}  // namespace
+
+void runMotionBenchmarks(BenchRunner &runner, bool quick) {
+    if (!runner.selected("roundTrip")) return;
+
+    for (int floorCount : motionFloors) {
+        if (quick && floorCount > 1000) break;
+
+        for (int kinematic = 0; kinematic <= 1; ++kinematic) {
+            CarConfig config;
+            if (kinematic) config.maxSpeedMmps = 10000;
+
+            std::unique_ptr<SimBuilding> building(new SimBuilding(
+                floorCount, 1, std::vector<int>{1},
+                std::vector<CarConfig>{config}));
+
+            runner.run("roundTrip",
+                       {floorCount, 1, 2, kinematic ? "kinematic" : "perFloor"},
+                       [&](long long iterations) {
+                           for (long long i = 0; i < iterations; ++i)
+                               roundTrip(*building);
+                           benchSink((long long)building->getScheduler()
+                                         .processedEvents());
+                       });
+        }
+    }
+}
@@ -0,0 +1,201 @@
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchRunner.h"
+#include "DispatchPolicy.h"
+#include "FloorBitset.h"
+#include "SimBuilding.h"
+#include "SimElevator.h"
+#include "SimScheduler.h"
+
+/* Dispatch policy benchmarks.
+ *
+ * Time the cost of the policy abstraction. "policyNextStop" picks the next
+ * floor of cars with calls on both sides three ways: the previous
+ * hand-written closestQueuedFloor() logic ("inline"), the reference
+ * NearestFloorPolicy as a template parameter ("template"), and the same
+ * policy behind a virtual interface ("virtual"), which policies avoid.
+ * "dispatchPass" recomputes every car of a building in one dispatch pass,
+ * under each registered policy. */
+
+namespace {
+
+typedef struct Query {
+    const SimElevator *car;
+    int below;
+    int above;
+} Query;
+
+// Previous path: closestQueuedFloor() as it was in SimElevator.
+int inlineNextStop(const SimElevator &car, int below, int above) {
+    if (below == FloorBitset::NO_FLOOR) return above;
+    if (above == FloorBitset::NO_FLOOR) return below;
+    if (above == car.currentFloorNum) return car.currentFloorNum;
+
+    int distBefore = car.currentFloorNum - below;
+    int distAfter = above - car.currentFloorNum;
+    if (distBefore < distAfter) return below;
+    if (distAfter < distBefore) return above;
+    return car.getMovement() == SimElevator::MovementState::UPWARDS ? above
+                                                                    : below;
+}
+
+// Runs a way of picking the next stop over the queries, round robin.
+template <class NextStop>
+long long sumNextStops(const std::vector<Query> &queries, long long iterations,
+                       NextStop nextStop) {
+    long long total = 0;
+    size_t q_ind = 0;
+    for (long long i = 0; i < iterations; ++i) {
+        const Query &q = queries[q_ind];
+        total += nextStop(*q.car, q.below, q.above);
+        if (++q_ind == queries.size()) q_ind = 0;
+    }
+    return total;
+}
+
+// What the policies would cost as virtual classes
+struct VirtualPolicy {
+    virtual ~VirtualPolicy() {}
+    virtual int nextStop(const SimElevator &, int below, int above) const = 0;
+};
+
+template <class Policy>
+struct VirtualAdapter : VirtualPolicy {
+    int nextStop(const SimElevator &car, int below,
+                 int above) const override {
+        return Policy::nextStop(car, below, above);
+    }
+};
+
+// Building with cars spread evenly over the floors and hall calls on random
+// floors, every car answering every call.
+std::unique_ptr<SimBuilding> makeBuilding(int floorCount, int carCount,
+                                          int calls) {
+    std::vector<int> initialFloorNums(carCount);
+    for (int e_ind = 0; e_ind < carCount; ++e_ind)
+        initialFloorNums[e_ind] =
+            1 + int((long long)e_ind * floorCount / carCount);
+
+    std::unique_ptr<SimBuilding> building(
+        new SimBuilding(floorCount, carCount, initialFloorNums));
+    building->setDispatchMode(SimBuilding::DispatchMode::NEAREST_CALL);
+
+    std::mt19937 rng(floorCount * 17 + carCount * 5 + calls);
+    std::uniform_int_distribution<int> floorDist(1, floorCount);
+    for (int placed = 0, tries = 0; placed < calls && tries < 8 * calls;
+         ++tries) {
+        int floorNum = floorDist(rng);
+        Direction dir = (floorNum == floorCount || (floorNum > 1 && rng() & 1))
+                            ? Direction::DOWN
+                            : Direction::UP;
+        if (floorCount == 1 || building->hasHallCall(floorNum, dir)) continue;
+
+        building->setHallCall(floorNum, dir, true);
+        ++placed;
+    }
+    return building;
+}
+
+}  // namespace
+
+bool runPolicyBenchmarks(BenchRunner &runner, const BenchRunner::Grid &grid) {
+    VirtualAdapter<NearestFloorPolicy> nearestAdapter;
+    const VirtualPolicy *virtualPolicy = &nearestAdapter;
+
+    for (int floorCount : grid.floors) {
+        for (double density : grid.densities) {
+            int calls = BenchRunner::Grid::callsFor(floorCount, density);
+
+            for (int carCount : grid.cars) {
+                std::unique_ptr<SimBuilding> building =
+                    makeBuilding(floorCount, carCount, calls);
+
+                // Cars with something queued, as the policies need.
+                std::vector<Query> queries;
+                for (int carId = 1; carId <= carCount; ++carId) {
+                    const SimElevator &car =
+                        building->getElevator_byCarId(carId);
+                    Query q{&car,
+                            building->nearestServedHallCall(car,
+                                                            Direction::DOWN),
+                            building->nearestServedHallCall(car,
+                                                            Direction::UP)};
+                    if (q.below == FloorBitset::NO_FLOOR &&
+                        q.above == FloorBitset::NO_FLOOR)
+                        continue;
+                    queries.push_back(q);
+                }
+
+                // All paths must agree before their timings mean anything.
+                for (const Query &q : queries)
+                    if (inlineNextStop(*q.car, q.below, q.above) !=
+                            NearestFloorPolicy::nextStop(*q.car, q.below,
+                                                         q.above) ||
+                        virtualPolicy->nextStop(*q.car, q.below, q.above) !=
+                            inlineNextStop(*q.car, q.below, q.above))
+                        return false;
+
+                if (!queries.empty()) {
+                    BenchRunner::Params params{floorCount, carCount, calls,
+                                               "inline"};
+                    runner.run("policyNextStop", params,
+                               [&](long long iterations) {
+                                   benchSink(sumNextStops(
+                                       queries, iterations,
+                                       [](const SimElevator &car, int below,
+                                          int above) {
+                                           return inlineNextStop(car, below,
+                                                                 above);
+                                       }));
+                               });
+
+                    params.variant = "template";
+                    runner.run("policyNextStop", params,
+                               [&](long long iterations) {
+                                   benchSink(sumNextStops(
+                                       queries, iterations,
+                                       [](const SimElevator &car, int below,
+                                          int above) {
+                                           return NearestFloorPolicy::nextStop(
+                                               car, below, above);
+                                       }));
+                               });
+
+                    params.variant = "virtual";
+                    runner.run(
+                        "policyNextStop", params, [&](long long iterations) {
+                            benchSink(sumNextStops(
+                                queries, iterations,
+                                [virtualPolicy](const SimElevator &car,
+                                                int below, int above) {
+                                    return virtualPolicy->nextStop(car, below,
+                                                                   above);
+                                }));
+                        });
+                }
+
+                // Every car recomputed in one pass, by each policy.
+                SimScheduler &scheduler = building->getScheduler();
+                for (const std::string &name :
+                     SimBuilding::dispatchPolicyNames()) {
+                    building->setDispatchPolicy(name);
+                    scheduler.runUntil(scheduler.now());
+
+                    runner.run("dispatchPass",
+                               {floorCount, carCount, calls, name},
+                               [&](long long iterations) {
+                                   for (long long i = 0; i < iterations;
+                                        ++i) {
+                                       building->buildingDataChanged();
+                                       scheduler.runUntil(scheduler.now());
+                                   }
+                               });
+                }
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,46 @@
+# Benchmark suite for the dispatch hot path. Engine cases need no Qt modules;
+# the Building::data() case is added when Qt widgets are available.
+#
+# Run "bench --help" for options, e.g. "bench --json results.json" to keep
+# machine-readable results for comparing builds.
+
+TEMPLATE = app
+TARGET = bench
+
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+include(../src/engine/engine.pri)
+
+SOURCES += \
+    BenchAlloc.cpp \
+    BenchMain.cpp \
+    BenchRunner.cpp \
+    DispatchBench.cpp \
+    EtaMatrixBench.cpp \
+    FleetBench.cpp \
+    HallCallBench.cpp \
+    MonteCarloBench.cpp \
+    MotionBench.cpp \
+    PolicyBench.cpp
+
+HEADERS += \
+    BenchRunner.h
+
+qtHaveModule(widgets) {
+    QT += widgets
+    DEFINES += BENCH_MODEL
+
+    INCLUDEPATH += ../src
+    SOURCES += \
+        ModelBench.cpp \
+        ../src/Building.cpp \
+        ../src/DataButton.cpp \
+        ../src/Elevator.cpp
+    HEADERS += \
+        ../src/Building.h \
+        ../src/DataButton.h \
+        ../src/Elevator.h
+} else {
+    CONFIG -= qt
+}
@@ -4,18 +4,54 @@
 #include <QBrush>
 #include <QMap>
 #include <QRandomGenerator>
+#include <QSignalBlocker>
 #include <QString>
 #include <QVector>
-
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "BuildingConfig.h"
 #include "DataButton.h"
 #include "Elevator.h"
-
-Building::Building(int f, int e, int ar, int ac, QObject *parent)
+#include "InputJournal.h"
+#include "LogRecord.h"
+#include "ShardedEngine.h"
+#include "SimBuilding.h"
+#include "SimElevator.h"
+#include "SimInput.h"
+#include "SimScheduler.h"
+#include "TrajectoryDigest.h"
+
+Building::Building(const BuildingConfig &config, int ar, int ac,
+                   ButtonMode mode, int shardCount, QObject *parent)
     : QAbstractTableModel(parent),
-      floorCount(f),
-      elevatorCount(e),
+      floorCount(config.floorCount),
+      elevatorCount(config.elevatorCount),
       rowButtonCount(ar),
       colButtonCount(ac),
+      buttonMode(mode),
+      seed(QRandomGenerator::global()->generate()),
+      engine(shardCount > 0 ? nullptr : createEngine(config, seed)),
+      shards(createShards(config, seed, shardCount)),
+      digest(engine ? new TrajectoryDigest(engine) : nullptr),
+      journal(engine ? InputJournal::forBuilding(*engine)
+                     : InputJournal(config.floorCount, config.elevatorCount,
+                                    initialFloorNums(config, seed),
+                                    config.carConfigs(), config.dispatchMode,
+                                    config.energyBudgetMs, config.idleParking,
+                                    config.parkDelayMs,
+                                    config.dispatchPolicy)),
+      shardTimer(new QTimer(this)),
+      pacingTimer(new QTimer(this)),
+      simBaseMs(0),
+      timeScale(1.0),
+      frameTimer(new QTimer(this)),
+      dirtyColumns(elevatorCount, false),
+      paintedFloorNums(elevatorCount, 0),
       buildingFireButton(new DataButton(true, false, false, "Building\nFIRE")),
       buildingPowerOutButton(
           new DataButton(true, false, false, "Building\nPOWER OUT")) {
@@ -23,23 +59,34 @@ Building::Building(int f, int e, int ar, int ac, QObject *parent)
     for (int f_ind = 0; f_ind < floorCount; ++f_ind) {
         int floorNum = index_to_floorNum(f_ind);
 
+        // Delegate-painted floor buttons need no widgets.
+        if (buttonMode == ButtonMode::DELEGATE) {
+            floorNum_FloorData_Map.insert(floorNum, floorData());
+            continue;
+        }
+
         DataButton *upButton = new DataButton(true, true, false, "UP ▲");
         DataButton *downButton = new DataButton(true, true, false, "DOWN ▼");
 
         upButton->setMaximumWidth(floorButtonUiWidth);
         downButton->setMaximumWidth(floorButtonUiWidth);
 
-        // Disable buttons appropriately at the very top or bottom floor.
-        if (f_ind == 0)
-            upButton->setDisabled(true);  // Top floor
-        else if (f_ind == (floorCount - 1))
-            downButton->setDisabled(true);  // Bottom floor
+        // Disable buttons at the top and bottom floors, and wherever no car
+        // goes on that way.
+        upButton->setDisabled(!hasHallButton(floorNum, Direction::UP));
+        downButton->setDisabled(!hasHallButton(floorNum, Direction::DOWN));
 
-        // Floor state changes mean building data has changed
+        // Forward floor button presses to the engine
         connect(upButton, &DataButton::buttonCheckedUpdate, this,
-                &Building::buildingDataChanged);
+                [floorNum, upButton, this]() {
+                    applyInput(SimInput::hallCall(floorNum, Direction::UP,
+                                                  upButton->isChecked()));
+                });
         connect(downButton, &DataButton::buttonCheckedUpdate, this,
-                &Building::buildingDataChanged);
+                [floorNum, downButton, this]() {
+                    applyInput(SimInput::hallCall(floorNum, Direction::DOWN,
+                                                  downButton->isChecked()));
+                });
 
         floorNum_FloorData_Map.insert(floorNum,
                                       floorData(upButton, downButton));
@@ -47,68 +94,268 @@ Building::Building(int f, int e, int ar, int ac, QObject *parent)
 
     /* Initialize elevators */
     for (int e_ind = 0; e_ind < elevatorCount; ++e_ind) {
-        // Generate random starting floor for each elevator
-        int initFloorNum = index_to_floorNum(
-            QRandomGenerator::global()->bounded(0, floorCount));
-
-        Elevator *newElevator = new Elevator(initFloorNum, this, this);
+        int carId = index_to_carId(e_ind);
+        Elevator *newElevator =
+            shards ? new Elevator(shards->getCar(carId), this, this)
+                   : new Elevator(&engine->getElevator_byCarId(carId), this,
+                                  this);
 
-        carId_Elevator_Map.insert(index_to_carId(e_ind), newElevator);
+        carId_Elevator_Map.insert(carId, newElevator);
+        paintedFloorNums[e_ind] = newElevator->currentFloorNum();
 
-        // Catch changes in elevator to update building data
+        // Catch changes in elevator to update the view
         connect(newElevator, &Elevator::elevatorDataChanged, this,
-                [e_ind, newElevator, this]() {
-                    emit buildingDataChanged();
-                    this->updateColumn(e_ind);
-                });
+                [e_ind, this]() { this->updateColumn(e_ind); });
+    }
 
-        connect(newElevator, &Elevator::elevatorArrived, this,
-                [newElevator, this]() {
-                    // Elevator arrived, unset that floor's buttons.
-                    Building::floorData fd = this->getFloorData_byFloorNum(
-                        newElevator->currentFloorNum);
-                    fd.upButton->setChecked(false);
-                    fd.downButton->setChecked(false);
-                });
+    // Forward building emergency button changes to the engine
+    connect(buildingFireButton, &DataButton::buttonCheckedUpdate, this,
+            [this]() {
+                applyInput(SimInput::buildingInput(
+                    SimInput::Kind::BUILDING_FIRE,
+                    buildingFireButton->isChecked()));
+            });
+    connect(buildingPowerOutButton, &DataButton::buttonCheckedUpdate, this,
+            [this]() {
+                applyInput(SimInput::buildingInput(
+                    SimInput::Kind::BUILDING_POWER_OUT,
+                    buildingPowerOutButton->isChecked()));
+            });
+
+    /* Coalesce view updates to at most one per display frame */
+    frameTimer->setSingleShot(true);
+    frameTimer->setInterval(frameIntervalMs);
+    connect(frameTimer, &QTimer::timeout, this, &Building::flushViewUpdates);
+
+    /* Present the shards, which pace their own clocks */
+    if (shards) {
+        shardTimer->setInterval(frameIntervalMs);
+        connect(shardTimer, &QTimer::timeout, this, &Building::pollShards);
+        shards->start();
+        shardTimer->start();
+        return;
+    }
+
+    /* Pace the engine's virtual clock against the wall clock */
+    pacingTimer->setSingleShot(true);
+    pacingTimer->setTimerType(Qt::PreciseTimer);
+    connect(pacingTimer, &QTimer::timeout, this, &Building::paceSimulation);
+    wallClock.start();
+
+    /* Mirror engine changes */
+    engine->hooks.buildingDataChanged = [this]() {
+        emit buildingDataChanged();
+    };
+    engine->hooks.hallCallChanged = [this](int floorNum, Direction dir,
+                                           bool active) {
+        mirrorHallCall(floorNum, dir, active);
+    };
+    engine->hooks.destinationAssigned = [this](int originFloorNum,
+                                               int destinationFloorNum, int,
+                                               int carId) {
+        // Logged like the shards do, where this is all the GUI learns.
+        if (carId != 0)
+            emit getElevator_byCarId(carId)->textOut(
+                QString("Assigned: floor %1 to %2")
+                    .arg(originFloorNum)
+                    .arg(destinationFloorNum));
+        emit destinationAssigned(originFloorNum, destinationFloorNum, carId);
+    };
+}
+
+Building::~Building() {
+    delete shards;  // Stops the worker threads
+    delete digest;
+    delete engine;
+}
+
+std::vector<int> Building::initialFloorNums(const BuildingConfig &config,
+                                            unsigned seed) {
+    std::mt19937 rng(seed);
+    return SimBuilding::randomInitialFloorNums(config.floorCount,
+                                               config.carConfigs(), rng);
+}
+
+SimBuilding *Building::createEngine(const BuildingConfig &config,
+                                   unsigned seed) {
+    return config.createBuilding(initialFloorNums(config, seed)).release();
+}
+
+ShardedEngine *Building::createShards(const BuildingConfig &config,
+                                      unsigned seed, int shardCount) {
+    if (shardCount <= 0) return nullptr;
+    return new ShardedEngine(config, initialFloorNums(config, seed),
+                             shardCount);
+}
+
+SimBuilding *Building::getEngine() { return engine; }
+
+bool Building::isSharded() const { return shards != nullptr; }
+
+long long Building::simulatedTimeMs() const {
+    return shards ? shards->now() : engine->getScheduler().now();
+}
+
+bool Building::hasHallCall(int floorNum, Direction dir) const {
+    return shards ? shards->hasHallCall(floorNum, dir)
+                  : engine->hasHallCall(floorNum, dir);
+}
+
+bool Building::hasHallButton(int floorNum, Direction dir) const {
+    return shards ? shards->hasHallButton(floorNum, dir)
+                  : engine->hasHallButton(floorNum, dir);
+}
+
+bool Building::servesFloor(int carId, int floorNum) const {
+    return shards ? shards->servesFloor(carId, floorNum)
+                  : engine->getElevator_byCarId(carId).servesFloor(floorNum);
+}
+
+int Building::legFloorNum(int originFloorNum, int destinationFloorNum) const {
+    return shards ? shards->legFloorNum(originFloorNum, destinationFloorNum)
+                  : engine->legFloorNum(originFloorNum, destinationFloorNum);
+}
 
-        // Catch building emergency button changes in building
-        connect(buildingFireButton, &DataButton::buttonCheckedUpdate, this,
-                &Building::buildingDataChanged);
-        connect(buildingPowerOutButton, &DataButton::buttonCheckedUpdate, this,
-                &Building::buildingDataChanged);
+void Building::mirrorHallCall(int floorNum, Direction dir, bool active) {
+    if (buttonMode == ButtonMode::DELEGATE) {
+        QModelIndex cell = index(floorCount - floorNum, elevatorCount);
+        emit dataChanged(cell, cell);
+        return;
     }
+
+    floorData fd = getFloorData_byFloorNum(floorNum);
+    DataButton *button = (dir == Direction::UP) ? fd.upButton : fd.downButton;
+
+    // Mirror only, the change must not be forwarded back to the engine.
+    const QSignalBlocker blocker(button);
+    button->setChecked(active);
 }
 
-bool Building::buildingOnFire() const {
-    return buildingFireButton->isChecked();
+void Building::pollShards() {
+    std::vector<int> changedCarIds;
+    std::vector<std::pair<int, Direction>> changedCalls;
+
+    if (shards->poll(changedCarIds, changedCalls)) {
+        for (int carId : changedCarIds)
+            getElevator_byCarId(carId)->applySnapshot(shards->getCar(carId));
+        for (const auto &call : changedCalls)
+            mirrorHallCall(call.first, call.second,
+                           shards->hasHallCall(call.first, call.second));
+        emit buildingDataChanged();
+    }
+
+    LogRecord record;
+    while (shards->takeLog(record)) {
+        // Shard-wide messages are rejected inputs, there is no car to show.
+        if (!carId_Elevator_Map.contains(record.carId)) {
+            qWarning("%s", record.text.c_str());
+            continue;
+        }
+        emit getElevator_byCarId(record.carId)
+            ->textOut(QString::fromStdString(record.text));
+    }
 }
-bool Building::buildingPowerOut() const {
-    return buildingPowerOutButton->isChecked();
+
+long long Building::wallClockSimTime() const {
+    return simBaseMs + (long long)(wallClock.elapsed() * timeScale);
 }
 
-const QVector<int> Building::getQueuedFloors(Direction dir) const {
-    QVector<int> matchingFloors;
+void Building::paceSimulation() {
+    SimScheduler &scheduler = engine->getScheduler();
 
-    // Floor data map is pre-sorted, ascending order.
-    for (auto i = floorNum_FloorData_Map.cbegin(),
-              end = floorNum_FloorData_Map.cend();
-         i != end; ++i) {
-        int floorNum = i.key();
+    // Catch up on every event due by now
+    scheduler.runUntil(wallClockSimTime());
 
-        bool upMatched = (i->upButton->isChecked()) &&
-                         (dir == Direction::UP || dir == Direction::NONE);
-        bool downMatched = (i->downButton->isChecked()) &&
-                           (dir == Direction::DOWN || dir == Direction::NONE);
+    // Cars in a kinematic run pass floors between events, so redraw them
+    // every frame until they arrive.
+    bool inRun = false;
+    for (int e_ind = 0; e_ind < elevatorCount; ++e_ind) {
+        if (!engine->getElevator_byCarId(index_to_carId(e_ind)).isInRun())
+            continue;
+        emit getElevator_byIndex(e_ind)->elevatorDataChanged();
+        inRun = true;
+    }
+
+    // Sleep until the next event is due
+    if (scheduler.empty()) {
+        pacingTimer->stop();
+    } else {
+        double waitMs =
+            (scheduler.nextEventTime() - scheduler.now()) / timeScale;
+        if (inRun) waitMs = std::min(waitMs, double(frameIntervalMs));
+        pacingTimer->start(int(std::ceil(waitMs)));
+    }
+}
 
-        if (upMatched || downMatched) matchingFloors.append(floorNum);
+void Building::applyInput(const SimInput &input) {
+    // Shards apply it on their own clocks, once their inboxes reach it.
+    if (shards) {
+        if (!shards->post(input)) qWarning("Shard inbox full, input dropped");
+        return;
     }
 
-    // Return ascending list of all matching floor numbers.
-    return matchingFloors;
+    // Inputs happen at the current wall-clock time in the simulation.
+    SimScheduler &scheduler = engine->getScheduler();
+    scheduler.runUntil(wallClockSimTime());
+    journal.record(scheduler.now(), input);
+    input.apply(*engine);
+    paceSimulation();
+}
+
+InputJournal Building::finishedJournal() {
+    if (shards) throw "ERROR: Sharded runs aren't journaled";
+
+    // Catch up first, so the journal covers the run up to now.
+    paceSimulation();
+
+    InputJournal finished = journal;
+    finished.finish(engine->getScheduler().now(), digest->value());
+    return finished;
+}
+
+double Building::getTimeScale() const { return timeScale; }
+
+void Building::setTimeScale(double newScale) {
+    if (newScale <= 0) throw "ERROR: Time scale must be positive";
+    if (shards) throw "ERROR: Sharded runs keep their starting time scale";
+
+    // Catch up at the old speed, then measure from here at the new speed.
+    paceSimulation();
+    simBaseMs = engine->getScheduler().now();
+    wallClock.restart();
+    timeScale = newScale;
+    paceSimulation();
 }
 
 void Building::updateColumn(int col) {
-    emit dataChanged(index(0, col), index(floorCount, col));
+    dirtyColumns[col] = true;
+    if (!frameTimer->isActive()) frameTimer->start();
+}
+
+void Building::flushViewUpdates() {
+    static const QVector<int> roles{Qt::DisplayRole, Qt::BackgroundRole};
+
+    for (int e_ind = 0; e_ind < elevatorCount; ++e_ind) {
+        if (!dirtyColumns[e_ind]) continue;
+        dirtyColumns[e_ind] = false;
+
+        // Only the car's cell changes, and the one it left if it moved.
+        int floorNum = getElevator_byIndex(e_ind)->currentFloorNum();
+        QModelIndex cell = index(floorCount - floorNum, e_ind);
+        emit dataChanged(cell, cell, roles);
+
+        if (paintedFloorNums[e_ind] != floorNum) {
+            QModelIndex leftCell =
+                index(floorCount - paintedFloorNums[e_ind], e_ind);
+            emit dataChanged(leftCell, leftCell, roles);
+            paintedFloorNums[e_ind] = floorNum;
+        }
+
+        // Delegate-painted car panels show the car's state too.
+        if (buttonMode == ButtonMode::DELEGATE && rowButtonCount > 0)
+            emit dataChanged(index(floorCount, e_ind),
+                             index(floorCount + rowButtonCount - 1, e_ind));
+    }
 }
 
 int Building::rowCount(const QModelIndex & /*parent*/) const {
@@ -123,11 +370,20 @@ QVariant Building::data(const QModelIndex &index, int role) const {
     int row = index.row();
     int col = index.column();
 
+    // Delegate-painted car panels show the car's floor and text display
+    if (buttonMode == ButtonMode::DELEGATE && role == Qt::DisplayRole &&
+        row == floorCount + DISPLAY_ROW && isElevatorIndex(col)) {
+        const Elevator *elevator = getElevator_byIndex(col);
+        return QString("%1\n%2")
+            .arg(elevator->currentFloorNum())
+            .arg(elevator->getTextDisplay());
+    }
+
     // Only access data for elevator/floor cells, not the button cells
     if (isFloorDataIndex(row) && isElevatorIndex(col)) {
         const Elevator *elevator = getElevator_byIndex(col);
 
-        if (index_to_floorNum(row) == elevator->currentFloorNum) {
+        if (index_to_floorNum(row) == elevator->currentFloorNum()) {
             switch (role) {
                 case Qt::DisplayRole:
                     // Key data, rendered as text
@@ -229,3 +485,99 @@ QVector<QWidget *> Building::getFloorButtons_byIndex(int index) {
     return QVector<QWidget *>{qobject_cast<QWidget *>(fd.upButton),
                               qobject_cast<QWidget *>(fd.downButton)};
 }
+
+int Building::getCellButtonCount(int row, int col) const {
+    // Hall call buttons, in the first column after the elevators
+    if (isFloorDataIndex(row) && col == elevatorCount) return 2;
+
+    // Car panels, in the rows below the floors
+    if (!isElevatorIndex(col)) return 0;
+    switch (row - floorCount) {
+        case DOOR_ROW:
+            return 2;
+        case DESTINATION_ROW:
+            return floorCount;
+        case EMERGENCY_ROW:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+Building::CellButton Building::getCellButton(int row, int col,
+                                             int button) const {
+    if (button < 0 || button >= getCellButtonCount(row, col))
+        throw "ERROR: Cell button trying to be accessed doesn't exist";
+
+    if (col == elevatorCount) {
+        int floorNum = index_to_floorNum(row);
+        Direction dir = (button == 0) ? Direction::UP : Direction::DOWN;
+        bool called = hasHallCall(floorNum, dir);
+        return CellButton{button == 0 ? "UP ▲" : "DOWN ▼", called,
+                          hasHallButton(floorNum, dir),
+                          SimInput::hallCall(floorNum, dir, !called)};
+    }
+
+    int carId = index_to_carId(col);
+    const Elevator &car = *getElevator_byIndex(col);
+
+    switch (row - floorCount) {
+        case DOOR_ROW:
+            if (button == 0)
+                return CellButton{
+                    "Open ❰|❱", false, true,
+                    SimInput::carInput(SimInput::Kind::OPEN_DOORS, carId)};
+            return CellButton{
+                "Close ❱|❰", false, true,
+                SimInput::carInput(SimInput::Kind::CLOSE_DOORS, carId)};
+        case DESTINATION_ROW: {
+            int floorNum = button + 1;
+            bool called = car.hasCarCall(floorNum);
+            return CellButton{QString::number(floorNum), called,
+                              car.servesFloor(floorNum),
+                              SimInput::carCall(carId, floorNum, !called)};
+        }
+        default:
+            break;
+    }
+
+    // Emergency row
+    switch (button) {
+        case 0:
+            return CellButton{
+                "OVER\nLOAD", car.overloaded(), true,
+                SimInput::carInput(SimInput::Kind::OVERLOAD, carId,
+                                   !car.overloaded())};
+        case 1:
+            // Obstacle button cannot be used when door is already closed.
+            return CellButton{
+                "DOOR\n\nOBST\nACLE", car.doorObstacle(),
+                car.getDoorState() != SimElevator::DoorState::CLOSED,
+                SimInput::carInput(SimInput::Kind::DOOR_OBSTACLE, carId,
+                                   !car.doorObstacle())};
+        case 2:
+            return CellButton{
+                "FIRE", car.fireAlarm(), true,
+                SimInput::carInput(SimInput::Kind::FIRE_ALARM, carId,
+                                   !car.fireAlarm())};
+        default:
+            return CellButton{
+                "HELP", car.helpRequested(), true,
+                SimInput::carInput(SimInput::Kind::HELP, carId,
+                                   !car.helpRequested())};
+    }
+}
+
+void Building::pressCellButton(int row, int col, int button) {
+    if (button < 0 || button >= getCellButtonCount(row, col))
+        throw "ERROR: Cell button trying to be pressed doesn't exist";
+
+    CellButton pressed = getCellButton(row, col, button);
+    if (!pressed.enabled) return;
+
+    applyInput(pressed.input);
+
+    // Not every input changes the car's notified state (e.g. HELP during an
+    // overload), so the pressed cell is repainted regardless.
+    emit dataChanged(index(row, col), index(row, col));
+}
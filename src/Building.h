@@ -2,25 +2,61 @@
 #define BUILDING_H
 
 #include <QAbstractTableModel>
+#include <QElapsedTimer>
 #include <QMap>
+#include <QString>
+#include <QTimer>
 #include <QVector>
+#include <vector>
 
 #include "Direction.h"
+#include "InputJournal.h"
+#include "SimInput.h"
 
 // Forward declarations
+class BuildingConfig;
 class Elevator;
 class DataButton;
+class ShardedEngine;
+class SimBuilding;
+class TrajectoryDigest;
 struct floorData;
 
-/** Simulates a building with elevators.
+/** Presents a simulated building with elevators.
  *
  * Extends QAbstractTableModel, serving the role of Model in the MVC paradigm.
- * The role of the building in the simulation, holding all the floors and
- * elevators and providing a table-like interface to access through a Qt view.
+ * Thin adapter over the widget-free SimBuilding engine, holding the floor
+ * buttons and Elevator adapters and providing a table-like interface to
+ * access the simulation through a Qt view. All simulation state lives in the
+ * engine; buttons only forward presses to it and mirror its changes.
+ *
+ * The building's size, dispatch mode and car settings come from a
+ * BuildingConfig.
+ *
+ * The engine runs on a virtual clock. The model paces it against the wall
+ * clock, scaled by timeScale, so the GUI sees the simulation in real time.
+ *
+ * With shardCount above 0 the cars are instead split over that many worker
+ * threads by a ShardedEngine, each pacing its own clock. The model posts
+ * inputs to it and presents the snapshots it polls every display frame;
+ * there is no engine on the GUI thread then, and the run isn't journaled.
+ *
+ * Buttons are either real DataButton widgets, placed in the view's cells by
+ * MainWindow, or painted by a ButtonDelegate from getCellButton(). Widgets
+ * cost a QWidget per button, several thousand for large buildings, so
+ * DELEGATE mode creates none for floors and car panels. Either way, button
+ * cells follow MainWindow's layout: hall call buttons in the first column
+ * after the elevators, and each car's panel in the rows below the floors.
  *
  * Data Members:
+ * + ButtonMode: enum
+ *      Whether floor and car panel buttons are widgets or delegate-painted.
  * + floorData: struct
  *      Data struct to hold pointers to each floor's directional buttons.
+ *      Null in DELEGATE mode.
+ * + CellButton: struct
+ *      A delegate-painted button: its label, state and the input a press
+ *      applies.
  * + floorCount: int
  *      Number of floors in the building. Floors correspond to rows.
  * + elevatorCount: int
@@ -29,18 +65,57 @@ struct floorData;
  *      Number of additional rows allotted for buttons
  * + colButtonCount: int
  *      Number of additional columns allotted for buttons
+ * + buttonMode: ButtonMode
+ *      How this model's buttons are presented.
+ * + seed: unsigned
+ *      Seed of the simulation's own random generator, drawn once per model.
+ *      Initial car floors derive from it only, so a run can be reproduced.
+ *
+ * - engine: SimBuilding *
+ *      The simulation engine presented by this model. Owned by the model.
+ *      Null when sharded.
+ * - shards: ShardedEngine *
+ *      The sharded engine presented instead, or null. Owned by the model.
+ * - shardTimer: QTimer *
+ *      Repeating timer polling the shards, once per display frame.
+ * - journal: InputJournal
+ *      Every input applied to the engine, with its simulated time.
+ * - digest: TrajectoryDigest *
+ *      Digest of the engine's trajectory, stored when the journal is
+ *      finished. Owned by the model.
  *
  * - floorNum_FloorData_Map: QMap<int, floorData>
  * - carId_Elevator_Map: QMap<int, Elevator *>
  *      Ascending order mappings of floor numbers and elevator IDs to their
  *      corresponding floorData structs and Elevator pointers.
  *
+ * - pacingTimer: QTimer *
+ *      Single-shot timer armed for the engine's next event.
+ * - wallClock: QElapsedTimer
+ *      Wall-clock time since simBaseMs was last set.
+ * - simBaseMs: long long
+ *      Simulated time matching the start of wallClock.
+ * - timeScale: double
+ *      Simulated milliseconds per wall-clock millisecond. 1.0 is real time.
+ *
+ * - frameTimer: QTimer *
+ *      Single-shot timer flushing pending view updates, armed by the first
+ *      change in a frame.
+ * - frameIntervalMs: int
+ *      Minimum time between view updates, one display frame at 60 Hz.
+ * - dirtyColumns: QVector<bool>
+ *      Elevator columns changed since the last view update.
+ * - paintedFloorNums: QVector<int>
+ *      Floor number each car's cell was at in the last view update.
+ *
  * - buildingFireButton: DataButton *
  * - buildingPowerOutButton: DataButton *
  *      Buttons for toggling simulated building-wide emergencies.
  *
  * - floorButtonUiWidth: int
  *      Defines the maximum width of the floor buttons in the UI.
+ * - PanelRow: enum
+ *      Rows of a car's panel, counted from the first row below the floors.
  *
  * Class Methods:
  * + index_to_floorNum(int): int
@@ -48,14 +123,40 @@ struct floorData;
  *      Defines the relationship between data indices used in this class and
  *      floor numbers / elevator car IDs, and returns the converted numbers.
  *
- * + getQueuedFloors(Direction): QVector<int>
- *      Returns a list of floor numbers where the buttons active on the floor
- *      match the direction given. If no direction (Direction::NONE) is given,
- *      return all floors with any direction active.
+ * + getEngine(): SimBuilding *
+ *      Returns the simulation engine presented by this model, or null when
+ *      sharded.
+ * + isSharded(): bool
+ *      Returns true if the cars run on worker threads.
+ * + simulatedTimeMs(): long long
+ *      Returns the simulated time presented: the engine's clock, or the
+ *      newest shard snapshot's.
+ * + hasHallCall(int, Direction): bool
+ *      Returns true if the floor's hall call in the direction is active,
+ *      either direction for Direction::NONE.
+ * + hasHallButton(int, Direction): bool
+ *      Returns true if the floor has a hall button in the direction: a car
+ *      stopping there goes on that way.
+ * + servesFloor(int, int): bool
+ *      Returns true if a car (by ID) stops at the floor.
+ * + legFloorNum(int, int): int
+ *      Returns the floor a passenger going from one floor to another rides
+ *      to in their first car, FloorBitset::NO_FLOOR if no cars link the
+ *      floors. See SimBuilding::legFloorNum().
+ *
+ * + applyInput(const SimInput &): void
+ *      Catches the engine up to the wall clock, records an external input in
+ *      the journal, applies it to the engine, and re-arms the pacing timer
+ *      for the events it caused. When sharded, posts it to the shards.
+ * + finishedJournal(): InputJournal
+ *      Catches the engine up to the wall clock and returns a copy of the
+ *      journal ending now, with the trajectory digest stored. Throws when
+ *      sharded.
  *
- * + buildingOnFire(): bool
- * + buildingPowerOut(): bool
- *      Returns true if the related emergency is active in the building.
+ * + getTimeScale(): double
+ * + setTimeScale(double): void
+ *      Query or set the simulation speed relative to the wall clock. The
+ *      speed of sharded runs is fixed on construction.
  *
  * + getEmergencyButtons(): QVector<QWidget *>
  *      Return Qt widget pointers to the emergency simulation buttons of the
@@ -71,8 +172,27 @@ struct floorData;
  *      Getters to retrieve floorData structs and Elevator objects by either
  *      their Building data indices or assigned floor numbers/elevator car IDs.
  *
+ * + getCellButtonCount(int, int): int
+ *      Returns the number of buttons a delegate paints in a cell, 0 for
+ *      cells without buttons.
+ * + getCellButton(int, int, int): CellButton
+ *      Returns one of a cell's buttons by its position in layout order, so
+ *      a delegate builds only the buttons it paints or presses (a car's
+ *      destination panel has one per floor).
+ * + pressCellButton(int, int, int): void
+ *      Applies the input of a delegate-painted button, by its position in
+ *      the cell, and repaints its cell. Disabled buttons do nothing.
+ *
  * + Implementations of virtual functions from QAbstractTableModel
  *
+ * - initialFloorNums(const BuildingConfig &, unsigned): std::vector<int>
+ *      Draws a random starting floor for each elevator from a generator
+ *      seeded with the given seed.
+ * - createEngine(const BuildingConfig &, unsigned): SimBuilding *
+ * - createShards(const BuildingConfig &, unsigned, int): ShardedEngine *
+ *      Creates the configured engine or sharded engine, starting from
+ *      initialFloorNums(). Null if it isn't the one used.
+ *
  * - getElevator_byIndex(int) const: const Elevator *
  *      const type getter method needed in data(). Retrieves a constant
  *      version of the elevator by index for updating the view.
@@ -87,19 +207,46 @@ struct floorData;
  *      floor/elevator bound.
  *
  * - updateColumn(int): void
- *      Updates the column specified to reflect data changes in the view.
+ *      Marks an elevator column as changed, and arms frameTimer to update
+ *      the view if it isn't already.
+ * - flushViewUpdates(): void
+ *      Updates the view for every changed column, invalidating only the
+ *      car's current cell and the cell it left since the last update, plus
+ *      the car's panel in DELEGATE mode.
+ *
+ * - mirrorHallCall(int, Direction, bool): void
+ *      Shows a hall call's change on its button, without forwarding it back.
+ *
+ * - wallClockSimTime(): long long
+ *      Returns the simulated time the wall clock currently corresponds to.
+ * - paceSimulation(): void
+ *      Runs every engine event due by the wall clock, then arms pacingTimer
+ *      for the next pending event, or the next frame while a car is in a
+ *      kinematic run so its floor display follows it.
+ * - pollShards(): void
+ *      Presents the shards' new snapshots and forwards their messages as
+ *      their elevators' textOut.
  *
  * Signals:
  * + buildingDataChanged(): void
  *      Emitted when there is a change to data in the building.
  *      (e.g. Floor button pressed, elevator position changed)
+ * + destinationAssigned(int, int, int): void
+ *      Emitted when a destination request (origin, destination floor) is
+ *      assigned to a car, or moved to another one; car ID 0 if it waits for
+ *      one. Not emitted when sharded, the assignment is only logged then.
  */
 class Building : public QAbstractTableModel {
     Q_OBJECT
 
    public:
-    Building(int floorCount, int elevatorCount, int rowButtonCount = 0,
-             int colButtonCount = 0, QObject *parent = nullptr);
+    /* Public enums */
+    enum class ButtonMode { WIDGETS, DELEGATE };
+
+    Building(const BuildingConfig &config, int rowButtonCount = 0,
+             int colButtonCount = 0, ButtonMode = ButtonMode::WIDGETS,
+             int shardCount = 0, QObject *parent = nullptr);
+    ~Building();
 
     /* Public data structs */
     typedef struct floorData {
@@ -111,20 +258,38 @@ class Building : public QAbstractTableModel {
             : upButton(up), downButton(down) {}
     } floorData;
 
+    typedef struct CellButton {
+        QString label;
+        bool checked;
+        bool enabled;
+        SimInput input;
+    } CellButton;
+
     /* Public data members */
     const int floorCount;
     const int elevatorCount;
     const int rowButtonCount;
     const int colButtonCount;
+    const ButtonMode buttonMode;
+    const unsigned seed;
 
     /* Public methods */
     int index_to_floorNum(int) const;
     int index_to_carId(int) const;
 
-    const QVector<int> getQueuedFloors(Direction = Direction::NONE) const;
+    SimBuilding *getEngine();
+    bool isSharded() const;
+    long long simulatedTimeMs() const;
+    bool hasHallCall(int floorNum, Direction) const;
+    bool hasHallButton(int floorNum, Direction) const;
+    bool servesFloor(int carId, int floorNum) const;
+    int legFloorNum(int originFloorNum, int destinationFloorNum) const;
+
+    void applyInput(const SimInput &);
+    InputJournal finishedJournal();
 
-    bool buildingOnFire() const;
-    bool buildingPowerOut() const;
+    double getTimeScale() const;
+    void setTimeScale(double);
 
     QVector<QWidget *> getEmergencyButtons();
     QVector<QWidget *> getFloorButtons_byIndex(int);
@@ -135,6 +300,10 @@ class Building : public QAbstractTableModel {
     Elevator *getElevator_byIndex(int);
     Elevator *getElevator_byCarId(int);
 
+    int getCellButtonCount(int row, int col) const;
+    CellButton getCellButton(int row, int col, int button) const;
+    void pressCellButton(int row, int col, int button);
+
     /* Implemented virtual functions from QAbstractTableModel */
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
@@ -144,9 +313,27 @@ class Building : public QAbstractTableModel {
 
    signals:
     void buildingDataChanged();
+    void destinationAssigned(int originFloorNum, int destinationFloorNum,
+                             int carId);
 
    private:
     /* Private data members */
+    SimBuilding *const engine;
+    ShardedEngine *const shards;
+    TrajectoryDigest *const digest;
+    InputJournal journal;
+    QTimer *const shardTimer;
+
+    QTimer *const pacingTimer;
+    QElapsedTimer wallClock;
+    long long simBaseMs;
+    double timeScale;
+
+    QTimer *const frameTimer;
+    static const int frameIntervalMs = 16;
+    QVector<bool> dirtyColumns;
+    QVector<int> paintedFloorNums;
+
     QMap<int, floorData> floorNum_FloorData_Map;
     QMap<int, Elevator *> carId_Elevator_Map;
 
@@ -155,7 +342,15 @@ class Building : public QAbstractTableModel {
 
     static const int floorButtonUiWidth = 70;
 
+    enum PanelRow { DISPLAY_ROW, DOOR_ROW, DESTINATION_ROW, EMERGENCY_ROW };
+
     /* Private methods */
+    static std::vector<int> initialFloorNums(const BuildingConfig &,
+                                             unsigned seed);
+    static SimBuilding *createEngine(const BuildingConfig &, unsigned seed);
+    static ShardedEngine *createShards(const BuildingConfig &, unsigned seed,
+                                       int shardCount);
+
     const Elevator *getElevator_byIndex(int) const;
 
     bool isFloorDataIndex(int) const;
@@ -165,6 +360,13 @@ class Building : public QAbstractTableModel {
     void validateElevatorIndex(int) const;
 
     void updateColumn(int);
+    void flushViewUpdates();
+
+    void mirrorHallCall(int floorNum, Direction, bool active);
+
+    long long wallClockSimTime() const;
+    void paceSimulation();
+    void pollShards();
 };
 
 #endif /* BUILDING_H */
@@ -0,0 +1,189 @@
+#include "ButtonDelegate.h"
+
+#include <QAbstractItemModel>
+#include <QApplication>
+#include <QColor>
+#include <QEvent>
+#include <QModelIndex>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPalette>
+#include <QPoint>
+#include <QRect>
+#include <QString>
+#include <QSize>
+#include <QStyle>
+#include <QStyleOptionButton>
+#include <QStyleOptionViewItem>
+#include <QStyledItemDelegate>
+#include <QVector>
+#include <algorithm>
+
+#include "Building.h"
+
+const QColor ButtonDelegate::checkedColor(10, 0, 135, 153);  // 60% opacity
+
+ButtonDelegate::ButtonDelegate(Building *building, QObject *parent)
+    : QStyledItemDelegate(parent), building(building) {}
+
+void ButtonDelegate::paint(QPainter *painter,
+                           const QStyleOptionViewItem &option,
+                           const QModelIndex &index) const {
+    int count = building->getCellButtonCount(index.row(), index.column());
+    if (count == 0) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    // Only the buttons in the area being painted, out of a whole floor's
+    // worth on destination panels.
+    QRect area = option.rect;
+    if (painter->hasClipping())
+        area &= painter->clipBoundingRect().toAlignedRect();
+
+    QStyle *style =
+        option.widget ? option.widget->style() : QApplication::style();
+
+    for (int b_ind : visibleButtons(option.rect, count, area)) {
+        const Building::CellButton button =
+            building->getCellButton(index.row(), index.column(), b_ind);
+
+        QStyleOptionButton buttonOption;
+        buttonOption.rect = buttonRect(option.rect, count, b_ind);
+        buttonOption.text = button.label;
+        buttonOption.fontMetrics = option.fontMetrics;
+        buttonOption.palette = option.palette;
+        buttonOption.state = QStyle::State_Raised;
+        if (button.enabled) buttonOption.state |= QStyle::State_Enabled;
+
+        style->drawControl(QStyle::CE_PushButtonBevel, &buttonOption, painter,
+                           option.widget);
+        if (button.checked) {
+            painter->fillRect(buttonOption.rect.adjusted(1, 1, -1, -1),
+                              checkedColor);
+            buttonOption.palette.setColor(QPalette::ButtonText, Qt::white);
+        }
+        style->drawControl(QStyle::CE_PushButtonLabel, &buttonOption, painter,
+                           option.widget);
+    }
+}
+
+QSize ButtonDelegate::sizeHint(const QStyleOptionViewItem &option,
+                               const QModelIndex &index) const {
+    QSize hint = QStyledItemDelegate::sizeHint(option, index);
+
+    int count = building->getCellButtonCount(index.row(), index.column());
+    if (count == 0) return hint;
+
+    // Rows are as tall as the tallest (multi-line) label needs.
+    int rowHeight = buttonRowHeight;
+    for (int b_ind = 0; b_ind < count; ++b_ind) {
+        QString label =
+            building->getCellButton(index.row(), index.column(), b_ind).label;
+        int labelHeight =
+            option.fontMetrics.boundingRect(QRect(), 0, label).height();
+        rowHeight =
+            std::max(rowHeight, labelHeight + option.fontMetrics.height());
+    }
+
+    hint.setHeight(rowCountFor(count) * rowHeight);
+    return hint;
+}
+
+bool ButtonDelegate::editorEvent(QEvent *event, QAbstractItemModel *model,
+                                 const QStyleOptionViewItem &option,
+                                 const QModelIndex &index) {
+    // A double click's second press is a press like any other.
+    if (event->type() != QEvent::MouseButtonPress &&
+        event->type() != QEvent::MouseButtonDblClick)
+        return QStyledItemDelegate::editorEvent(event, model, option, index);
+
+    const QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+    if (mouseEvent->button() != Qt::LeftButton) return false;
+
+    int count = building->getCellButtonCount(index.row(), index.column());
+    int b_ind = buttonAt(option.rect, count, mouseEvent->pos());
+    if (b_ind < 0) return false;
+
+    building->pressCellButton(index.row(), index.column(), b_ind);
+    return true;
+}
+
+int ButtonDelegate::columnCountFor(int count) {
+    return count <= maxSingleLine ? count : overflowCols;
+}
+
+int ButtonDelegate::rowCountFor(int count) {
+    if (count <= maxSingleLine) return 1;
+    return (count + overflowCols - 1) / overflowCols;
+}
+
+int ButtonDelegate::buttonInSlot(int count, int slot) {
+    // One line in button order, otherwise rows with the last button first
+    return count <= maxSingleLine ? slot : count - 1 - slot;
+}
+
+int ButtonDelegate::edge(int start, int length, int parts, int part) {
+    return start + length * part / parts;
+}
+
+int ButtonDelegate::partAt(int start, int length, int parts, int pos) {
+    // Estimate, then step over the rounding of the edges.
+    int part = length > 0 ? (pos - start) * parts / length : 0;
+    part = std::max(0, std::min(parts - 1, part));
+    while (part > 0 && pos < edge(start, length, parts, part)) --part;
+    while (part < parts - 1 && pos >= edge(start, length, parts, part + 1))
+        ++part;
+    return part;
+}
+
+QRect ButtonDelegate::buttonRect(const QRect &cellRect, int count,
+                                 int button) {
+    int cols = columnCountFor(count);
+    int rows = rowCountFor(count);
+    int slot = buttonInSlot(count, button);
+    int row = slot / cols;
+    int col = slot % cols;
+
+    int left = edge(cellRect.left(), cellRect.width(), cols, col);
+    int right = edge(cellRect.left(), cellRect.width(), cols, col + 1);
+    int top = edge(cellRect.top(), cellRect.height(), rows, row);
+    int bottom = edge(cellRect.top(), cellRect.height(), rows, row + 1);
+    return QRect(left, top, right - left, bottom - top);
+}
+
+int ButtonDelegate::buttonAt(const QRect &cellRect, int count,
+                             const QPoint &pos) {
+    if (count == 0 || !cellRect.contains(pos)) return -1;
+
+    int cols = columnCountFor(count);
+    int rows = rowCountFor(count);
+    int slot = partAt(cellRect.top(), cellRect.height(), rows, pos.y()) * cols +
+               partAt(cellRect.left(), cellRect.width(), cols, pos.x());
+    if (slot >= count) return -1;  // Past the last button of the last row
+
+    int button = buttonInSlot(count, slot);
+    return buttonRect(cellRect, count, button).contains(pos) ? button : -1;
+}
+
+QVector<int> ButtonDelegate::visibleButtons(const QRect &cellRect, int count,
+                                            const QRect &area) {
+    QVector<int> buttons;
+    QRect visible = cellRect & area;
+    if (count == 0 || visible.isEmpty()) return buttons;
+
+    int cols = columnCountFor(count);
+    int rows = rowCountFor(count);
+    int firstRow =
+        partAt(cellRect.top(), cellRect.height(), rows, visible.top());
+    int lastRow =
+        partAt(cellRect.top(), cellRect.height(), rows, visible.bottom());
+
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            int slot = row * cols + col;
+            if (slot < count) buttons.append(buttonInSlot(count, slot));
+        }
+    }
+    return buttons;
+}
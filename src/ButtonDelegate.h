@@ -0,0 +1,103 @@
+#ifndef BUTTONDELEGATE_H
+#define BUTTONDELEGATE_H
+
+#include <QAbstractItemModel>
+#include <QColor>
+#include <QEvent>
+#include <QModelIndex>
+#include <QPainter>
+#include <QPoint>
+#include <QRect>
+#include <QSize>
+#include <QStyleOptionViewItem>
+#include <QStyledItemDelegate>
+#include <QVector>
+
+// Forward declarations
+class Building;
+
+/** Paints a Building's buttons in its view cells and handles their clicks.
+ *
+ * Stands in for per-button DataButton widgets when the building's buttons
+ * are delegate-painted (Building::ButtonMode::DELEGATE). Each paint asks the
+ * model for only the buttons in the area being painted, and a click for only
+ * the button under it, so nothing is kept per button and startup and
+ * scrolling cost the same at any building size. Cells without buttons are
+ * painted by QStyledItemDelegate as usual.
+ *
+ * Buttons are laid out like MainWindow::addIndexWidgets() lays out widgets:
+ * in one line when there are few, otherwise in rows of overflowCols with the
+ * last button first (highest floor first on destination panels).
+ *
+ * Data Members:
+ * - building: Building *
+ *      Model whose buttons are painted and pressed.
+ * - buttonRowHeight: int
+ *      Minimum height of a row of buttons, in pixels.
+ * - overflowCols / maxSingleLine: int
+ *      Buttons per row once a cell has more than maxSingleLine buttons.
+ * - checkedColor: QColor
+ *      Background of checked buttons, matching DataButton's style sheet.
+ *
+ * Class Methods:
+ * + paint(...): void
+ * + sizeHint(...): QSize
+ * + editorEvent(...): bool
+ *      QStyledItemDelegate overrides. Left clicks on an enabled button press
+ *      it through Building::pressCellButton().
+ *
+ * - columnCountFor(int): int
+ * - rowCountFor(int): int
+ *      Returns the number of button columns / rows a cell with that many
+ *      buttons uses.
+ * - buttonInSlot(int, int): int
+ *      Returns the button laid out in a slot of the grid, counted row by row
+ *      from the top left. Also the slot of a button.
+ * - edge(int, int, int, int): int
+ * - partAt(int, int, int, int): int
+ *      Returns the start of a part of a span cut in equal parts, or the
+ *      part holding a position.
+ * - buttonRect(const QRect &, int, int): QRect
+ *      Returns the rectangle of one of a cell's buttons.
+ * - buttonAt(const QRect &, int, const QPoint &): int
+ *      Returns the button of a cell at a point, -1 for none.
+ * - visibleButtons(const QRect &, int, const QRect &): QVector<int>
+ *      Returns the buttons of a cell whose row crosses an area.
+ */
+class ButtonDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+   public:
+    explicit ButtonDelegate(Building *building, QObject *parent = nullptr);
+
+    /* Implemented virtual functions from QStyledItemDelegate */
+    void paint(QPainter *, const QStyleOptionViewItem &,
+               const QModelIndex &) const override;
+    QSize sizeHint(const QStyleOptionViewItem &,
+                   const QModelIndex &) const override;
+    bool editorEvent(QEvent *, QAbstractItemModel *,
+                     const QStyleOptionViewItem &,
+                     const QModelIndex &) override;
+
+   private:
+    /* Private data members */
+    Building *const building;
+
+    static const int buttonRowHeight = 30;
+    static const int overflowCols = 3;
+    static const int maxSingleLine = 7;
+    static const QColor checkedColor;
+
+    /* Private methods */
+    static int columnCountFor(int count);
+    static int rowCountFor(int count);
+    static int buttonInSlot(int count, int slot);
+    static int edge(int start, int length, int parts, int part);
+    static int partAt(int start, int length, int parts, int pos);
+    static QRect buttonRect(const QRect &cellRect, int count, int button);
+    static int buttonAt(const QRect &cellRect, int count, const QPoint &pos);
+    static QVector<int> visibleButtons(const QRect &cellRect, int count,
+                                       const QRect &area);
+};
+
+#endif /* BUTTONDELEGATE_H */
@@ -3,6 +3,8 @@
 #include <QPushButton>
 #include <QSizePolicy>
 #include <QString>
+#include <QStyle>
+#include <QVariant>
 #include <QWidget>
 
 DataButton::DataButton(bool doDataToggle, bool doPressHold, bool c,
@@ -36,8 +38,10 @@ DataButton::DataButton(bool doDataToggle, bool doPressHold, bool c,
         setAutoRepeatInterval(autoRepeatMs);
 
         connect(this, &DataButton::released, this,
-                [this]() { this->updateStyleSheet(); });
+                [this]() { this->updateStyle(); });
     }
+
+    updateStyle();
 }
 
 bool DataButton::isChecked() const { return checked; }
@@ -45,24 +49,31 @@ bool DataButton::isChecked() const { return checked; }
 void DataButton::setChecked(bool newState) {
     if (checked != newState) {
         checked = newState;
-        updateStyleSheet();
+        updateStyle();
         emit buttonCheckedUpdate();
     }
 }
 
 void DataButton::flipChecked() { setChecked(!checked); }
 
-void DataButton::updateStyleSheet() {
-    /** Qt Style Sheet strings for styling the buttons' checked and unchecked
-     *  states. */
-    const QString checkedStyleSheetStr =
+const QString &DataButton::styleSheet() {
+    /** Qt Style Sheet string for styling the buttons' checked state. */
+    static const QString styleSheetStr =
+        "DataButton[active=\"true\"] {"
         "background-color: rgba(10, 0, 135, 60%);"
-        "color: rgb(255,255,255);";
-    const QString unCheckedStyleSheetStr = "";
+        "color: rgb(255,255,255);"
+        "}";
+    return styleSheetStr;
+}
 
+void DataButton::updateStyle() {
     // If the button is currently held down, style it as if checked.
-    if (checked || (doPressHold && isDown()))
-        setStyleSheet(checkedStyleSheetStr);
-    else
-        setStyleSheet(unCheckedStyleSheetStr);
+    bool active = checked || (doPressHold && isDown());
+    if (property("active").toBool() == active) return;
+
+    // Property selectors are only re-evaluated on a repolish.
+    setProperty("active", active);
+    style()->unpolish(this);
+    style()->polish(this);
+    update();
 }
@@ -32,9 +32,14 @@
  *      Set checked state to supplied boolean.
  * + flipChecked(): void
  *      Invert the current checked state.
- * # updateStyleSheet(): void (abstract)
- *      Sets a Qt style sheet on the button according to current button state.
- *      May be overridden by subclasses.
+ * + styleSheet(): const QString &
+ *      Qt style sheet for every DataButton, keyed on the "active" property.
+ *      Installed once on a parent widget, so state changes never re-parse
+ *      a style sheet.
+ * # updateStyle(): void (abstract)
+ *      Sets the button's "active" property according to current button state
+ *      and repolishes it if the property changed. May be overridden by
+ *      subclasses.
  *
  * Signals:
  * + buttonCheckedUpdate(): void
@@ -52,6 +57,8 @@ class DataButton : public QPushButton {
     void setChecked(bool);
     void flipChecked();
 
+    static const QString &styleSheet();
+
    signals:
     void buttonCheckedUpdate();
 
@@ -63,7 +70,7 @@ class DataButton : public QPushButton {
     bool checked;
 
     /* Protected methods */
-    virtual void updateStyleSheet();
+    virtual void updateStyle();
 };
 
 #endif /* DATABUTTON_H */
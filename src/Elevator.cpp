@@ -3,380 +3,274 @@
 #include <QBrush>
 #include <QMap>
 #include <QObject>
+#include <QSignalBlocker>
 #include <QString>
-#include <QTimer>
 #include <QVector>
 #include <QWidget>
-#include <algorithm>
+#include <string>
 
 #include "Building.h"
 #include "DataButton.h"
+#include "SimElevator.h"
+#include "SimInput.h"
 
-Elevator::Elevator(int initialFloorNum, Building *parentBuilding,
-                   QObject *parent)
-    : QObject(parent),
-      parentBuilding(parentBuilding),
-      openButton(new DataButton(false, true, false, "Open ❰|❱")),
-      closeButton(new DataButton(false, true, false, "Close ❱|❰")),
-      fireButton(new DataButton(true, false, false, "FIRE")),
-      obstacleButton(new DataButton(true, false, false, "DOOR\n\nOBST\nACLE")),
-      helpButton(new DataButton(true, false, false, "HELP")),
-      overloadButton(new DataButton(true, false, false, "OVER\nLOAD")),
-      currentMovement(MovementState::STOPPED),
-      currentDoor(DoorState::CLOSED),
-      currentEmergency(EmergencyState::NONE),
-      movementTimer(new QTimer(this)),
-      doorSpeedTimer(new QTimer(this)),
-      doorWaitTimer(new QTimer(this)),
-      doorCloseFailures(0),
-      currentFloorNum(initialFloorNum) {
-    // Set initial obstacle simulation button state.
-    obstacleButton->setDisabled(currentDoor == DoorState::CLOSED ? true
-                                                                 : false);
-
-    // Connect door override buttons to their functionality slots
-    connect(openButton, &DataButton::buttonCheckedUpdate, this,
-            &Elevator::openDoors);
-    connect(closeButton, &DataButton::buttonCheckedUpdate, this,
-            &Elevator::closeDoors);
-
-    // Connect emergency buttons to the update slot
-    connect(fireButton, &DataButton::buttonCheckedUpdate, this,
-            &Elevator::updateEmergency);
-    connect(obstacleButton, &DataButton::buttonCheckedUpdate, this,
-            &Elevator::updateEmergency);
-    connect(helpButton, &DataButton::buttonCheckedUpdate, this,
-            &Elevator::updateEmergency);
-    connect(overloadButton, &DataButton::buttonCheckedUpdate, this,
-            &Elevator::updateEmergency);
-
-    // Compute new movement when building data has changed
-    connect(parentBuilding, &Building::buildingDataChanged, this,
-            &Elevator::determineMovement);
-
-    // Initialize destination buttons and connect them to elevator updates.
-    for (int f_ind = 0; f_ind < parentBuilding->floorCount; ++f_ind) {
-        int floorNum = parentBuilding->index_to_floorNum(f_ind);
+namespace {
 
-        DataButton *destButton =
-            new DataButton(true, false, false, QString("%1").arg(floorNum));
+typedef SimElevator::MovementState MovementState;
+typedef SimElevator::DoorState DoorState;
+typedef SimElevator::EmergencyState EmergencyState;
 
-        destinationButtons.insert(floorNum, destButton);
+const int movementCount = int(MovementState::DOWNWARDS) + 1;
+const int doorCount = int(DoorState::OPEN) + 1;
+const int emergencyCount = int(EmergencyState::HELP) + 1;
 
-        connect(destButton, &DataButton::buttonCheckedUpdate, this,
-                &Elevator::determineMovement);
-    }
-
-    /* Set up timers */
-    movementTimer->setInterval(movementMs);
-    doorSpeedTimer->setInterval(doorSpeedMs);
-    doorWaitTimer->setInterval(doorWaitMs);
-
-    // Behavior for elevator movement timer timeout (elevator movement complete)
-    connect(movementTimer, &QTimer::timeout, this, [this]() {
-        switch (currentMovement) {
-            case MovementState::UPWARDS:
-                // Elevator finishes upward movement.
-                ++currentFloorNum;
-                emit elevatorDataChanged();
-                break;
-            case MovementState::DOWNWARDS:
-                // Elevator finishes downward movement.
-                --currentFloorNum;
-                emit elevatorDataChanged();
-                break;
-            default:
-                break;
-        }
-    });
-
-    // Behavior for door movement timer timeout (door transition complete)
-    connect(doorSpeedTimer, &QTimer::timeout, this, [this]() {
-        switch (this->currentDoor) {
-            case DoorState::CLOSING:
-                // Check sensors to see if door closure can be completed
-                if (this->doorSensorSeesObstacle()) {
-                    // Obstacle detected, abort and open again
-                    this->doorCloseFailures++;
-                    emit this->textOut(QString("(Light sensors detected "
-                                               "obstacle! Failures: %1/%2)")
-                                           .arg(this->doorCloseFailures)
-                                           .arg(this->doorCloseFailThreshold));
-                    this->openDoors();
-                } else {
-                    // Successfully closed
-                    this->doorCloseFailures = 0;
-                    this->setDoorState(DoorState::CLOSED);
-                }
-
-                // Door obstacle state may have been triggered or cleared
-                this->updateEmergency();
-                break;
-            case DoorState::OPENING:
-                // Successfully opened
-                this->setDoorState(DoorState::OPEN);
-
-                this->doorWaitTimer->start();  // Start idle timer
-                break;
-            default:
-                break;
-        }
-    });
-
-    // Behavior for door wait timer timeout (doors automatically closing)
-    connect(doorWaitTimer, &QTimer::timeout, this, [this]() {
-        if (this->currentDoor == DoorState::OPEN) this->closeDoors();
-    });
+// Delegate-painted car panels need no button widgets.
+DataButton *newButton(const Building *building, bool doDataToggle,
+                      bool doPressHold, const QString &label) {
+    if (building->buttonMode == Building::ButtonMode::DELEGATE) return nullptr;
+    return new DataButton(doDataToggle, doPressHold, false, label);
 }
 
-const QString Elevator::getElevatorString() const {
-    QString movementStr;
-    QString doorStr;
-    QString emergencyStr;
-
-    switch (currentMovement) {
-        case Elevator::MovementState::STOPPED:
-            movementStr = "STOP -";
-            break;
-        case Elevator::MovementState::UPWARDS:
-            movementStr = "UP ▲";
-            break;
-        case Elevator::MovementState::DOWNWARDS:
-            movementStr = "DOWN ▼";
-            break;
+// Parts of the status label, for each state of the car.
+QString movementLabel(MovementState movement) {
+    switch (movement) {
+        case MovementState::STOPPED:
+            return "STOP -";
+        case MovementState::UPWARDS:
+            return "UP ▲";
+        case MovementState::DOWNWARDS:
+            return "DOWN ▼";
         default:
             throw "ERROR: Invalid Movement enum";
     }
-    switch (currentDoor) {
-        case Elevator::DoorState::CLOSED:
-            doorStr = "Closed.";
-            break;
-        case Elevator::DoorState::CLOSING:
-            doorStr = "Closing...";
-            break;
-        case Elevator::DoorState::OPENING:
-            doorStr = "Opening...";
-            break;
-        case Elevator::DoorState::OPEN:
-            doorStr = "Open.";
-            break;
+}
+
+QString doorLabel(DoorState door) {
+    switch (door) {
+        case DoorState::CLOSED:
+            return "Closed.";
+        case DoorState::CLOSING:
+            return "Closing...";
+        case DoorState::OPENING:
+            return "Opening...";
+        case DoorState::OPEN:
+            return "Open.";
         default:
             throw "ERROR: Invalid door state enum";
     }
-    switch (currentEmergency) {
-        case Elevator::EmergencyState::NONE:
-            emergencyStr = "";
-            break;
-        case Elevator::EmergencyState::FIRE:
-            emergencyStr = "\nFIRE";
-            break;
-        case Elevator::EmergencyState::POWER_OUT:
-            emergencyStr = "\nPOWER OUT";
-            break;
-        case Elevator::EmergencyState::OVERLOAD:
-            emergencyStr = "\nOVERLOAD";
-            break;
-        case Elevator::EmergencyState::DOOR_OBSTACLE:
-            emergencyStr = "\nDOOR OBSTACLE";
-            break;
-        case Elevator::EmergencyState::HELP:
-            emergencyStr = "\nHELP";
-            break;
+}
+
+QString emergencyLabel(EmergencyState emergency) {
+    switch (emergency) {
+        case EmergencyState::NONE:
+            return "";
+        case EmergencyState::FIRE:
+            return "\nFIRE";
+        case EmergencyState::POWER_OUT:
+            return "\nPOWER OUT";
+        case EmergencyState::OVERLOAD:
+            return "\nOVERLOAD";
+        case EmergencyState::DOOR_OBSTACLE:
+            return "\nDOOR OBSTACLE";
+        case EmergencyState::HELP:
+            return "\nHELP";
         default:
             throw "ERROR: Invalid emergency enum";
     }
-
-    return QString("%1\n%2%3").arg(movementStr, doorStr, emergencyStr);
 }
 
-bool Elevator::isMoving() const {
-    return currentMovement != MovementState::STOPPED;
-}
+}  // namespace
 
-bool Elevator::isAtSafeFloor() const { return currentFloorNum == safeFloor; }
+Elevator::Elevator(SimElevator *car, Building *parentBuilding, QObject *parent)
+    : Elevator(car->carId, car, CarSnapshot(), parentBuilding, parent) {
+    /* Car hooks */
+    car->hooks.dataChanged = [this]() {
+        updateObstacleButton();
+        emit elevatorDataChanged();
+    };
+    car->hooks.arrived = [this]() { emit elevatorArrived(); };
+    car->hooks.carCallChanged = [this](int floorNum, bool active) {
+        if (!destinationButtons.contains(floorNum)) return;
+
+        // Mirror only, the change must not be forwarded back to the engine.
+        DataButton *destButton = destinationButtons[floorNum];
+        const QSignalBlocker blocker(destButton);
+        destButton->setChecked(active);
+    };
+    car->hooks.textOut = [this](const std::string &text) {
+        emit textOut(QString::fromStdString(text));
+    };
+}
 
-void Elevator::determineMovement() {
-    updateEmergency();  // Update emergency state first
+Elevator::Elevator(const CarSnapshot &state, Building *parentBuilding,
+                   QObject *parent)
+    : Elevator(state.carId, nullptr, state, parentBuilding, parent) {}
 
-    int targetFloor;
+Elevator::Elevator(int carId, SimElevator *car, const CarSnapshot &state,
+                   Building *parentBuilding, QObject *parent)
+    : QObject(parent),
+      car(car),
+      state(state),
+      parentBuilding(parentBuilding),
+      openButton(newButton(parentBuilding, false, true, "Open ❰|❱")),
+      closeButton(newButton(parentBuilding, false, true, "Close ❱|❰")),
+      fireButton(newButton(parentBuilding, true, false, "FIRE")),
+      obstacleButton(
+          newButton(parentBuilding, true, false, "DOOR\n\nOBST\nACLE")),
+      helpButton(newButton(parentBuilding, true, false, "HELP")),
+      overloadButton(newButton(parentBuilding, true, false, "OVER\nLOAD")),
+      carId(carId) {
+    if (parentBuilding->buttonMode == Building::ButtonMode::WIDGETS)
+        initButtonWidgets();
+}
 
-    if (currentEmergency == EmergencyState::OVERLOAD) {
-        // Cannot leave until overload is resolved
-        targetFloor = currentFloorNum;
-    } else if (currentEmergency == EmergencyState::FIRE ||
-               currentEmergency == EmergencyState::POWER_OUT) {
-        // Seek a safe floor, disregard queues.
-        targetFloor = safeFloor;
-    } else {
-        // Collect floors that have their up/down floor buttons pressed,
-        // or are targeted by this elevator's destination button panel.
+void Elevator::initButtonWidgets() {
+    // Set initial obstacle simulation button state.
+    updateObstacleButton();
 
-        QVector<int> queuedFloors = parentBuilding->getQueuedFloors();
-        queuedFloors.append(queuedDestinations());
+    // Connect door override buttons to the car
+    connect(openButton, &DataButton::buttonCheckedUpdate, this, [this]() {
+        this->parentBuilding->applyInput(
+            SimInput::carInput(SimInput::Kind::OPEN_DOORS, carId));
+    });
+    connect(closeButton, &DataButton::buttonCheckedUpdate, this, [this]() {
+        this->parentBuilding->applyInput(
+            SimInput::carInput(SimInput::Kind::CLOSE_DOORS, carId));
+    });
 
-        // No eligible floors queued
-        if (queuedFloors.isEmpty()) {
-            setMovement(MovementState::STOPPED);
-            return;
-        }
+    // Connect emergency buttons to the car's emergency inputs
+    connect(fireButton, &DataButton::buttonCheckedUpdate, this, [this]() {
+        this->parentBuilding->applyInput(SimInput::carInput(
+            SimInput::Kind::FIRE_ALARM, carId, fireButton->isChecked()));
+    });
+    connect(obstacleButton, &DataButton::buttonCheckedUpdate, this, [this]() {
+        this->parentBuilding->applyInput(
+            SimInput::carInput(SimInput::Kind::DOOR_OBSTACLE, carId,
+                               obstacleButton->isChecked()));
+    });
+    connect(helpButton, &DataButton::buttonCheckedUpdate, this, [this]() {
+        this->parentBuilding->applyInput(SimInput::carInput(
+            SimInput::Kind::HELP, carId, helpButton->isChecked()));
+    });
+    connect(overloadButton, &DataButton::buttonCheckedUpdate, this, [this]() {
+        this->parentBuilding->applyInput(SimInput::carInput(
+            SimInput::Kind::OVERLOAD, carId, overloadButton->isChecked()));
+    });
 
-        // Sort floors
-        std::sort(queuedFloors.begin(), queuedFloors.end());
+    // Initialize destination buttons and connect them to the car's calls.
+    for (int f_ind = 0; f_ind < parentBuilding->floorCount; ++f_ind) {
+        int floorNum = parentBuilding->index_to_floorNum(f_ind);
 
-        // Remove duplicate floors
-        queuedFloors.erase(
-            std::unique(queuedFloors.begin(), queuedFloors.end()),
-            queuedFloors.end());
+        DataButton *destButton =
+            new DataButton(true, false, false, QString("%1").arg(floorNum));
+        destButton->setDisabled(!servesFloor(floorNum));  // Zoned car
 
-        // Compute optimal floor to move to
-        targetFloor = closestQueuedFloor(queuedFloors);
-    }
+        destinationButtons.insert(floorNum, destButton);
 
-    if (currentFloorNum == targetFloor) {
-        // Stop elevator on current floor.
-        setMovement(MovementState::STOPPED);
-        openDoors();
-        destinationButtons[currentFloorNum]->setChecked(false);
-        emit elevatorArrived();
-    } else if (currentDoor == DoorState::CLOSED) {
-        // Elevator needs to go to a target, and is able to move.
-        if (currentFloorNum < targetFloor)
-            setMovement(MovementState::UPWARDS);
-        else if (currentFloorNum > targetFloor)
-            setMovement(MovementState::DOWNWARDS);
+        connect(destButton, &DataButton::buttonCheckedUpdate, this,
+                [this, floorNum, destButton]() {
+                    bool active = destButton->isChecked();
+                    this->parentBuilding->applyInput(
+                        SimInput::carCall(carId, floorNum, active));
+                });
     }
 }
 
-void Elevator::ring() { emit textOut(QString("*ring!*")); }
-
-void Elevator::openDoors() {
-    // Only attempt to open doors if the elevator is not moving
-    if (isMoving()) return;
-
-    switch (currentDoor) {
-        case DoorState::CLOSED:
-        case DoorState::CLOSING:
-            // Start opening the doors and ring bell
-            setDoorState(DoorState::OPENING);
-            doorSpeedTimer->start();  // Start door movement
-            ring();
-            break;
-        case DoorState::OPEN:
-            // Extend open time (reset timer)
-            doorWaitTimer->start();
-            break;
-        case DoorState::OPENING:
-            // Already opening, no effect.
-            break;
-        default:
-            throw "ERROR: Elevator in impossible DoorState";
-            break;
-    }
+void Elevator::updateObstacleButton() {
+    // Obstacle button cannot be used when door is already closed.
+    if (obstacleButton)
+        obstacleButton->setDisabled(getDoorState() ==
+                                    SimElevator::DoorState::CLOSED);
 }
 
-void Elevator::closeDoors() {
-    // Doors would already be closed if elevator is moving,
-    // and doors should stay open in applicable emergency states
-    if (isMoving() || currentEmergency == EmergencyState::OVERLOAD ||
-        ((currentEmergency == EmergencyState::FIRE ||
-          currentEmergency == EmergencyState::POWER_OUT) &&
-         isAtSafeFloor()))
-        return;
-
-    switch (currentDoor) {
-        case DoorState::OPEN:
-        case DoorState::OPENING:
-            // Start closing the doors and ring bell
-            setDoorState(DoorState::CLOSING);
-            doorWaitTimer->stop();    // Door timeout not relevant anymore
-            doorSpeedTimer->start();  // Start door movement
-            ring();
-            break;
-        case DoorState::CLOSED:
-        case DoorState::CLOSING:
-            // Already closing or closed, no effect.
-            break;
-        default:
-            throw "ERROR: Elevator in impossible DoorState";
-            break;
-    }
+int Elevator::currentFloorNum() const {
+    // Cars in a kinematic run catch up lazily; show where they are now.
+    return car ? car->floorNumAt(parentBuilding->simulatedTimeMs())
+               : state.floorNum;
 }
-
-void Elevator::setMovement(Elevator::MovementState newMovement) {
-    if (currentMovement != newMovement) {
-        currentMovement = newMovement;
-
-        if (isMoving())
-            this->movementTimer->start();
-        else
-            this->movementTimer->stop();
-
-        emit elevatorDataChanged();
-    }
+MovementState Elevator::getMovement() const {
+    return car ? car->getMovement() : state.movement;
+}
+DoorState Elevator::getDoorState() const {
+    return car ? car->getDoorState() : state.door;
+}
+EmergencyState Elevator::getEmergency() const {
+    return car ? car->getEmergency() : state.emergency;
+}
+bool Elevator::isAtSafeFloor() const {
+    return car ? car->isAtSafeFloor() : state.atSafeFloor;
+}
+bool Elevator::hasCarCall(int floorNum) const {
+    return car ? car->hasCarCall(floorNum) : state.carCalls.test(floorNum);
+}
+bool Elevator::servesFloor(int floorNum) const {
+    return car ? car->servesFloor(floorNum)
+               : parentBuilding->servesFloor(carId, floorNum);
 }
 
-void Elevator::setDoorState(Elevator::DoorState newDoorState) {
-    if (currentDoor != newDoorState) {
-        currentDoor = newDoorState;
+bool Elevator::fireAlarm() const {
+    return car ? car->fireAlarm() : state.fireAlarm;
+}
+bool Elevator::doorObstacle() const {
+    return car ? car->doorObstacle() : state.doorObstacle;
+}
+bool Elevator::helpRequested() const {
+    return car ? car->helpRequested() : state.helpRequested;
+}
+bool Elevator::overloaded() const {
+    return car ? car->overloaded() : state.overloaded;
+}
 
-        // Obstacle button cannot be used when door is already closed.
-        if (currentDoor == DoorState::CLOSED)
-            obstacleButton->setDisabled(true);
-        else
-            obstacleButton->setDisabled(false);
+void Elevator::applySnapshot(const CarSnapshot &next) {
+    if (car) throw "ERROR: Elevator is presented from the engine";
 
-        emit elevatorDataChanged();
+    // Mirror only, the changes must not be forwarded back to the shard.
+    if (!destinationButtons.isEmpty() && next.carCalls != state.carCalls) {
+        for (auto i = destinationButtons.begin(); i != destinationButtons.end();
+             ++i) {
+            const QSignalBlocker blocker(i.value());
+            i.value()->setChecked(next.carCalls.test(i.key()));
+        }
     }
-}
 
-const QVector<int> Elevator::queuedDestinations() const {
-    QVector<int> queued;
-
-    for (auto i = destinationButtons.cbegin(), end = destinationButtons.cend();
-         i != end; ++i) {
-        if (i.value()->isChecked()) queued.append(i.key());
+    bool changed = next.floorNum != state.floorNum ||
+                   next.movement != state.movement ||
+                   next.door != state.door ||
+                   next.emergency != state.emergency ||
+                   next.atSafeFloor != state.atSafeFloor ||
+                   next.fireAlarm != state.fireAlarm ||
+                   next.doorObstacle != state.doorObstacle ||
+                   next.helpRequested != state.helpRequested ||
+                   next.overloaded != state.overloaded ||
+                   next.carCalls != state.carCalls;
+    state = next;
+
+    if (changed) {
+        updateObstacleButton();
+        emit elevatorDataChanged();
     }
-    return queued;
 }
 
-int Elevator::closestQueuedFloor(const QVector<int> &floors) const {
-    // This method should only be called on a nonempty list of floors.
-
-    if (floors.isEmpty()) return currentFloorNum;  // Fallback
-
-    // Current floor is below or above all queued floors.
-    if (currentFloorNum <= floors.first()) return floors.first();
-    if (currentFloorNum >= floors.last()) return floors.last();
-
-    // Current floor is between two queued floors, before and after.
-    const int *closestIt = std::adjacent_find(
-        floors.begin(), floors.end(), [this](int before, int after) {
-            return currentFloorNum >= before && currentFloorNum <= after;
-        });
-
-    int closestBefore = *closestIt;       // Closest queued before current
-    int closestAfter = *(closestIt + 1);  // Closest queued after current
-
-    // Distances to each floor.
-    int distBefore = currentFloorNum - closestBefore;
-    int distAfter = closestAfter - currentFloorNum;
-
-    /*
-    Return the floor that is closer. In case of a tie, the floor that was
-    on the direction the elevator was moving is prioritized. If the elevator
-    had no direction it was moving in, the lower floor is prioritized.
-    */
-    if (distBefore < distAfter) {
-        return closestBefore;
-    } else if (distAfter < distBefore) {
-        return closestAfter;
-    } else {
-        // Distance tied
-        if (currentMovement == MovementState::UPWARDS)
-            return closestAfter;  // Higher floor
-        else
-            return closestBefore;  // Lower floor
-    }
+const QString &Elevator::getElevatorString() const {
+    // Every status label, formatted once: movement x door x emergency.
+    static const QVector<QString> labels = []() {
+        QVector<QString> table;
+        for (int m_ind = 0; m_ind < movementCount; ++m_ind)
+            for (int d_ind = 0; d_ind < doorCount; ++d_ind)
+                for (int e_ind = 0; e_ind < emergencyCount; ++e_ind)
+                    table.append(
+                        QString("%1\n%2%3")
+                            .arg(movementLabel(MovementState(m_ind)),
+                                 doorLabel(DoorState(d_ind)),
+                                 emergencyLabel(EmergencyState(e_ind))));
+        return table;
+    }();
+
+    int index =
+        (int(getMovement()) * doorCount + int(getDoorState())) *
+            emergencyCount +
+        int(getEmergency());
+    return labels[index];
 }
 
 QVector<QWidget *> Elevator::getDoorButtonWidgets() {
@@ -401,117 +295,77 @@ QVector<QWidget *> Elevator::getDestButtonWidgets() {
     return toReturn;
 }
 
-const QString Elevator::getTextDisplay() const {
+const QString &Elevator::getTextDisplay() const {
+    static const QString help =
+        "HELP: (connecting to building safety service or 911...)";
+    static const QString fireSafe =
+        "FIRE: Safe floor reached. Please disembark.";
+    static const QString fireMoving = "FIRE: Moving to safe floor.";
+    static const QString powerOutSafe =
+        "POWER OUTAGE: Safe floor reached. Please disembark.";
+    static const QString powerOutMoving =
+        "POWER OUTAGE: Running on emergency power. Moving to safe floor.";
+    static const QString overload = "OVERLOAD: Please reduce the load.";
+    static const QString doorObstacle =
+        "DOOR OBSTACLE: Please clear the doorway.";
+    static const QString goingUp = "▲ Going up...";
+    static const QString goingDown = "▼ Going down...";
+    static const QString stopped = "- Stopped.";
+    static const QString none = "";
+
     // Emergencies take priority in display
-    switch (currentEmergency) {
+    switch (getEmergency()) {
         case EmergencyState::HELP:
-            return "HELP: (connecting to building safety service or 911...)";
+            return help;
         case EmergencyState::FIRE:
-            if ((currentMovement == MovementState::STOPPED) && isAtSafeFloor())
-                return "FIRE: Safe floor reached. Please disembark.";
+            if (getMovement() == MovementState::STOPPED && isAtSafeFloor())
+                return fireSafe;
             else
-                return "FIRE: Moving to safe floor.";
+                return fireMoving;
         case EmergencyState::POWER_OUT:
-            if ((currentMovement == MovementState::STOPPED) && isAtSafeFloor())
-                return "POWER OUTAGE: Safe floor reached. Please disembark.";
+            if (getMovement() == MovementState::STOPPED && isAtSafeFloor())
+                return powerOutSafe;
             else
-                return "POWER OUTAGE: Running on emergency power. Moving to "
-                       "safe floor.";
+                return powerOutMoving;
         case EmergencyState::OVERLOAD:
-            return "OVERLOAD: Please reduce the load.";
+            return overload;
         case EmergencyState::DOOR_OBSTACLE:
-            return "DOOR OBSTACLE: Please clear the doorway.";
+            return doorObstacle;
         case EmergencyState::NONE:
         default:
             break;
     }
 
     // Display movement
-    switch (currentMovement) {
+    switch (getMovement()) {
         case MovementState::UPWARDS:
-            return "▲ Going up...";
+            return goingUp;
         case MovementState::DOWNWARDS:
-            return "▼ Going down...";
+            return goingDown;
         case MovementState::STOPPED:
-            return "- Stopped.";
+            return stopped;
         default:
             break;
     }
 
-    return "";
-}
-
-void Elevator::updateEmergency() {
-    EmergencyState newState;
-
-    // Earlier cases take priority when multiple are active.
-    if (overloadButton->isChecked()) {
-        // Overload has first priority, elevator cannot move when overloaded
-        newState = EmergencyState::OVERLOAD;
-    } else if (parentBuilding->buildingPowerOut()) {
-        // Power out in building
-        newState = EmergencyState::POWER_OUT;
-    } else if (fireButton->isChecked() || parentBuilding->buildingOnFire()) {
-        // Fire in elevator or building
-        newState = EmergencyState::FIRE;
-    } else if (doorCloseFailures >= doorCloseFailThreshold) {
-        // Enough door close failures accumulated, start door obstacle state
-        newState = EmergencyState::DOOR_OBSTACLE;
-    } else if (helpButton->isChecked()) {
-        // Help button pressed, connect to safety services or 911.
-        newState = EmergencyState::HELP;
-    } else {
-        // No applicable emergencies
-        newState = EmergencyState::NONE;
-    }
-
-    if (currentEmergency != newState) {
-        currentEmergency = newState;
-
-        // Audio warnings (using inline console instead of actual audio output)
-        switch (currentEmergency) {
-            case EmergencyState::FIRE:
-                emit textOut(
-                    "A fire has been detected. Moving towards safe floor.");
-                break;
-            case EmergencyState::POWER_OUT:
-                emit textOut(
-                    "A power outage has been detected. Moving towards safe "
-                    "floor.");
-                break;
-            case EmergencyState::OVERLOAD:
-                emit textOut("Overload. Please reduce the load.");
-                break;
-            case EmergencyState::DOOR_OBSTACLE:
-                emit textOut(
-                    "Door obstacle detected. Please clear the doorway.");
-                break;
-            case EmergencyState::HELP:
-                emit textOut("(connected to building safety service or 911)");
-                break;
-            case EmergencyState::NONE:
-            default:
-                break;
-        }
-
-        emit elevatorDataChanged();
-    }
+    return none;
 }
 
-bool Elevator::doorSensorSeesObstacle() const {
-    return obstacleButton->isChecked();
-}
+const QBrush &Elevator::getElevatorColor() const {
+    static const QBrush opening(Qt::darkGreen);
+    static const QBrush open(Qt::green);
+    static const QBrush closing(Qt::darkCyan);
+    static const QBrush closed(Qt::cyan);
 
-const QBrush Elevator::getElevatorColor() const {
-    switch (currentDoor) {
-        case Elevator::DoorState::OPENING:
-            return QBrush(Qt::darkGreen);
-        case Elevator::DoorState::OPEN:
-            return QBrush(Qt::green);
-        case Elevator::DoorState::CLOSING:
-            return QBrush(Qt::darkCyan);
-        case Elevator::DoorState::CLOSED:
+    switch (getDoorState()) {
+        case DoorState::OPENING:
+            return opening;
+        case DoorState::OPEN:
+            return open;
+        case DoorState::CLOSING:
+            return closing;
+        case DoorState::CLOSED:
         default:
-            return QBrush(Qt::cyan);
+            return closed;
     }
 }
@@ -5,31 +5,38 @@
 #include <QMap>
 #include <QObject>
 #include <QString>
-#include <QTimer>
 #include <QVector>
 #include <QWidget>
 
+#include "CarSnapshot.h"
+#include "SimElevator.h"
+
 // Forward declarations
 class DataButton;
 class Building;
 
-/** Store and compute elevator movement and state.
+/** Qt adapter exposing an engine elevator car to the UI.
  *
- * Decentralized elevator class. Receives signals from the parent building
- * notifying of an update to the building state, computes movement and
- * emergency state, and notifies of change in its status to the building.
+ * Thin layer over a SimElevator owned by the engine. Forwards button presses
+ * to the car through the parent Building (which paces the simulation clock),
+ * keeps the buttons in sync with the car's state and re-emits car changes as
+ * Qt signals.
  *
- * Enums:
- * - MovementState
- *      Whether the elevator is moving, and to which direction.
- * - DoorState
- *      What state the elevator's doors can be in.
- * - EmergencyState
- *      The exceptional states the elevator can be in.
+ * A car simulated on a shard's worker thread can't be touched from the GUI
+ * thread, so it is presented from the CarSnapshots its Building passes to
+ * applySnapshot() instead. The state getters read whichever the car has.
  *
  * Data Members:
+ * + carId: int
+ *      ID of the car this adapter presents.
+ *
+ * - car: SimElevator *
+ *      Pointer to the engine car this adapter presents. Null when the car
+ *      runs on a shard.
+ * - state: CarSnapshot
+ *      Latest snapshot of a car running on a shard.
  * - parentBuilding: Building *
- *      Pointer to the Building that Elevator exists in.
+ *      Pointer to the Building adapter that inputs are applied through.
  *
  * - openButton: DataButton *
  * - closeButton: DataButton *
@@ -37,80 +44,35 @@ class Building;
  * - obstacleButton: DataButton *
  * - helpButton: DataButton *
  * - overloadButton: DataButton *
- *      Pointers to door override and emergency simulation buttons.
+ *      Pointers to door override and emergency simulation buttons. Null
+ *      when the parent building's buttons are delegate-painted.
  *
  * - destinationButtons: QMap<int, DataButton *>
  *      Mapping of floor numbers to their corresponding buttons on the elevator
- *      destination panel.
- *
- * - currentMovement: MovementState
- *      Current elevator movement.
- * - currentDoor: DoorState
- *      Current door state.
- * - currentEmergency: EmergencyState
- *      Current emergency state. Elevator can be in one emergency state, with
- *      implementation-dependent priorities.
- *
- * - movementTimer: QTimer *
- *      Timer for simulating the speed at which an elevator reaches a new floor.
- * - doorSpeedTimer: QTimer *
- *      Timer for simulating the speed at which a door will fully open or close.
- * - doorWaitTimer: QTimer *
- *      Timer for simulating the time an elevator's doors will stay open.
- * - movementMs: int
- *      How long it takes for an elevator to reach a new floor, in milliseconds.
- * - doorSpeedMs: int
- *      How long it takes for the doors to open or close fully, in milliseconds.
- * - doorWaitMs: int
- *      How long an open elevator will wait until closing the doors.
- *
- * - doorCloseFailures: int
- *      Number of failed attempts to close the door, incremented when the door
- *      sensors detect an obstacle, reset to zero when the door successfully
- *      closes.
- * - doorCloseFailThreshold: int
- *      Max number of failed door close attempts before the elevator will alert
- *      passengers of a door obstacle.
- *
- * - safeFloor: int
- *      Safe floor an elevator should head to in an applicable emergency.
- *
- * + currentFloorNum: int
- *      The number of the floor the elevator is currently at.
+ *      destination panel. Empty when buttons are delegate-painted.
  *
  * Class Methods:
- * - setMovement(MovementState): void
- * - setDoorState(DoorState): void
- *      Private setters that will emit signals or trigger responses on data
- *      change.
- *
- * - updateEmergency(): void
- *      Checks the relevant data for applicable elevator emergency states at
- *      that moment, and applies it to the elevator.
- *
- * - doorSensorSeesObstacle(): bool
- *      Returns true if the elevator light sensors detect an obstacle.
- *
- * - ring(): void
- *      Rings the bell of the elevator.
- *
- * - queuedDestinations(): QVector<int>
- *      Returns a list of floors that have active buttons on the panel.
- *
- * - closestQueuedFloor(QVector<int>): int
- *      From a supplied nonempty list of floor numbers, computes and returns the
- *      ideal floor to visit next from the elevator's current floor.
- *
- * - isMoving(): bool
- *      Returns true if the elevator is currently moving.
- *
- * - isAtSafeFloor(): bool
- *      Returns true if the elevator is currently at a safe floor.
- *
- * + getElevatorString(): QString
- *      Returns a string representing the elevator's current status.
- *
- * + getTextDisplay(): QString
+ * + currentFloorNum(): int
+ *      The number of the floor the elevator is currently at, or has last
+ *      passed during a kinematic run.
+ * + getMovement() / getDoorState() / getEmergency(): SimElevator enums
+ * + isAtSafeFloor(): bool
+ * + hasCarCall(int): bool
+ * + servesFloor(int): bool
+ * + fireAlarm() / doorObstacle() / helpRequested() / overloaded(): bool
+ *      The car's state, as the SimElevator getters of the same name return
+ *      it.
+ *
+ * + applySnapshot(const CarSnapshot &): void
+ *      Presents a new snapshot of a car running on a shard, mirroring its
+ *      destination panel and emitting elevatorDataChanged if its state
+ *      changed. Throws for cars presented from the engine.
+ *
+ * + getElevatorString(): const QString &
+ *      Returns a string representing the elevator's current status. All 72
+ *      possible strings are formatted once and shared by every elevator.
+ *
+ * + getTextDisplay(): const QString &
  *      Returns a string to display in the elevator's display panel.
  *
  * + getDoorButtonWidgets(): QVector<QWidget *>
@@ -119,38 +81,32 @@ class Building;
  *      Getters returning QWidget pointers of the elevator's buttons, for use in
  *      adding them to the UI in MainWindow.
  *
- * + getElevatorColor(): QBrush
+ * + getElevatorColor(): const QBrush &
  *      Returns the appropriate background colour for the elevator in the view.
+ *      Brushes are created once and shared by every elevator.
+ *
+ * - initButtonWidgets(): void
+ *      Creates the destination buttons and connects every button to the car.
+ *      Only used when the parent building's buttons are widgets.
+ * - updateObstacleButton(): void
+ *      Disables the obstacle button while the door is closed.
  *
  * Signals:
+ * + elevatorDataChanged(): void
+ *      Emitted when an aspect of the car has changed.
+ * + elevatorArrived(): void
+ *      Emitted when the car has stopped at a floor to take passengers. Not
+ *      emitted for cars running on a shard.
  * + textOut(const QString &): void
  *      Emitted to display text in the UI. Captured by MainWindow.
- *
- * Slots:
- * - determineMovement(): void
- *      Examine the current elevator data and compute next movement.
- *
- * - openDoors(): void
- * - closeDoors(): void
- *      Opens or closes the elevator's doors if it is currently possible to.
  */
 class Elevator : public QObject {
     Q_OBJECT
 
    private:
-    /* Private enums */
-    enum class MovementState { STOPPED, UPWARDS, DOWNWARDS };
-    enum class DoorState { CLOSED, CLOSING, OPENING, OPEN };
-    enum class EmergencyState {
-        NONE,
-        FIRE,
-        POWER_OUT,
-        OVERLOAD,
-        DOOR_OBSTACLE,
-        HELP
-    };
-
     /* Private data members */
+    SimElevator *const car;
+    CarSnapshot state;
     Building *const parentBuilding;
 
     DataButton *const openButton;
@@ -163,57 +119,46 @@ class Elevator : public QObject {
 
     QMap<int, DataButton *> destinationButtons;
 
-    MovementState currentMovement;
-    DoorState currentDoor;
-    EmergencyState currentEmergency;
-
-    QTimer *const movementTimer;
-    QTimer *const doorSpeedTimer;
-    QTimer *const doorWaitTimer;
-
-    static const int movementMs = 1000;  // 1 second
-    static const int doorSpeedMs = 800;  // 0.8 seconds
-    static const int doorWaitMs = 1500;  // 1.5 seconds
-
-    int doorCloseFailures;
-
-    static const int doorCloseFailThreshold = 3;
-
-    static const int safeFloor = 1;
-
     /* Private methods */
-    void setMovement(MovementState);
-    void setDoorState(DoorState);
-
-    void updateEmergency();
-
-    bool doorSensorSeesObstacle() const;
-
-    void ring();
-
-    const QVector<int> queuedDestinations() const;
+    void initButtonWidgets();
+    void updateObstacleButton();
 
-    int closestQueuedFloor(const QVector<int> &floors) const;
-
-    bool isMoving() const;
-    bool isAtSafeFloor() const;
+    Elevator(int carId, SimElevator *car, const CarSnapshot &state,
+             Building *parentBuilding, QObject *parent);
 
    public:
-    Elevator(int initialFloorNum, Building *parentBuilding,
+    Elevator(SimElevator *car, Building *parentBuilding,
+             QObject *parent = nullptr);
+    Elevator(const CarSnapshot &state, Building *parentBuilding,
              QObject *parent = nullptr);
 
     /* Public data members */
-    int currentFloorNum;
+    const int carId;
 
     /* Public methods */
-    const QString getElevatorString() const;
-    const QString getTextDisplay() const;
+    int currentFloorNum() const;
+    SimElevator::MovementState getMovement() const;
+    SimElevator::DoorState getDoorState() const;
+    SimElevator::EmergencyState getEmergency() const;
+    bool isAtSafeFloor() const;
+    bool hasCarCall(int floorNum) const;
+    bool servesFloor(int floorNum) const;
+
+    bool fireAlarm() const;
+    bool doorObstacle() const;
+    bool helpRequested() const;
+    bool overloaded() const;
+
+    void applySnapshot(const CarSnapshot &);
+
+    const QString &getElevatorString() const;
+    const QString &getTextDisplay() const;
 
     QVector<QWidget *> getDoorButtonWidgets();
     QVector<QWidget *> getDestButtonWidgets();
     QVector<QWidget *> getEmergencyButtonWidgets();
 
-    const QBrush getElevatorColor() const;
+    const QBrush &getElevatorColor() const;
 
    signals:
     // Fired when an aspect of the elevator has changed.
@@ -225,13 +170,6 @@ class Elevator : public QObject {
 
    signals:
     void textOut(const QString &);
-
-   private slots:
-    void determineMovement();
-
-    // Attempt to open or close the doors
-    void openDoors();
-    void closeDoors();
 };
 
 #endif /* ELEVATOR_H */
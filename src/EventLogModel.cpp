@@ -0,0 +1,110 @@
+#include "EventLogModel.h"
+
+#include <QAbstractListModel>
+#include <QModelIndex>
+#include <QString>
+#include <QTimer>
+#include <QVariant>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "LogRecord.h"
+
+EventLogModel::EventLogModel(int capacity, QObject *parent)
+    : QAbstractListModel(parent),
+      head(0),
+      count(0),
+      capacity(capacity),
+      frameTimer(new QTimer(this)) {
+    if (capacity < 1) throw "ERROR: Event log needs room for one record";
+
+    frameTimer->setSingleShot(true);
+    frameTimer->setInterval(frameIntervalMs);
+    connect(frameTimer, &QTimer::timeout, this, &EventLogModel::flushIncoming);
+}
+
+int EventLogModel::getCapacity() const { return capacity; }
+
+void EventLogModel::setCapacity(int newCapacity) {
+    if (newCapacity < 1) throw "ERROR: Event log needs room for one record";
+    flushIncoming();
+
+    // Keep the newest records, moved to the start of a new ring.
+    int kept = std::min(count, newCapacity);
+    std::vector<LogRecord> newRing;
+    newRing.reserve(kept);
+    for (int row = count - kept; row < count; ++row)
+        newRing.push_back(ring[slot(row)]);
+
+    beginResetModel();
+    ring.swap(newRing);
+    head = 0;
+    count = kept;
+    capacity = newCapacity;
+    endResetModel();
+}
+
+void EventLogModel::append(const LogRecord &record) {
+    incoming.push_back(record);
+    if (!frameTimer->isActive()) frameTimer->start();
+}
+
+const LogRecord &EventLogModel::getRecord(int row) const {
+    if (row < 0 || row >= count)
+        throw "ERROR: Event log row trying to be accessed doesn't exist";
+    return ring[slot(row)];
+}
+
+int EventLogModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : count;
+}
+
+QVariant EventLogModel::data(const QModelIndex &index, int role) const {
+    if (role != Qt::DisplayRole || index.row() < 0 || index.row() >= count)
+        return QVariant();
+
+    const LogRecord &record = ring[slot(index.row())];
+    QString source = record.carId ? QString("Elevator %1").arg(record.carId)
+                                  : QString("Building");
+    return QString("[%1 s] %2: %3")
+        .arg(record.timeMs / 1000.0, 0, 'f', 1)
+        .arg(source, QString::fromStdString(record.text));
+}
+
+void EventLogModel::flushIncoming() {
+    frameTimer->stop();
+    if (incoming.empty()) return;
+
+    // Only the newest records of a large burst would survive anyway.
+    size_t skipped = incoming.size() > size_t(capacity)
+                         ? incoming.size() - size_t(capacity)
+                         : 0;
+    int added = int(incoming.size() - skipped);
+
+    // Make room by dropping the oldest shown records.
+    int overflow = count + added - capacity;
+    if (overflow > 0) {
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        head = (head + overflow) % size_t(capacity);
+        count -= overflow;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), count, count + added - 1);
+    for (size_t r_ind = skipped; r_ind < incoming.size(); ++r_ind) {
+        size_t index = slot(count);
+        if (index == ring.size())
+            ring.push_back(std::move(incoming[r_ind]));
+        else
+            ring[index] = std::move(incoming[r_ind]);
+        ++count;
+    }
+    endInsertRows();
+
+    incoming.clear();
+}
+
+size_t EventLogModel::slot(int row) const {
+    return (head + size_t(row)) % size_t(capacity);
+}
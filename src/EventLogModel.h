@@ -0,0 +1,90 @@
+#ifndef EVENTLOGMODEL_H
+#define EVENTLOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QModelIndex>
+#include <QTimer>
+#include <QVariant>
+#include <cstddef>
+#include <vector>
+
+#include "LogRecord.h"
+
+/** Bounded event log, presented as a list model.
+ *
+ * Keeps the newest `capacity` records in a ring buffer; older ones are
+ * discarded as new ones arrive, so memory and view cost stay bounded however
+ * long the simulation runs. Records are appended to the view at most once
+ * per display frame, in one batch, so bursts of messages from many cars cost
+ * one view update. Shown in a virtualized view, only visible rows are ever
+ * formatted.
+ *
+ * Data Members:
+ * - ring: std::vector<LogRecord>
+ *      Ring buffer of shown records, grown up to capacity.
+ * - head: size_t
+ *      Index in ring of the oldest shown record.
+ * - count: int
+ *      Number of shown records.
+ * - capacity: int
+ *      Most records shown at once.
+ * - incoming: std::vector<LogRecord>
+ *      Records appended since the last view update.
+ * - frameTimer: QTimer *
+ *      Single-shot timer moving incoming records into the ring, armed by
+ *      the first append in a frame.
+ * - frameIntervalMs: int
+ *      Minimum time between view updates, one display frame at 60 Hz.
+ *
+ * Class Methods:
+ * + getCapacity(): int
+ * + setCapacity(int): void
+ *      Query or set the most records shown. Shrinking keeps the newest.
+ * + append(const LogRecord &): void
+ *      Adds a record, shown from the next frame on.
+ * + getRecord(int): const LogRecord &
+ *      Returns the record shown at a row, oldest first.
+ *
+ * + Implementations of virtual functions from QAbstractListModel
+ *
+ * - flushIncoming(): void
+ *      Moves incoming records into the ring, dropping the oldest records
+ *      past capacity, and informs the view.
+ * - slot(int): size_t
+ *      Index in ring of a row.
+ */
+class EventLogModel : public QAbstractListModel {
+    Q_OBJECT
+
+   public:
+    explicit EventLogModel(int capacity = 1000, QObject *parent = nullptr);
+
+    /* Public methods */
+    int getCapacity() const;
+    void setCapacity(int);
+
+    void append(const LogRecord &);
+    const LogRecord &getRecord(int row) const;
+
+    /* Implemented virtual functions from QAbstractListModel */
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index,
+                  int role = Qt::DisplayRole) const override;
+
+   private:
+    /* Private data members */
+    std::vector<LogRecord> ring;
+    size_t head;
+    int count;
+    int capacity;
+
+    std::vector<LogRecord> incoming;
+    QTimer *const frameTimer;
+    static const int frameIntervalMs = 16;
+
+    /* Private methods */
+    void flushIncoming();
+    size_t slot(int row) const;
+};
+
+#endif /* EVENTLOGMODEL_H */
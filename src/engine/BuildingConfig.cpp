@@ -0,0 +1,265 @@
+#include "BuildingConfig.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <istream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CarConfig.h"
+#include "SimBuilding.h"
+
+namespace {
+
+std::string trim(const std::string &text) {
+    const char *space = " \t\r\n";
+    size_t begin = text.find_first_not_of(space);
+    if (begin == std::string::npos) return "";
+    return text.substr(begin, text.find_last_not_of(space) - begin + 1);
+}
+
+int parseInt(const std::string &text) {
+    std::string digits = trim(text);
+    char *end = nullptr;
+    errno = 0;
+    long value = std::strtol(digits.c_str(), &end, 10);
+    if (digits.empty() || *end != '\0' || errno == ERANGE ||
+        value < -2147483647L || value > 2147483647L)
+        throw "ERROR: Building setting is not a whole number";
+    return int(value);
+}
+
+// Comma-separated floor numbers and ranges, as in "1, 21-40"
+std::vector<int> parseFloorNums(const std::string &text) {
+    std::vector<int> floorNums;
+    size_t start = 0;
+    while (true) {
+        size_t comma = text.find(',', start);
+        std::string item = text.substr(start, comma - start);
+        size_t dash = item.find('-');
+        if (dash == std::string::npos) {
+            floorNums.push_back(parseInt(item));
+        } else {
+            int first = parseInt(item.substr(0, dash));
+            int last = parseInt(item.substr(dash + 1));
+            if (first > last) throw "ERROR: Floor range runs backwards";
+            for (int floorNum = first; floorNum <= last; ++floorNum)
+                floorNums.push_back(floorNum);
+        }
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    return floorNums;
+}
+
+}  // namespace
+
+BuildingConfig::BuildingConfig()
+    : floorCount(7),
+      elevatorCount(3),
+      dispatchMode(SimBuilding::DispatchMode::GROUP),
+      dispatchPolicy(SimBuilding::defaultDispatchPolicy),
+      energyBudgetMs(0),
+      idleParking(false),
+      parkDelayMs(SimBuilding::defaultParkDelayMs) {}
+
+BuildingConfig BuildingConfig::load(std::istream &in) {
+    BuildingConfig config;
+    int sectionCarId = 0;  // 0 while in building scope
+
+    std::string line;
+    while (std::getline(in, line)) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+
+        // Section headers
+        if (line.front() == '[') {
+            if (line.back() != ']')
+                throw "ERROR: Building profile has an unclosed section";
+            std::string section = trim(line.substr(1, line.size() - 2));
+
+            if (section == "building") {
+                sectionCarId = 0;
+            } else if (section.compare(0, 4, "car ") == 0) {
+                sectionCarId = parseInt(section.substr(4));
+                if (sectionCarId < 1) throw "ERROR: Car ID must be positive";
+            } else {
+                throw "ERROR: Building profile has an unknown section";
+            }
+            continue;
+        }
+
+        size_t equals = line.find('=');
+        if (equals == std::string::npos)
+            throw "ERROR: Building profile line is not key = value";
+        std::string key = trim(line.substr(0, equals));
+        std::string value = trim(line.substr(equals + 1));
+
+        if (sectionCarId == 0)
+            config.set(key, value);
+        else
+            config.setForCar(sectionCarId, key, value);
+    }
+    return config;
+}
+
+void BuildingConfig::set(const std::string &key, const std::string &value) {
+    if (key == "floors") {
+        floorCount = parseInt(value);
+        if (floorCount < 1) throw "ERROR: Building needs at least one floor";
+    } else if (key == "cars") {
+        elevatorCount = parseInt(value);
+        if (elevatorCount < 1)
+            throw "ERROR: Building needs at least one elevator";
+    } else if (key == "dispatch") {
+        if (value == "group")
+            dispatchMode = SimBuilding::DispatchMode::GROUP;
+        else if (value == "nearest")
+            dispatchMode = SimBuilding::DispatchMode::NEAREST_CALL;
+        else if (value == "destination")
+            dispatchMode = SimBuilding::DispatchMode::DESTINATION;
+        else
+            throw "ERROR: Dispatch mode must be group, nearest or destination";
+    } else if (key == "policy") {
+        std::vector<std::string> names = SimBuilding::dispatchPolicyNames();
+        if (std::find(names.begin(), names.end(), value) == names.end())
+            throw "ERROR: Unknown dispatch policy";
+        dispatchPolicy = value;
+    } else if (key == "energyBudgetMs") {
+        energyBudgetMs = parseInt(value);
+        if (energyBudgetMs < 0)
+            throw "ERROR: Energy wait budget can't be negative";
+    } else if (key == "parking") {
+        if (value == "predictive")
+            idleParking = true;
+        else if (value == "off")
+            idleParking = false;
+        else
+            throw "ERROR: Parking must be predictive or off";
+    } else if (key == "parkDelayMs") {
+        parkDelayMs = parseInt(value);
+        if (parkDelayMs < 0) throw "ERROR: Park delay can't be negative";
+    } else if (!applyCarSetting(carDefaults, key, value)) {
+        throw "ERROR: Unknown building setting";
+    }
+}
+
+void BuildingConfig::setForCar(int carId, const std::string &key,
+                               const std::string &value) {
+    if (carId < 1) throw "ERROR: Car ID must be positive";
+
+    // Validate now, so errors point at the setting rather than a later use.
+    CarConfig scratch;
+    if (!applyCarSetting(scratch, key, value))
+        throw "ERROR: Unknown car setting";
+
+    carSettings[carId].push_back(Setting(key, value));
+}
+
+std::vector<CarConfig> BuildingConfig::carConfigs() const {
+    if (!carSettings.empty() && carSettings.rbegin()->first > elevatorCount)
+        throw "ERROR: Car settings given for a car the building doesn't have";
+
+    std::vector<CarConfig> configs(elevatorCount, carDefaults);
+    for (const auto &car : carSettings)
+        for (const Setting &setting : car.second)
+            applyCarSetting(configs[car.first - 1], setting.first,
+                            setting.second);
+    return configs;
+}
+
+std::unique_ptr<SimBuilding> BuildingConfig::createBuilding(
+    const std::vector<int> &initialFloorNums) const {
+    std::unique_ptr<SimBuilding> building(new SimBuilding(
+        floorCount, elevatorCount, initialFloorNums, carConfigs()));
+    building->setDispatchMode(dispatchMode);
+    building->setDispatchPolicy(dispatchPolicy);
+    building->setEnergyBudgetMs(energyBudgetMs);
+    building->setParkDelayMs(parkDelayMs);
+    building->setIdleParking(idleParking);
+    return building;
+}
+
+bool BuildingConfig::applyCarSetting(CarConfig &config, const std::string &key,
+                                     const std::string &value) {
+    int *timing = nullptr;
+    if (key == "movementMs")
+        timing = &config.movementMs;
+    else if (key == "doorSpeedMs")
+        timing = &config.doorSpeedMs;
+    else if (key == "doorWaitMs")
+        timing = &config.doorWaitMs;
+    else if (key == "transferMs")
+        timing = &config.transferMs;
+
+    if (timing) {
+        *timing = parseInt(value);
+        if (*timing < 1)
+            throw "ERROR: Car timings must be at least 1 millisecond";
+    } else if (key == "floorHeightMm" || key == "accelMmps2" ||
+               key == "jerkMmps3") {
+        int setting = parseInt(value);
+        if (setting < 1)
+            throw "ERROR: Motion profile settings must be positive";
+
+        if (key == "floorHeightMm")
+            config.floorHeightMm = setting;
+        else if (key == "accelMmps2")
+            config.accelMmps2 = setting;
+        else
+            config.jerkMmps3 = setting;
+    } else if (key == "maxSpeedMmps") {
+        // 0 turns the motion profile off
+        config.maxSpeedMmps = parseInt(value);
+        if (config.maxSpeedMmps < 0)
+            throw "ERROR: Car max speed can't be negative";
+    } else if (key == "ratedLoadKg") {
+        config.ratedLoadKg = parseInt(value);
+        if (config.ratedLoadKg < 1)
+            throw "ERROR: Car rated load must be at least 1 kg";
+    } else if (key == "carMassKg") {
+        config.carMassKg = parseInt(value);
+        if (config.carMassKg < 1)
+            throw "ERROR: Car mass must be at least 1 kg";
+    } else if (key == "counterweightPercent" || key == "regenPercent" ||
+               key == "driveEfficiencyPercent") {
+        int share = parseInt(value);
+        if (share < 0 || share > 100)
+            throw "ERROR: Car energy shares must be 0 to 100 percent";
+
+        if (key == "counterweightPercent")
+            config.counterweightPercent = share;
+        else if (key == "regenPercent")
+            config.regenPercent = share;
+        else if (share < 1)
+            throw "ERROR: Drive efficiency must be at least 1 percent";
+        else
+            config.driveEfficiencyPercent = share;
+    } else if (key == "doorPowerW" || key == "standbyPowerW") {
+        int power = parseInt(value);
+        if (power < 0) throw "ERROR: Car power draws can't be negative";
+
+        if (key == "doorPowerW")
+            config.doorPowerW = power;
+        else
+            config.standbyPowerW = power;
+    } else if (key == "doorCloseFailThreshold") {
+        config.doorCloseFailThreshold = parseInt(value);
+        if (config.doorCloseFailThreshold < 1)
+            throw "ERROR: Door close failure threshold must be at least 1";
+    } else if (key == "safeFloors") {
+        config.safeFloorNums = parseFloorNums(value);
+    } else if (key == "servedFloors") {
+        // "all" undoes a building-wide list for one car
+        if (trim(value) == "all")
+            config.servedFloorNums.clear();
+        else
+            config.servedFloorNums = parseFloorNums(value);
+    } else {
+        return false;
+    }
+    return true;
+}
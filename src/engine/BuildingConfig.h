@@ -0,0 +1,130 @@
+#ifndef BUILDINGCONFIG_H
+#define BUILDINGCONFIG_H
+
+#include <istream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CarConfig.h"
+#include "SimBuilding.h"
+
+/** Building profile read at runtime: size, dispatch mode and car settings.
+ *
+ * Lets one binary run any number of building profiles. A profile is a text
+ * file of "key = value" lines; '#' starts a comment. Settings before any
+ * section apply to the building and every car; a "[car N]" section
+ * overrides settings of car N only, and "[building]" returns to building
+ * scope. Per-car overrides are applied on top of the building-wide values
+ * when the configs are built, so their order in the file doesn't matter.
+ *
+ *      floors = 1000
+ *      cars = 100
+ *      dispatch = group            # or nearest, destination
+ *      policy = collective         # or nearest-floor
+ *      energyBudgetMs = 20000      # wait traded for energy, 0 for none
+ *      parking = predictive        # or off
+ *      parkDelayMs = 30000
+ *      movementMs = 1000
+ *      doorSpeedMs = 800
+ *      doorWaitMs = 1500
+ *      transferMs = 1000           # per passenger boarding or alighting
+ *      ratedLoadKg = 1000
+ *      doorCloseFailThreshold = 3
+ *      safeFloors = 1, 500
+ *      regenPercent = 60           # regenerative drive
+ *
+ *      [car 3]
+ *      movementMs = 500
+ *      servedFloors = 1, 401-1000  # high-rise bank, express past 2-400
+ *      safeFloors = 1, 401
+ *
+ *      [car 4]                     # express car with a motion profile
+ *      maxSpeedMmps = 6000
+ *      accelMmps2 = 1200
+ *
+ * Floor lists take single floors and ranges. Without servedFloors (or with
+ * "servedFloors = all") a car stops at every floor.
+ *
+ * Command-line options use the same keys through set().
+ *
+ * Data Members:
+ * + floorCount / elevatorCount: int
+ *      Building size. Defaults to 7 floors and 3 cars.
+ * + dispatchMode: SimBuilding::DispatchMode
+ *      How hall calls are distributed among cars. Defaults to GROUP.
+ * + dispatchPolicy: std::string
+ *      Name of the policy cars pick their next floor by, see SimBuilding.
+ *      Defaults to "nearest-floor".
+ * + energyBudgetMs: long long
+ *      How much longer a call may wait for a car using less energy, see
+ *      SimBuilding. Defaults to 0, always the soonest car.
+ * + idleParking / parkDelayMs: bool / long long
+ *      Whether idle cars park where demand is expected, and after how long
+ *      idle, see SimBuilding. Default to off and 30 seconds.
+ * + carDefaults: CarConfig
+ *      Settings of every car without an override.
+ *
+ * - carSettings: std::map<int, std::vector<Setting>>
+ *      Per-car overrides by car ID, as validated key/value pairs.
+ *
+ * Class Methods:
+ * + load(std::istream &): BuildingConfig
+ *      Reads a profile over the defaults. Throws on malformed lines, unknown
+ *      keys and invalid values.
+ * + set(const std::string &, const std::string &): void
+ *      Applies one building-wide setting. Throws like load().
+ * + setForCar(int, const std::string &, const std::string &): void
+ *      Applies one setting to a single car. Throws like load().
+ *
+ * + carConfigs(): std::vector<CarConfig>
+ *      Returns each car's settings, by car ID. Throws if an override names a
+ *      car the building doesn't have.
+ * + createBuilding(const std::vector<int> &): std::unique_ptr<SimBuilding>
+ *      Builds the configured building with cars at the given floors.
+ *
+ * - applyCarSetting(CarConfig &, const std::string &, const std::string &):
+ *   bool
+ *      Applies a car setting to a config. Returns false if the key isn't a
+ *      car setting.
+ */
+class BuildingConfig {
+   public:
+    BuildingConfig();
+
+    /* Public data members */
+    int floorCount;
+    int elevatorCount;
+    SimBuilding::DispatchMode dispatchMode;
+    std::string dispatchPolicy;
+    long long energyBudgetMs;
+    bool idleParking;
+    long long parkDelayMs;
+    CarConfig carDefaults;
+
+    /* Public methods */
+    static BuildingConfig load(std::istream &);
+
+    void set(const std::string &key, const std::string &value);
+    void setForCar(int carId, const std::string &key,
+                   const std::string &value);
+
+    std::vector<CarConfig> carConfigs() const;
+    std::unique_ptr<SimBuilding> createBuilding(
+        const std::vector<int> &initialFloorNums) const;
+
+   private:
+    /* Private data structs */
+    typedef std::pair<std::string, std::string> Setting;
+
+    /* Private data members */
+    std::map<int, std::vector<Setting>> carSettings;
+
+    /* Private methods */
+    static bool applyCarSetting(CarConfig &, const std::string &key,
+                                const std::string &value);
+};
+
+#endif /* BUILDINGCONFIG_H */
@@ -0,0 +1,91 @@
+#ifndef CARCONFIG_H
+#define CARCONFIG_H
+
+#include <vector>
+
+/** Timing and safety settings of one elevator car.
+ *
+ * Defaults match the original fixed settings of every car, which is rated
+ * for 1000 kg (13 persons).
+ *
+ * Data Members:
+ * + movementMs / doorSpeedMs / doorWaitMs: int
+ *      Time to reach a new floor, to fully open or close the doors, and to
+ *      keep the doors open before closing them, in milliseconds.
+ * + floorHeightMm / maxSpeedMmps / accelMmps2 / jerkMmps3: int
+ *      Motion profile: height between floors, and the car's top speed,
+ *      acceleration and jerk limits, in millimetres and seconds. With
+ *      maxSpeedMmps at 0, the default, the car has no motion profile and
+ *      takes movementMs per floor instead. See FlightTable.
+ * + ratedLoadKg: int
+ *      Rated load. The load weighing device reports an overload above it.
+ * + carMassKg / counterweightPercent: int
+ *      Mass of the empty car, and the share of the rated load its
+ *      counterweight balances on top of it.
+ * + driveEfficiencyPercent / regenPercent: int
+ *      Share of the energy drawn that the drive turns into work, and share
+ *      of the work done on it (braking, overhauling loads) that it feeds
+ *      back. A regenPercent of 0, the default, is a drive burning it in a
+ *      braking resistor.
+ * + doorPowerW / standbyPowerW: int
+ *      Power the door operator draws while the doors move, and the car
+ *      draws all the time (controller, lighting, ventilation). See
+ *      EnergyModel.
+ * + transferMs: int
+ *      Time each passenger takes to board or alight, in milliseconds. The
+ *      doors stay open until everyone at a stop has transferred.
+ * + doorCloseFailThreshold: int
+ *      Max number of failed door close attempts before the elevator will
+ *      alert passengers of a door obstacle.
+ * + safeFloorNums: std::vector<int>
+ *      Floors the car may head to in an applicable emergency. The car goes
+ *      to the nearest one it serves.
+ * + servedFloorNums: std::vector<int>
+ *      Floors the car stops at, for zoned buildings: a low-rise bank serving
+ *      the lobby and the lower floors, a shuttle running express between
+ *      the lobby and a sky lobby. Empty, the default, for every floor. Cars
+ *      serving the same floors form a bank sharing its hall calls, see
+ *      SimBuilding.
+ */
+typedef struct CarConfig {
+    int movementMs;
+    int doorSpeedMs;
+    int doorWaitMs;
+    int floorHeightMm;
+    int maxSpeedMmps;
+    int accelMmps2;
+    int jerkMmps3;
+    int ratedLoadKg;
+    int carMassKg;
+    int counterweightPercent;
+    int driveEfficiencyPercent;
+    int regenPercent;
+    int doorPowerW;
+    int standbyPowerW;
+    int transferMs;
+    int doorCloseFailThreshold;
+    std::vector<int> safeFloorNums;
+    std::vector<int> servedFloorNums;
+
+    CarConfig()
+        : movementMs(1000),  // 1 second
+          doorSpeedMs(800),  // 0.8 seconds
+          doorWaitMs(1500),  // 1.5 seconds
+          floorHeightMm(3500),
+          maxSpeedMmps(0),  // No motion profile
+          accelMmps2(1000),
+          jerkMmps3(1500),
+          ratedLoadKg(1000),
+          carMassKg(1200),
+          counterweightPercent(50),
+          driveEfficiencyPercent(80),
+          regenPercent(0),  // Braking resistor
+          doorPowerW(200),
+          standbyPowerW(300),
+          transferMs(1000),  // 1 second
+          doorCloseFailThreshold(3),
+          safeFloorNums({1}),
+          servedFloorNums() {}
+} CarConfig;
+
+#endif /* CARCONFIG_H */
@@ -0,0 +1,35 @@
+#include "CarSnapshot.h"
+
+#include "FloorBitset.h"
+#include "SimElevator.h"
+
+CarSnapshot::CarSnapshot()
+    : carId(0),
+      floorNum(0),
+      movement(SimElevator::MovementState::STOPPED),
+      door(SimElevator::DoorState::CLOSED),
+      emergency(SimElevator::EmergencyState::NONE),
+      atSafeFloor(false),
+      fireAlarm(false),
+      doorObstacle(false),
+      helpRequested(false),
+      overloaded(false),
+      carCalls(1) {}
+
+CarSnapshot CarSnapshot::of(const SimElevator &car, long long timeMs) {
+    CarSnapshot snapshot;
+    snapshot.carId = car.carId;
+    snapshot.floorNum = car.floorNumAt(timeMs);
+    snapshot.movement = car.getMovement();
+    snapshot.door = car.getDoorState();
+    snapshot.emergency = car.getEmergency();
+    snapshot.atSafeFloor = car.isAtSafeFloor();
+
+    snapshot.fireAlarm = car.fireAlarm();
+    snapshot.doorObstacle = car.doorObstacle();
+    snapshot.helpRequested = car.helpRequested();
+    snapshot.overloaded = car.overloaded();
+
+    snapshot.carCalls = car.getCarCalls();
+    return snapshot;
+}
@@ -0,0 +1,47 @@
+#ifndef CARSNAPSHOT_H
+#define CARSNAPSHOT_H
+
+#include "FloorBitset.h"
+#include "SimElevator.h"
+
+/** Copy of everything the UI shows about a car, at one point in time.
+ *
+ * Lets a car simulated on another thread be presented without touching its
+ * SimElevator: the thread running the car copies its state into a snapshot,
+ * and the UI reads only the copy.
+ *
+ * Data Members:
+ * + carId / floorNum: int
+ * + movement / door / emergency: SimElevator enums
+ * + atSafeFloor: bool
+ *      Car state, as the SimElevator getters return it.
+ * + fireAlarm / doorObstacle / helpRequested / overloaded: bool
+ *      The car's emergency inputs.
+ * + carCalls: FloorBitset
+ *      Floors with an active destination panel call.
+ *
+ * Class Methods:
+ * + of(const SimElevator &, long long): CarSnapshot
+ *      Copies a car's state at the given simulated time, which places a car
+ *      in a kinematic run at the floor it has reached.
+ */
+typedef struct CarSnapshot {
+    int carId;
+    int floorNum;
+    SimElevator::MovementState movement;
+    SimElevator::DoorState door;
+    SimElevator::EmergencyState emergency;
+    bool atSafeFloor;
+
+    bool fireAlarm;
+    bool doorObstacle;
+    bool helpRequested;
+    bool overloaded;
+
+    FloorBitset carCalls;
+
+    CarSnapshot();
+    static CarSnapshot of(const SimElevator &, long long timeMs);
+} CarSnapshot;
+
+#endif /* CARSNAPSHOT_H */
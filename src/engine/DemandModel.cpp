@@ -0,0 +1,111 @@
+#include "DemandModel.h"
+
+#include <cmath>
+#include <vector>
+
+#include "FloorBitset.h"
+
+const long long DemandModel::slotMs;
+const long long DemandModel::dayMs;
+constexpr double DemandModel::dayDecay;
+const long long DemandModel::slotCount;
+
+namespace {
+
+// Division rounding down, so times before 0 fall in the previous day.
+long long floorDiv(long long value, long long divisor) {
+    return value >= 0 ? value / divisor : -((divisor - 1 - value) / divisor);
+}
+
+}  // namespace
+
+DemandModel::DemandModel(int floorCount)
+    : floorCount(floorCount),
+      counts(slotCount * floorCount, 0.0f),
+      slotDays(slotCount, -1) {
+    if (floorCount < 1) throw "ERROR: Demand model needs at least one floor";
+}
+
+void DemandModel::record(long long timeMs, int floorNum) {
+    if (floorNum < 1 || floorNum > floorCount)
+        throw "ERROR: Floor number out of range";
+
+    long long slot = slotOf(timeMs);
+    long long day = dayOf(timeMs);
+    float *row = &counts[slot * floorCount];
+
+    // First call of the slot today: decay the earlier days.
+    if (slotDays[slot] != day) {
+        float weight = float(slotWeight(slot, day));
+        for (int f_ind = 0; f_ind < floorCount; ++f_ind) row[f_ind] *= weight;
+        slotDays[slot] = day;
+    }
+    row[floorNum - 1] += 1.0f;
+}
+
+double DemandModel::expectedCalls(long long timeMs, int floorNum) const {
+    if (floorNum < 1 || floorNum > floorCount)
+        throw "ERROR: Floor number out of range";
+
+    return callsAt(forecastAt(timeMs), floorNum);
+}
+
+int DemandModel::medianFloor(long long timeMs, int fromFloorNum,
+                             int toFloorNum,
+                             const FloorBitset &floorNums) const {
+    if (fromFloorNum < 1 || toFloorNum > floorCount)
+        throw "ERROR: Floor number out of range";
+
+    Forecast forecast = forecastAt(timeMs);
+    double total = 0;
+    for (int floorNum = fromFloorNum; floorNum <= toFloorNum; ++floorNum)
+        if (floorNums.test(floorNum)) total += callsAt(forecast, floorNum);
+    if (total <= 0) return FloorBitset::NO_FLOOR;
+
+    // First floor reaching half the expected calls
+    double below = 0;
+    int lastFloorNum = FloorBitset::NO_FLOOR;
+    for (int floorNum = fromFloorNum; floorNum <= toFloorNum; ++floorNum) {
+        if (!floorNums.test(floorNum)) continue;
+
+        double calls = callsAt(forecast, floorNum);
+        if (calls <= 0) continue;
+        below += calls;
+        lastFloorNum = floorNum;
+        if (2 * below >= total) break;
+    }
+    return lastFloorNum;
+}
+
+long long DemandModel::slotOf(long long timeMs) {
+    long long slot = floorDiv(timeMs, slotMs) % slotCount;
+    return slot < 0 ? slot + slotCount : slot;
+}
+
+long long DemandModel::dayOf(long long timeMs) {
+    return floorDiv(timeMs, dayMs);
+}
+
+DemandModel::Forecast DemandModel::forecastAt(long long timeMs) const {
+    Forecast forecast;
+    for (int s_ind = 0; s_ind < 3; ++s_ind) {
+        long long atMs = timeMs + (s_ind - 1) * slotMs;
+        long long slot = slotOf(atMs);
+        forecast.rows[s_ind] = &counts[slot * floorCount];
+        forecast.weights[s_ind] = slotWeight(slot, dayOf(atMs));
+    }
+    return forecast;
+}
+
+double DemandModel::callsAt(const Forecast &forecast, int floorNum) const {
+    double calls = 0;
+    for (int s_ind = 0; s_ind < 3; ++s_ind)
+        calls += forecast.weights[s_ind] * forecast.rows[s_ind][floorNum - 1];
+    return calls;
+}
+
+double DemandModel::slotWeight(long long slot, long long day) const {
+    // Nothing recorded yet, or only later (a slot before time 0)
+    if (slotDays[slot] < 0 || slotDays[slot] > day) return 0;
+    return std::pow(dayDecay, double(day - slotDays[slot]));
+}
@@ -0,0 +1,96 @@
+#ifndef DEMANDMODEL_H
+#define DEMANDMODEL_H
+
+#include <vector>
+
+// Forward declarations
+class FloorBitset;
+
+/** Learned hall call demand, per floor and time of day.
+ *
+ * Keeps a histogram of hall calls per floor for every slot of the day
+ * (slotMs long, simulated time 0 being midnight), learned online from the
+ * calls as they are made. Each day's calls count dayDecay times less than
+ * the next day's, so the model follows demand as it changes, and forgets a
+ * slot it hasn't seen in a while. Old days are decayed lazily, the first
+ * time a slot is used on a new day.
+ *
+ * The demand expected at a time sums the previous, current and next slot:
+ * the recent past, which is all there is on a first day, and what the same
+ * time looked like on earlier days, including what comes next, so e.g. the
+ * lobby fills up in the estimate just before the usual up-peak.
+ *
+ * Data Members:
+ * + slotMs / dayMs: long long
+ *      Length of a slot and of a day, in simulated milliseconds.
+ * + dayDecay: double
+ *      Weight of a day's calls relative to the next day's.
+ * + floorCount: int
+ *      Number of floors.
+ *
+ * - counts: std::vector<float>
+ *      Decayed calls per slot and floor, slot-major.
+ * - slotDays: std::vector<long long>
+ *      Day each slot's counts were last decayed to, -1 before its first call.
+ *
+ * Class Methods:
+ * + record(long long, int): void
+ *      Records a hall call at a floor at a simulated time.
+ * + expectedCalls(long long, int): double
+ *      Decayed calls expected at a floor around a time, see above.
+ * + medianFloor(long long, int, int, const FloorBitset &): int
+ *      Returns the weighted median of the expected calls over the given
+ *      floor range, counting only the given floors: the floor minimizing the
+ *      expected distance to the next call there. FloorBitset::NO_FLOOR if no
+ *      calls are expected in the range.
+ *
+ * - Forecast: struct
+ *      Rows of counts and their decay weights for the previous, current and
+ *      next slot of a time.
+ * - forecastAt(long long): Forecast
+ * - callsAt(const Forecast &, int): double
+ *      Expected calls at a floor, for a forecast.
+ * - slotOf(long long) / dayOf(long long): long long
+ *      Slot of the day, and day, a time falls in.
+ * - slotWeight(long long, long long): double
+ *      Decay of a slot's counts, for the given day.
+ */
+class DemandModel {
+   public:
+    explicit DemandModel(int floorCount);
+
+    /* Public data members */
+    static const long long slotMs = 15 * 60 * 1000;
+    static const long long dayMs = 24 * 60 * 60 * 1000;
+    static constexpr double dayDecay = 0.5;
+
+    const int floorCount;
+
+    /* Public methods */
+    void record(long long timeMs, int floorNum);
+    double expectedCalls(long long timeMs, int floorNum) const;
+    int medianFloor(long long timeMs, int fromFloorNum, int toFloorNum,
+                    const FloorBitset &floorNums) const;
+
+   private:
+    /* Private data structs */
+    typedef struct Forecast {
+        const float *rows[3];
+        double weights[3];
+    } Forecast;
+
+    /* Private data members */
+    static const long long slotCount = dayMs / slotMs;
+
+    std::vector<float> counts;
+    std::vector<long long> slotDays;
+
+    /* Private methods */
+    Forecast forecastAt(long long timeMs) const;
+    double callsAt(const Forecast &, int floorNum) const;
+    static long long slotOf(long long timeMs);
+    static long long dayOf(long long timeMs);
+    double slotWeight(long long slot, long long day) const;
+};
+
+#endif /* DEMANDMODEL_H */
@@ -0,0 +1,73 @@
+#ifndef DISPATCHPOLICY_H
+#define DISPATCHPOLICY_H
+
+#include "Direction.h"
+#include "FloorBitset.h"
+#include "SimElevator.h"
+
+/** Dispatch policies: which of its queued floors a car heads for next.
+ *
+ * Whatever assigns the hall calls (see SimBuilding::DispatchMode), a car
+ * with floors queued on both sides still has to pick a way to go. A policy
+ * is a class with a static method
+ *
+ *      static int nextStop(const SimElevator &car, int below, int above);
+ *
+ * given the nearest queued floors at or below and at or above the car's
+ * floor, at least one of them existing (not FloorBitset::NO_FLOOR), and
+ * returning the floor to head for. If the car's floor itself is queued,
+ * above is that floor.
+ *
+ * Policies are template parameters rather than virtual classes: SimBuilding
+ * runs each dispatch pass through SimElevator::determineMovement<Policy>(),
+ * with the policy's choice inlined into the movement code, and picks the
+ * pass of the selected policy once per pass rather than once per car.
+ * Policies are selected by name at runtime from SimBuilding's registry, see
+ * SimBuilding::dispatchPolicyNames(). Adding one takes a class here, an
+ * entry at the end of the registry, and an instantiation of
+ * SimElevator::determineMovement<Policy>().
+ *
+ * Class Methods:
+ * + NearestFloorPolicy::nextStop(const SimElevator &, int, int): int
+ *      Reference policy ("nearest-floor"): the closer of the two floors. On
+ *      a tie, the one the car is moving towards, or the lower one if it is
+ *      stopped.
+ * + CollectivePolicy::nextStop(const SimElevator &, int, int): int
+ *      Directional collective ("collective"): keeps going the way the car
+ *      last ran while it has floors queued that way, so no floor waits for
+ *      the calls nearer the car to run out. Otherwise as the reference.
+ */
+struct NearestFloorPolicy {
+    static int nextStop(const SimElevator &car, int below, int above) {
+        // Car is below or above all queued floors.
+        if (below == FloorBitset::NO_FLOOR) return above;
+        if (above == FloorBitset::NO_FLOOR) return below;
+
+        // Current floor itself is queued.
+        if (above == car.currentFloorNum) return above;
+
+        int distBelow = car.currentFloorNum - below;
+        int distAbove = above - car.currentFloorNum;
+        if (distBelow < distAbove) return below;
+        if (distAbove < distBelow) return above;
+
+        // Distance tied
+        return car.getMovement() == SimElevator::MovementState::UPWARDS
+                   ? above
+                   : below;
+    }
+};
+
+struct CollectivePolicy {
+    static int nextStop(const SimElevator &car, int below, int above) {
+        Direction dir = car.getTravelDirection();
+        if (above != FloorBitset::NO_FLOOR &&
+            (above == car.currentFloorNum || dir == Direction::UP))
+            return above;
+        if (below != FloorBitset::NO_FLOOR && dir == Direction::DOWN)
+            return below;
+        return NearestFloorPolicy::nextStop(car, below, above);
+    }
+};
+
+#endif /* DISPATCHPOLICY_H */
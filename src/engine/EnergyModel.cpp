@@ -0,0 +1,64 @@
+#include "EnergyModel.h"
+
+#include "CarConfig.h"
+#include "Direction.h"
+#include "FlightTable.h"
+
+constexpr double EnergyModel::gravity;
+
+EnergyModel::EnergyModel(const CarConfig &config, const FlightTable &flights)
+    : flights(flights),
+      floorHeight(config.floorHeightMm / 1000.0),
+      floorSpeed(double(config.floorHeightMm) / config.movementMs),
+      balanceKg(config.ratedLoadKg * config.counterweightPercent / 100.0),
+      movingKg(2.0 * config.carMassKg +
+               config.ratedLoadKg * config.counterweightPercent / 100.0),
+      drive(config.driveEfficiencyPercent / 100.0),
+      regen(config.regenPercent / 100.0),
+      doorStroke(config.doorPowerW * (config.doorSpeedMs / 1000.0)),
+      standbyPower(config.standbyPowerW) {
+    if (config.carMassKg < 1 || config.driveEfficiencyPercent < 1 ||
+        config.driveEfficiencyPercent > 100)
+        throw "ERROR: Car mass and drive efficiency must be positive";
+    if (config.counterweightPercent < 0 || config.counterweightPercent > 100 ||
+        config.regenPercent < 0 || config.regenPercent > 100)
+        throw "ERROR: Counterweight and regenerated shares must be 0 to 100";
+    if (config.doorPowerW < 0 || config.standbyPowerW < 0)
+        throw "ERROR: Car power draws can't be negative";
+}
+
+EnergyModel::EnergyUse EnergyModel::run(int floors, Direction dir,
+                                        int loadKg) const {
+    EnergyUse use;
+    if (floors <= 0 || dir == Direction::NONE) return use;
+
+    // Gravity works for the heavier side: the car above balance going down,
+    // or the counterweight with the car below balance going up.
+    double lift = (loadKg - balanceKg) * gravity * floors * floorHeight;
+    if (dir == Direction::DOWN) lift = -lift;
+
+    double speed = peakSpeed(floors);
+    double kinetic = (movingKg + loadKg) * speed * speed / 2;
+
+    // The motor accelerates and lifts; braking and overhauling drive it.
+    double motoring = kinetic + (lift > 0 ? lift : 0);
+    double generating = kinetic + (lift < 0 ? -lift : 0);
+    use.tractionJ = motoring / drive;
+    use.regeneratedJ = generating * regen;
+    return use;
+}
+
+double EnergyModel::runNetJ(int floors, Direction dir, int loadKg) const {
+    EnergyUse use = run(floors, dir, loadKg);
+    return use.tractionJ - use.regeneratedJ;
+}
+
+double EnergyModel::doorStrokeJ() const { return doorStroke; }
+
+double EnergyModel::standbyJ(long long elapsedMs) const {
+    return standbyPower * (elapsedMs / 1000.0);
+}
+
+double EnergyModel::peakSpeed(int floors) const {
+    return flights.isKinematic() ? flights.peakSpeedMps(floors) : floorSpeed;
+}
@@ -0,0 +1,123 @@
+#ifndef ENERGYMODEL_H
+#define ENERGYMODEL_H
+
+#include "CarConfig.h"
+#include "Direction.h"
+
+// Forward declarations
+class FlightTable;
+
+/** Energy a car draws from and feeds back to the building's supply.
+ *
+ * Traction follows the physics of a counterweighted car. The counterweight
+ * balances the car and counterweightPercent of its rated load, so a car
+ * lifting more than that, or lowering less, works against gravity, and the
+ * opposite run is overhauled by the heavier side: a loaded car going down
+ * or an empty one going up. Every run also accelerates the moving masses
+ * (car, counterweight and load) to the run's top speed, which is a
+ * kinematic car's peak speed from its FlightTable, or one floor per
+ * movementMs otherwise, and brakes them again.
+ *
+ * Work the motor does (lifting, accelerating) is drawn through the drive at
+ * driveEfficiencyPercent. Work done on the motor (overhauling, braking) is
+ * fed back at regenPercent, or burnt in a braking resistor when that is 0.
+ * Doors draw doorPowerW while moving, and the car's controller, lighting and
+ * ventilation draw standbyPowerW all the time.
+ *
+ * Data Members:
+ * + EnergyUse: struct
+ *      Energy in joules, by use.
+ *      - tractionJ: drawn by the drive for runs.
+ *      - regeneratedJ: fed back by the drive.
+ *      - doorJ: drawn by the door operator.
+ *      - standbyJ: drawn standing by.
+ *      - drawnJ(): everything drawn.
+ *      - netJ() / netKWh(): drawn less regenerated.
+ * + gravity: double
+ *      Standard gravity, in m/s^2.
+ *
+ * - flights: const FlightTable &
+ *      Flight times of the car's motion profile, for its peak speeds.
+ * - floorHeight: double
+ *      Height between floors, in metres.
+ * - floorSpeed: double
+ *      Speed of a car without a motion profile, in m/s.
+ * - balanceKg / movingKg: double
+ *      Load the counterweight balances, and the moving masses other than the
+ *      load.
+ * - drive / regen: double
+ *      Drive efficiency and regenerated share, as fractions.
+ * - doorStroke: double
+ *      Energy of opening or closing the doors once.
+ * - standbyPower: double
+ *      Standby draw, in watts.
+ *
+ * Class Methods:
+ * + run(int, Direction, int): EnergyUse
+ *      Traction energy of a run over the given number of floors in a
+ *      direction, with the given load aboard.
+ * + runNetJ(int, Direction, int): double
+ *      Net energy of such a run, negative if it feeds back more than it
+ *      draws.
+ * + doorStrokeJ(): double
+ *      Energy of one door opening or closing.
+ * + standbyJ(long long): double
+ *      Standby energy over the given time, in milliseconds.
+ *
+ * - peakSpeed(int): double
+ *      Top speed of a run over the given number of floors, in m/s.
+ */
+class EnergyModel {
+   public:
+    /* Public data structs */
+    typedef struct EnergyUse {
+        double tractionJ;
+        double regeneratedJ;
+        double doorJ;
+        double standbyJ;
+
+        EnergyUse()
+            : tractionJ(0), regeneratedJ(0), doorJ(0), standbyJ(0) {}
+
+        double drawnJ() const { return tractionJ + doorJ + standbyJ; }
+        double netJ() const { return drawnJ() - regeneratedJ; }
+        double netKWh() const { return netJ() / 3.6e6; }
+
+        EnergyUse &operator+=(const EnergyUse &other) {
+            tractionJ += other.tractionJ;
+            regeneratedJ += other.regeneratedJ;
+            doorJ += other.doorJ;
+            standbyJ += other.standbyJ;
+            return *this;
+        }
+    } EnergyUse;
+
+    EnergyModel(const CarConfig &, const FlightTable &);
+
+    /* Public data members */
+    static constexpr double gravity = 9.80665;
+
+    /* Public methods */
+    EnergyUse run(int floors, Direction, int loadKg) const;
+    double runNetJ(int floors, Direction, int loadKg) const;
+    double doorStrokeJ() const;
+    double standbyJ(long long elapsedMs) const;
+
+   private:
+    /* Private data members */
+    const FlightTable &flights;
+
+    const double floorHeight;
+    const double floorSpeed;
+    const double balanceKg;
+    const double movingKg;
+    const double drive;
+    const double regen;
+    const double doorStroke;
+    const double standbyPower;
+
+    /* Private methods */
+    double peakSpeed(int floors) const;
+};
+
+#endif /* ENERGYMODEL_H */
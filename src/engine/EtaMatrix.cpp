@@ -0,0 +1,372 @@
+#include "EtaMatrix.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "FleetState.h"
+#include "FlightTable.h"
+#include "FloorBitset.h"
+#include "SimBuilding.h"
+#include "SimElevator.h"
+
+// SIMD kernels need GCC/Clang target attributes and CPU detection.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ETA_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/* Per-car constants of a row.
+ *
+ * A call is "away" when the car is moving and the call is behind it: the
+ * car first runs to its turn floor. For a call at floor f, with lo/hi the
+ * lower/higher of f and the car's floor, and the car's end replaced by the
+ * turn floor for away calls:
+ *      travel = hi - lo (+ turnFloors if away)
+ *      stops  = committed stops strictly between lo and hi
+ *               (+ turnStops if away)
+ *      eta    = doorMs + travel * movementMs
+ *               + stops * (doorSpeed2Ms + doorWaitMs)
+ * which is the estimate of SimBuilding::estimateArrivalMs(). */
+typedef struct Row {
+    int pos;
+    int away;        // +1: calls below are away, -1: calls above, 0: none
+    int turn;        // Floor an away call turns around at
+    int turnFloors;  // Floors from the car to the turn
+    int turnStops;   // Stops from the car to the turn, turn included
+    long long doorMs;
+    int movementMs;
+    unsigned doorSpeed2Ms;  // Both door transitions
+    int doorWaitMs;
+    const int *stops;  // Committed stops, a floor in both sets twice
+    int stopCount;
+} Row;
+
+void etaRowScalar(const Row &row, const int *calls, int begin, int end,
+                  long long *out) {
+    for (int c_ind = begin; c_ind < end; ++c_ind) {
+        int floorNum = calls[c_ind];
+        int lo = std::min(floorNum, row.pos);
+        int hi = std::max(floorNum, row.pos);
+
+        bool away = (row.away > 0 && floorNum < row.pos) ||
+                    (row.away < 0 && floorNum > row.pos);
+        if (away && row.away > 0) hi = row.turn;
+        if (away && row.away < 0) lo = row.turn;
+
+        int stops = away ? row.turnStops : 0;
+        for (int s_ind = 0; s_ind < row.stopCount; ++s_ind)
+            stops += row.stops[s_ind] > lo && row.stops[s_ind] < hi;
+        int travel = hi - lo + (away ? row.turnFloors : 0);
+
+        out[c_ind] = row.doorMs + travel * (long long)row.movementMs +
+                     stops * (long long)row.doorSpeed2Ms +
+                     stops * (long long)row.doorWaitMs;
+    }
+}
+
+#ifdef ETA_SIMD_X86
+
+// Lanes of a where mask is set, of b elsewhere.
+__attribute__((target("sse2"))) inline __m128i select128(__m128i mask,
+                                                          __m128i a,
+                                                          __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+__attribute__((target("sse2"))) void etaRowSse2(const Row &row,
+                                                const int *calls, int count,
+                                                long long *out) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i pos = _mm_set1_epi32(row.pos);
+    const __m128i turn = _mm_set1_epi32(row.turn);
+    const __m128i turnFloors = _mm_set1_epi32(row.turnFloors);
+    const __m128i turnStops = _mm_set1_epi32(row.turnStops);
+    const __m128i doorMs = _mm_set1_epi64x(row.doorMs);
+    const __m128i movementMs = _mm_set1_epi32(row.movementMs);
+    const __m128i doorSpeed2Ms = _mm_set1_epi32(int(row.doorSpeed2Ms));
+    const __m128i doorWaitMs = _mm_set1_epi32(row.doorWaitMs);
+
+    int c_ind = 0;
+    for (; c_ind + 4 <= count; c_ind += 4) {
+        __m128i floorNum =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(calls + c_ind));
+        __m128i above = _mm_cmpgt_epi32(floorNum, pos);
+        __m128i lo = select128(above, pos, floorNum);
+        __m128i hi = select128(above, floorNum, pos);
+
+        __m128i away = zero;
+        if (row.away > 0) {
+            away = _mm_cmpgt_epi32(pos, floorNum);
+            hi = select128(away, turn, hi);
+        } else if (row.away < 0) {
+            away = above;
+            lo = select128(away, turn, lo);
+        }
+
+        // Masks are -1 where true, so subtracting counts.
+        __m128i stops = _mm_and_si128(away, turnStops);
+        for (int s_ind = 0; s_ind < row.stopCount; ++s_ind) {
+            __m128i stop = _mm_set1_epi32(row.stops[s_ind]);
+            stops = _mm_sub_epi32(stops,
+                                  _mm_and_si128(_mm_cmpgt_epi32(stop, lo),
+                                                _mm_cmpgt_epi32(hi, stop)));
+        }
+        __m128i travel = _mm_add_epi32(_mm_sub_epi32(hi, lo),
+                                       _mm_and_si128(away, turnFloors));
+
+        // Widen to 64 bits; every factor fits 32 bits unsigned.
+        for (int h_ind = 0; h_ind < 2; ++h_ind) {
+            __m128i travel64 = h_ind ? _mm_unpackhi_epi32(travel, zero)
+                                     : _mm_unpacklo_epi32(travel, zero);
+            __m128i stops64 = h_ind ? _mm_unpackhi_epi32(stops, zero)
+                                    : _mm_unpacklo_epi32(stops, zero);
+
+            __m128i eta = _mm_add_epi64(doorMs,
+                                        _mm_mul_epu32(travel64, movementMs));
+            eta = _mm_add_epi64(eta, _mm_mul_epu32(stops64, doorSpeed2Ms));
+            eta = _mm_add_epi64(eta, _mm_mul_epu32(stops64, doorWaitMs));
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i *>(out + c_ind + 2 * h_ind), eta);
+        }
+    }
+
+    etaRowScalar(row, calls, c_ind, count, out);
+}
+
+__attribute__((target("avx2"))) void etaRowAvx2(const Row &row,
+                                                const int *calls, int count,
+                                                long long *out) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i pos = _mm256_set1_epi32(row.pos);
+    const __m256i turn = _mm256_set1_epi32(row.turn);
+    const __m256i turnFloors = _mm256_set1_epi32(row.turnFloors);
+    const __m256i turnStops = _mm256_set1_epi32(row.turnStops);
+    const __m256i doorMs = _mm256_set1_epi64x(row.doorMs);
+    const __m256i movementMs = _mm256_set1_epi32(row.movementMs);
+    const __m256i doorSpeed2Ms = _mm256_set1_epi32(int(row.doorSpeed2Ms));
+    const __m256i doorWaitMs = _mm256_set1_epi32(row.doorWaitMs);
+
+    int c_ind = 0;
+    for (; c_ind + 8 <= count; c_ind += 8) {
+        __m256i floorNum = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(calls + c_ind));
+        __m256i lo = _mm256_min_epi32(floorNum, pos);
+        __m256i hi = _mm256_max_epi32(floorNum, pos);
+
+        __m256i away = zero;
+        if (row.away > 0) {
+            away = _mm256_cmpgt_epi32(pos, floorNum);
+            hi = _mm256_blendv_epi8(hi, turn, away);
+        } else if (row.away < 0) {
+            away = _mm256_cmpgt_epi32(floorNum, pos);
+            lo = _mm256_blendv_epi8(lo, turn, away);
+        }
+
+        // Masks are -1 where true, so subtracting counts.
+        __m256i stops = _mm256_and_si256(away, turnStops);
+        for (int s_ind = 0; s_ind < row.stopCount; ++s_ind) {
+            __m256i stop = _mm256_set1_epi32(row.stops[s_ind]);
+            stops = _mm256_sub_epi32(
+                stops, _mm256_and_si256(_mm256_cmpgt_epi32(stop, lo),
+                                        _mm256_cmpgt_epi32(hi, stop)));
+        }
+        __m256i travel = _mm256_add_epi32(_mm256_sub_epi32(hi, lo),
+                                          _mm256_and_si256(away, turnFloors));
+
+        // Widen to 64 bits; every factor fits 32 bits unsigned.
+        for (int h_ind = 0; h_ind < 2; ++h_ind) {
+            __m256i travel64 = _mm256_cvtepu32_epi64(
+                h_ind ? _mm256_extracti128_si256(travel, 1)
+                      : _mm256_castsi256_si128(travel));
+            __m256i stops64 = _mm256_cvtepu32_epi64(
+                h_ind ? _mm256_extracti128_si256(stops, 1)
+                      : _mm256_castsi256_si128(stops));
+
+            __m256i eta = _mm256_add_epi64(
+                doorMs, _mm256_mul_epu32(travel64, movementMs));
+            eta = _mm256_add_epi64(eta,
+                                   _mm256_mul_epu32(stops64, doorSpeed2Ms));
+            eta = _mm256_add_epi64(eta, _mm256_mul_epu32(stops64, doorWaitMs));
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i *>(out + c_ind + 4 * h_ind), eta);
+        }
+    }
+
+    etaRowScalar(row, calls, c_ind, count, out);
+}
+
+#endif /* ETA_SIMD_X86 */
+
+// Appends every floor of a set to a list of stops.
+void appendFloors(const FloorBitset &floors, std::vector<int> &list) {
+    for (int floorNum = floors.first(); floorNum != FloorBitset::NO_FLOOR;
+         floorNum = floors.nextAtOrAbove(floorNum + 1))
+        list.push_back(floorNum);
+}
+
+}  // namespace
+
+EtaMatrix::EtaMatrix() : rowCount(0), colCount(0) {}
+
+EtaMatrix::Kernel EtaMatrix::bestKernel() {
+    if (kernelSupported(Kernel::AVX2)) return Kernel::AVX2;
+    if (kernelSupported(Kernel::SSE2)) return Kernel::SSE2;
+    return Kernel::SCALAR;
+}
+
+bool EtaMatrix::kernelSupported(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::SCALAR:
+            return true;
+#ifdef ETA_SIMD_X86
+        case Kernel::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case Kernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+const char *EtaMatrix::kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::SCALAR:
+            return "scalar";
+        case Kernel::SSE2:
+            return "sse2";
+        case Kernel::AVX2:
+            return "avx2";
+        default:
+            throw "ERROR: Invalid ETA kernel enum";
+    }
+}
+
+void EtaMatrix::compute(const SimBuilding &building,
+                        const std::vector<int> &callFloorNums, Kernel kernel) {
+    if (!kernelSupported(kernel))
+        throw "ERROR: ETA kernel isn't supported on this CPU";
+    for (int floorNum : callFloorNums)
+        if (!building.isFloorNum(floorNum))
+            throw "ERROR: ETA call floor number doesn't exist";
+
+    const FleetState &fleet = building.getFleet();
+    rowCount = fleet.size();
+    colCount = int(callFloorNums.size());
+    etas.resize(size_t(rowCount) * colCount);
+    if (colCount == 0) return;
+
+    for (int e_ind = 0; e_ind < rowCount; ++e_ind) {
+        long long *out = etas.data() + size_t(e_ind) * colCount;
+
+        // Flight times of kinematic cars aren't linear in the floors.
+        if (fleet.getFlights()[e_ind]->isKinematic()) {
+            const SimElevator &car = building.getElevator_byCarId(e_ind + 1);
+            for (int c_ind = 0; c_ind < colCount; ++c_ind)
+                out[c_ind] =
+                    building.estimateArrivalMs(car, callFloorNums[c_ind]);
+            continue;
+        }
+
+        const FloorBitset &carCalls = *fleet.getCarCalls()[e_ind];
+        const FloorBitset &stops = building.getAssignedStops(e_ind + 1);
+
+        stopScratch.clear();
+        appendFloors(carCalls, stopScratch);
+        appendFloors(stops, stopScratch);
+
+        Row row;
+        row.pos = fleet.getFloorNums()[e_ind];
+        row.movementMs = fleet.getMovementMs()[e_ind];
+        row.doorSpeed2Ms = 2u * unsigned(fleet.getDoorSpeedMs()[e_ind]);
+        row.doorWaitMs = fleet.getDoorWaitMs()[e_ind];
+        row.stops = stopScratch.data();
+        row.stopCount = int(stopScratch.size());
+
+        // Doors must finish their current cycle before the car can leave.
+        int doorSpeedMs = fleet.getDoorSpeedMs()[e_ind];
+        switch (fleet.getDoors()[e_ind]) {
+            case SimElevator::DoorState::OPENING:
+                row.doorMs = 2LL * doorSpeedMs + row.doorWaitMs;
+                break;
+            case SimElevator::DoorState::OPEN:
+                row.doorMs = (long long)row.doorWaitMs + doorSpeedMs;
+                break;
+            case SimElevator::DoorState::CLOSING:
+                row.doorMs = doorSpeedMs;
+                break;
+            case SimElevator::DoorState::CLOSED:
+            default:
+                row.doorMs = 0;
+                break;
+        }
+
+        // Turn floor of away calls, as in estimateArrivalMs().
+        row.away = 0;
+        row.turn = row.pos;
+        switch (fleet.getMovements()[e_ind]) {
+            case SimElevator::MovementState::UPWARDS:
+                row.away = 1;
+                row.turn = std::max(carCalls.last(), stops.last());
+                row.turn = std::min(std::max(row.turn, row.pos + 1),
+                                    building.floorCount);
+                break;
+            case SimElevator::MovementState::DOWNWARDS: {
+                row.away = -1;
+                int lowest = carCalls.first();
+                if (lowest == FloorBitset::NO_FLOOR ||
+                    (stops.first() != FloorBitset::NO_FLOOR &&
+                     stops.first() < lowest))
+                    lowest = stops.first();
+                row.turn = (lowest == FloorBitset::NO_FLOOR)
+                               ? row.pos - 1
+                               : std::min(lowest, row.pos - 1);
+                row.turn = std::max(row.turn, 1);
+                break;
+            }
+            case SimElevator::MovementState::STOPPED:
+            default:
+                break;
+        }
+
+        int low = std::min(row.pos, row.turn) + 1;
+        int high = std::max(row.pos, row.turn) - 1;
+        row.turnFloors = std::abs(row.turn - row.pos);
+        row.turnStops =
+            (carCalls.test(row.turn) || stops.test(row.turn)) ? 1 : 0;
+        if (low <= high)
+            row.turnStops += carCalls.countBetween(low, high) +
+                             stops.countBetween(low, high);
+
+        const int *calls = callFloorNums.data();
+        switch (kernel) {
+#ifdef ETA_SIMD_X86
+            case Kernel::AVX2:
+                etaRowAvx2(row, calls, colCount, out);
+                break;
+            case Kernel::SSE2:
+                etaRowSse2(row, calls, colCount, out);
+                break;
+#endif
+            case Kernel::SCALAR:
+            default:
+                etaRowScalar(row, calls, 0, colCount, out);
+                break;
+        }
+    }
+}
+
+int EtaMatrix::rows() const { return rowCount; }
+int EtaMatrix::cols() const { return colCount; }
+
+long long EtaMatrix::at(int carIndex, int callIndex) const {
+    if (carIndex < 0 || carIndex >= rowCount || callIndex < 0 ||
+        callIndex >= colCount)
+        throw "ERROR: ETA matrix index out of range";
+    return etas[size_t(carIndex) * colCount + callIndex];
+}
+
+const std::vector<long long> &EtaMatrix::values() const { return etas; }
@@ -0,0 +1,89 @@
+#ifndef ETAMATRIX_H
+#define ETAMATRIX_H
+
+#include <vector>
+
+// Forward declarations
+class SimBuilding;
+
+/** Estimated arrival times of every car to every floor in a batch of calls.
+ *
+ * Computes the cars x calls matrix of SimBuilding::estimateArrivalMs() in
+ * one pass, for dispatch policies that compare whole assignments rather than
+ * placing one call at a time. Car state is read from the building's
+ * FleetState, and each car's committed stops (destination calls and
+ * assigned hall calls) are gathered once per row.
+ *
+ * Rows are computed by one of several kernels, vectorized over the calls:
+ * SCALAR (portable), SSE2 (4 calls per step) and AVX2 (8 calls per step).
+ * The SIMD kernels are compiled with per-function target attributes and
+ * chosen at runtime from what the CPU supports, so the binary still runs on
+ * CPUs without them. Every kernel uses exact integer arithmetic and produces
+ * values bit-identical to estimateArrivalMs(). Rows of kinematic cars, whose
+ * flight times aren't linear in the floors travelled, are filled from
+ * estimateArrivalMs() itself.
+ *
+ * The group dispatcher doesn't use the matrix: it assigns calls one at a
+ * time, and each assignment changes the chosen car's estimates for the
+ * calls after it.
+ *
+ * Data Members:
+ * + Kernel: enum
+ *      Implementation computing the rows.
+ *
+ * - rowCount / colCount: int
+ *      Number of cars / calls of the last computation.
+ * - etas: std::vector<long long>
+ *      Estimates in milliseconds, row-major, one row per car (by index).
+ * - stopScratch: std::vector<int>
+ *      Committed stops of the row being computed, reused between rows.
+ *
+ * Class Methods:
+ * + bestKernel(): Kernel
+ *      Returns the fastest kernel the CPU supports.
+ * + kernelSupported(Kernel): bool
+ *      Returns true if the kernel can run on this CPU.
+ * + kernelName(Kernel): const char *
+ *      Returns a short lowercase name of the kernel.
+ *
+ * + compute(const SimBuilding &, const std::vector<int> &, Kernel): void
+ *      Computes the estimate of every car to every call floor. Throws if a
+ *      floor doesn't exist or the kernel isn't supported.
+ *
+ * + rows(): int
+ * + cols(): int
+ * + at(int, int): long long
+ *      Size of the matrix, and the estimate of a car (by index) to a call
+ *      (by index in the floors given).
+ * + values(): const std::vector<long long> &
+ *      Every estimate, row-major.
+ */
+class EtaMatrix {
+   public:
+    /* Public enums */
+    enum class Kernel { SCALAR, SSE2, AVX2 };
+
+    EtaMatrix();
+
+    /* Public methods */
+    static Kernel bestKernel();
+    static bool kernelSupported(Kernel);
+    static const char *kernelName(Kernel);
+
+    void compute(const SimBuilding &, const std::vector<int> &callFloorNums,
+                 Kernel = bestKernel());
+
+    int rows() const;
+    int cols() const;
+    long long at(int carIndex, int callIndex) const;
+    const std::vector<long long> &values() const;
+
+   private:
+    /* Private data members */
+    int rowCount;
+    int colCount;
+    std::vector<long long> etas;
+    std::vector<int> stopScratch;
+};
+
+#endif /* ETAMATRIX_H */
@@ -0,0 +1,78 @@
+#include "FleetState.h"
+
+#include <vector>
+
+#include "FlightTable.h"
+#include "FloorBitset.h"
+#include "SimElevator.h"
+
+FleetState::FleetState(int elevatorCount)
+    : floorNums(elevatorCount, 0),
+      movements(elevatorCount, SimElevator::MovementState::STOPPED),
+      doors(elevatorCount, SimElevator::DoorState::CLOSED),
+      emergencies(elevatorCount, SimElevator::EmergencyState::NONE),
+      doorCloseFailures(elevatorCount, 0),
+      full(elevatorCount, 0),
+      movementMs(elevatorCount, 0),
+      doorSpeedMs(elevatorCount, 0),
+      doorWaitMs(elevatorCount, 0),
+      flights(elevatorCount, nullptr),
+      carCalls(elevatorCount, nullptr) {}
+
+int FleetState::size() const { return int(floorNums.size()); }
+
+void FleetState::update(const SimElevator &car) {
+    int e_ind = car.carId - 1;
+    if (e_ind < 0 || e_ind >= size())
+        throw "ERROR: Car doesn't belong to the fleet";
+
+    floorNums[e_ind] = car.currentFloorNum;
+    movements[e_ind] = car.getMovement();
+    doors[e_ind] = car.getDoorState();
+    emergencies[e_ind] = car.getEmergency();
+    doorCloseFailures[e_ind] = car.getDoorCloseFailures();
+    full[e_ind] = car.isFull();
+
+    movementMs[e_ind] = car.config.movementMs;
+    doorSpeedMs[e_ind] = car.config.doorSpeedMs;
+    doorWaitMs[e_ind] = car.config.doorWaitMs;
+    flights[e_ind] = &car.flights;
+    carCalls[e_ind] = &car.getCarCalls();
+}
+
+bool FleetState::canServeHallCalls(int carIndex) const {
+    // Help requests don't stop the car, any other emergency does. Full cars
+    // bypass hall calls.
+    return (emergencies[carIndex] == SimElevator::EmergencyState::NONE ||
+            emergencies[carIndex] == SimElevator::EmergencyState::HELP) &&
+           !full[carIndex];
+}
+
+const std::vector<int> &FleetState::getFloorNums() const { return floorNums; }
+const std::vector<SimElevator::MovementState> &FleetState::getMovements()
+    const {
+    return movements;
+}
+const std::vector<SimElevator::DoorState> &FleetState::getDoors() const {
+    return doors;
+}
+const std::vector<SimElevator::EmergencyState> &FleetState::getEmergencies()
+    const {
+    return emergencies;
+}
+const std::vector<int> &FleetState::getDoorCloseFailures() const {
+    return doorCloseFailures;
+}
+const std::vector<char> &FleetState::getFull() const { return full; }
+
+const std::vector<int> &FleetState::getMovementMs() const { return movementMs; }
+const std::vector<int> &FleetState::getDoorSpeedMs() const {
+    return doorSpeedMs;
+}
+const std::vector<int> &FleetState::getDoorWaitMs() const { return doorWaitMs; }
+const std::vector<const FlightTable *> &FleetState::getFlights() const {
+    return flights;
+}
+const std::vector<const FloorBitset *> &FleetState::getCarCalls() const {
+    return carCalls;
+}
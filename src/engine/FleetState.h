@@ -0,0 +1,87 @@
+#ifndef FLEETSTATE_H
+#define FLEETSTATE_H
+
+#include <vector>
+
+#include "FlightTable.h"
+#include "FloorBitset.h"
+#include "SimElevator.h"
+
+/** Structure-of-arrays copy of every car's dispatch-relevant state.
+ *
+ * Each SimElevator keeps its own state, but a dispatcher comparing every car
+ * against every hall call would chase one pointer per car and pull whole
+ * car objects into the cache for a handful of fields. The fleet state keeps
+ * each field in its own contiguous array, indexed by car ID - 1, so a
+ * dispatch round scans only the fields it reads, linearly.
+ *
+ * The parent SimBuilding refreshes a car's row whenever the car reports a
+ * change, before any dispatch pass can run, so the arrays always match the
+ * cars during a pass.
+ *
+ * Data Members:
+ * - floorNums: std::vector<int>
+ * - movements: std::vector<SimElevator::MovementState>
+ * - doors: std::vector<SimElevator::DoorState>
+ * - emergencies: std::vector<SimElevator::EmergencyState>
+ * - doorCloseFailures: std::vector<int>
+ * - full: std::vector<char>
+ *      Current state of each car.
+ *
+ * - movementMs / doorSpeedMs / doorWaitMs: std::vector<int>
+ *      Timings of each car, from its CarConfig.
+ * - flights: std::vector<const FlightTable *>
+ *      Flight times of each car, owned by the building.
+ * - carCalls: std::vector<const FloorBitset *>
+ *      Destination panel calls of each car, owned by the car.
+ *
+ * Class Methods:
+ * + size(): int
+ *      Returns the number of cars.
+ * + update(const SimElevator &): void
+ *      Copies a car's state into its row.
+ * + canServeHallCalls(int): bool
+ *      Returns true if the car (by index) is in a state to be assigned hall
+ *      calls, as SimBuilding::canServeHallCalls() does for a car object.
+ *
+ * + Getters for each array.
+ */
+class FleetState {
+   public:
+    explicit FleetState(int elevatorCount);
+
+    /* Public methods */
+    int size() const;
+    void update(const SimElevator &);
+    bool canServeHallCalls(int carIndex) const;
+
+    const std::vector<int> &getFloorNums() const;
+    const std::vector<SimElevator::MovementState> &getMovements() const;
+    const std::vector<SimElevator::DoorState> &getDoors() const;
+    const std::vector<SimElevator::EmergencyState> &getEmergencies() const;
+    const std::vector<int> &getDoorCloseFailures() const;
+    const std::vector<char> &getFull() const;
+
+    const std::vector<int> &getMovementMs() const;
+    const std::vector<int> &getDoorSpeedMs() const;
+    const std::vector<int> &getDoorWaitMs() const;
+    const std::vector<const FlightTable *> &getFlights() const;
+    const std::vector<const FloorBitset *> &getCarCalls() const;
+
+   private:
+    /* Private data members */
+    std::vector<int> floorNums;
+    std::vector<SimElevator::MovementState> movements;
+    std::vector<SimElevator::DoorState> doors;
+    std::vector<SimElevator::EmergencyState> emergencies;
+    std::vector<int> doorCloseFailures;
+    std::vector<char> full;
+
+    std::vector<int> movementMs;
+    std::vector<int> doorSpeedMs;
+    std::vector<int> doorWaitMs;
+    std::vector<const FlightTable *> flights;
+    std::vector<const FloorBitset *> carCalls;
+};
+
+#endif /* FLEETSTATE_H */
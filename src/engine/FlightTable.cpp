@@ -0,0 +1,147 @@
+#include "FlightTable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "CarConfig.h"
+
+FlightTable::FlightTable(const CarConfig &config, int floorCount)
+    : kinematic(config.maxSpeedMmps > 0),
+      movementMs(config.movementMs),
+      floorHeightMm(config.floorHeightMm),
+      maxSpeedMmps(config.maxSpeedMmps),
+      accelMmps2(config.accelMmps2),
+      jerkMmps3(config.jerkMmps3),
+      floorHeight(config.floorHeightMm / 1000.0),
+      maxSpeed(config.maxSpeedMmps / 1000.0),
+      accel(config.accelMmps2 / 1000.0),
+      jerk(config.jerkMmps3 / 1000.0) {
+    if (floorCount < 1) throw "ERROR: Building needs at least one floor";
+    if (!kinematic) return;
+
+    if (floorHeightMm < 1 || accelMmps2 < 1 || jerkMmps3 < 1)
+        throw "ERROR: Motion profile settings must be positive";
+
+    flightMsTable.assign(floorCount, 0);
+    peakSpeeds.assign(floorCount, 0.0);
+    for (int floors = 1; floors < floorCount; ++floors) {
+        double distance = floors * floorHeight;
+        double peak = peakSpeed(distance);
+        double cruise = (distance - 2 * accelDistance(peak)) / peak;
+        double seconds = 2 * accelTime(peak) + cruise;
+
+        peakSpeeds[floors] = peak;
+        flightMsTable[floors] = int(std::ceil(seconds * 1000 - 1e-6));
+    }
+}
+
+bool FlightTable::matches(const CarConfig &config) const {
+    if (kinematic != (config.maxSpeedMmps > 0)) return false;
+    if (!kinematic) return movementMs == config.movementMs;
+
+    return floorHeightMm == config.floorHeightMm &&
+           maxSpeedMmps == config.maxSpeedMmps &&
+           accelMmps2 == config.accelMmps2 && jerkMmps3 == config.jerkMmps3;
+}
+
+bool FlightTable::isKinematic() const { return kinematic; }
+
+long long FlightTable::flightMs(int floors) const {
+    if (!kinematic) return floors * (long long)movementMs;
+
+    if (floors < 0 || floors >= int(flightMsTable.size()))
+        throw "ERROR: Run is longer than the building";
+    return flightMsTable[floors];
+}
+
+double FlightTable::peakSpeedMps(int floors) const {
+    if (!kinematic) throw "ERROR: Car has no motion profile";
+    if (floors < 1 || floors >= int(flightMsTable.size()))
+        throw "ERROR: Run is longer than the building";
+    return peakSpeeds[floors];
+}
+
+int FlightTable::floorsPassed(int floors, long long elapsedMs) const {
+    if (!kinematic) throw "ERROR: Car has no motion profile";
+    if (floors < 1 || floors >= int(flightMsTable.size()))
+        throw "ERROR: Run is longer than the building";
+
+    // Rounding must not count a floor the car is exactly level with twice.
+    double distance = runDistanceAt(floors, elapsedMs / 1000.0);
+    int passed = int(std::floor(distance / floorHeight + 1e-9));
+    return std::max(0, std::min(passed, floors - 1));
+}
+
+double FlightTable::peakSpeed(double distance) const {
+    if (2 * accelDistance(maxSpeed) <= distance) return maxSpeed;
+
+    // Too short to reach full speed: the top speed whose acceleration and
+    // braking cover the distance exactly. Distance grows with the speed.
+    double low = 0, high = maxSpeed;
+    for (int i_ind = 0; i_ind < 64; ++i_ind) {
+        double mid = (low + high) / 2;
+        if (2 * accelDistance(mid) < distance)
+            low = mid;
+        else
+            high = mid;
+    }
+    return high;
+}
+
+double FlightTable::accelTime(double speed) const {
+    // Full acceleration is reached only if the speed allows the ramps.
+    if (speed * jerk >= accel * accel) return speed / accel + accel / jerk;
+    return 2 * std::sqrt(speed / jerk);
+}
+
+double FlightTable::accelDistance(double speed) const {
+    // The ramps are symmetric, so the mean speed is half the final one.
+    return speed * accelTime(speed) / 2;
+}
+
+double FlightTable::accelDistanceAt(double speed, double time) const {
+    double rampTime, peakAccel;
+    if (speed * jerk >= accel * accel) {
+        rampTime = accel / jerk;
+        peakAccel = accel;
+    } else {
+        rampTime = std::sqrt(speed / jerk);
+        peakAccel = jerk * rampTime;
+    }
+    double holdTime = accelTime(speed) - 2 * rampTime;
+
+    // Ramp up to peak acceleration
+    if (time <= rampTime) return jerk * time * time * time / 6;
+    double distance = jerk * rampTime * rampTime * rampTime / 6;
+    double velocity = jerk * rampTime * rampTime / 2;
+    time -= rampTime;
+
+    // Hold peak acceleration
+    if (time <= holdTime)
+        return distance + velocity * time + peakAccel * time * time / 2;
+    distance += velocity * holdTime + peakAccel * holdTime * holdTime / 2;
+    velocity += peakAccel * holdTime;
+    time -= holdTime;
+
+    // Ramp down to cruising
+    time = std::min(time, rampTime);
+    return distance + velocity * time + peakAccel * time * time / 2 -
+           jerk * time * time * time / 6;
+}
+
+double FlightTable::runDistanceAt(int floors, double time) const {
+    double distance = floors * floorHeight;
+    double peak = peakSpeeds[floors];
+    double accelSeconds = accelTime(peak);
+    double total = flightMsTable[floors] / 1000.0;
+
+    if (time <= 0) return 0;
+    if (time >= total) return distance;
+
+    // Braking mirrors acceleration.
+    if (time <= accelSeconds) return accelDistanceAt(peak, time);
+    if (time < total - accelSeconds)
+        return accelDistance(peak) + peak * (time - accelSeconds);
+    return distance - accelDistanceAt(peak, total - time);
+}
@@ -0,0 +1,97 @@
+#ifndef FLIGHTTABLE_H
+#define FLIGHTTABLE_H
+
+#include <vector>
+
+#include "CarConfig.h"
+
+/** Floor-to-floor flight times of a car's motion profile.
+ *
+ * A kinematic car (CarConfig::maxSpeedMmps above 0) runs from stop to stop
+ * on a jerk-limited "S-curve": its acceleration ramps up at the jerk limit to
+ * at most accelMmps2, it cruises at at most maxSpeedMmps, and braking mirrors
+ * the start. Long runs reach full speed and short ones don't, so an express
+ * run over 30 floors takes a fraction of the time of 30 one-floor hops.
+ *
+ * The flight time of every run length in the building is computed once, so
+ * scheduling a run and estimating an arrival are table lookups. Cars with the
+ * same profile share one table, see SimBuilding::flightTableFor(). Cars
+ * without a motion profile take movementMs per floor and need no table.
+ *
+ * Data Members:
+ * - kinematic: bool
+ *      Whether the table is for a motion profile, or for movementMs per floor.
+ * - movementMs: int
+ *      Time per floor of a car without a motion profile.
+ * - floorHeightMm / maxSpeedMmps / accelMmps2 / jerkMmps3: int
+ *      The motion profile, as configured.
+ * - floorHeight / maxSpeed / accel / jerk: double
+ *      The motion profile in metres and seconds.
+ * - flightMsTable / peakSpeeds: std::vector<int> / std::vector<double>
+ *      Flight time in milliseconds, rounded up, and top speed of a run over
+ *      n floors, indexed by n. Empty without a motion profile.
+ *
+ * Class Methods:
+ * + matches(const CarConfig &): bool
+ *      Returns true if a car with the config moves as this table describes.
+ * + isKinematic(): bool
+ *      Returns true if the table is for a motion profile.
+ * + flightMs(int): long long
+ *      Returns the time of a run over the given number of floors, from rest
+ *      to rest. Throws for runs longer than the building.
+ * + peakSpeedMps(int): double
+ *      Returns the top speed of a kinematic run over the given number of
+ *      floors, in m/s. Throws like floorsPassed().
+ * + floorsPassed(int, long long): int
+ *      Returns how many floors a kinematic car has fully passed after the
+ *      given time into a run over the given number of floors. A car counts
+ *      as arrived only once its run ends, so at most floors - 1.
+ *
+ * - peakSpeed(double): double
+ *      Top speed of a run over the given distance.
+ * - accelTime(double) / accelDistance(double): double
+ *      Time taken and distance covered to accelerate from rest to a speed.
+ * - accelDistanceAt(double, double): double
+ *      Distance covered after the given time accelerating towards a speed.
+ * - runDistanceAt(int, double): double
+ *      Distance covered after the given time into a run over n floors.
+ */
+class FlightTable {
+   public:
+    FlightTable(const CarConfig &, int floorCount);
+
+    /* Public methods */
+    bool matches(const CarConfig &) const;
+    bool isKinematic() const;
+
+    long long flightMs(int floors) const;
+    double peakSpeedMps(int floors) const;
+    int floorsPassed(int floors, long long elapsedMs) const;
+
+   private:
+    /* Private data members */
+    const bool kinematic;
+    const int movementMs;
+
+    const int floorHeightMm;
+    const int maxSpeedMmps;
+    const int accelMmps2;
+    const int jerkMmps3;
+
+    const double floorHeight;
+    const double maxSpeed;
+    const double accel;
+    const double jerk;
+
+    std::vector<int> flightMsTable;
+    std::vector<double> peakSpeeds;
+
+    /* Private methods */
+    double peakSpeed(double distance) const;
+    double accelTime(double speed) const;
+    double accelDistance(double speed) const;
+    double accelDistanceAt(double speed, double time) const;
+    double runDistanceAt(int floors, double time) const;
+};
+
+#endif /* FLIGHTTABLE_H */
@@ -0,0 +1,191 @@
+#include "FloorBitset.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Index of the lowest / highest set bit of a nonzero word.
+inline int lowestBit(uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return int(index);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+inline int highestBit(uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, word);
+    return int(index);
+#else
+    return 63 - __builtin_clzll(word);
+#endif
+}
+
+// Masks keeping the bits at or above / at or below a bit position.
+inline uint64_t maskFrom(int bit) { return ~uint64_t(0) << bit; }
+inline uint64_t maskUpTo(int bit) { return ~uint64_t(0) >> (63 - bit); }
+
+inline int popCount(uint64_t word) {
+#if defined(_MSC_VER)
+    return int(__popcnt64(word));
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+}  // namespace
+
+FloorBitset::FloorBitset(int floorCount)
+    : floorCount(floorCount),
+      setCount(0),
+      words((floorCount + 63) / 64, 0),
+      summary((words.size() + 63) / 64, 0) {
+    if (floorCount < 1) throw "ERROR: Floor set needs at least one floor";
+}
+
+void FloorBitset::validateFloorNum(int floorNum) const {
+    if (floorNum < 1 || floorNum > floorCount)
+        throw "ERROR: Floor number out of floor set bounds";
+}
+
+bool FloorBitset::test(int floorNum) const {
+    validateFloorNum(floorNum);
+    int bit = floorNum - 1;
+    return (words[bit >> 6] >> (bit & 63)) & 1;
+}
+
+bool FloorBitset::set(int floorNum, bool active) {
+    if (test(floorNum) == active) return false;
+
+    int bit = floorNum - 1;
+    int w = bit >> 6;
+
+    if (active) {
+        words[w] |= uint64_t(1) << (bit & 63);
+        summary[w >> 6] |= uint64_t(1) << (w & 63);
+        ++setCount;
+    } else {
+        words[w] &= ~(uint64_t(1) << (bit & 63));
+        if (words[w] == 0) summary[w >> 6] &= ~(uint64_t(1) << (w & 63));
+        --setCount;
+    }
+    return true;
+}
+
+void FloorBitset::clear() {
+    words.assign(words.size(), 0);
+    summary.assign(summary.size(), 0);
+    setCount = 0;
+}
+
+int FloorBitset::count() const { return setCount; }
+bool FloorBitset::empty() const { return setCount == 0; }
+
+int FloorBitset::nextAtOrAbove(int floorNum) const {
+    if (floorNum > floorCount) return NO_FLOOR;
+    if (floorNum < 1) floorNum = 1;
+
+    // Rest of the floor's own word
+    int bit = floorNum - 1;
+    int w = bit >> 6;
+    uint64_t bits = words[w] & maskFrom(bit & 63);
+    if (bits) return (w << 6) + lowestBit(bits) + 1;
+
+    // First nonzero word above, found through the summary
+    int nextW = w + 1;
+    int s = nextW >> 6;
+    if (s >= int(summary.size())) return NO_FLOOR;
+
+    uint64_t sBits = summary[s] & maskFrom(nextW & 63);
+    while (!sBits) {
+        if (++s >= int(summary.size())) return NO_FLOOR;
+        sBits = summary[s];
+    }
+
+    int foundW = (s << 6) + lowestBit(sBits);
+    return (foundW << 6) + lowestBit(words[foundW]) + 1;
+}
+
+int FloorBitset::nextAtOrBelow(int floorNum) const {
+    if (floorNum < 1) return NO_FLOOR;
+    if (floorNum > floorCount) floorNum = floorCount;
+
+    // Rest of the floor's own word
+    int bit = floorNum - 1;
+    int w = bit >> 6;
+    uint64_t bits = words[w] & maskUpTo(bit & 63);
+    if (bits) return (w << 6) + highestBit(bits) + 1;
+
+    // First nonzero word below, found through the summary
+    if (w == 0) return NO_FLOOR;
+    int prevW = w - 1;
+    int s = prevW >> 6;
+
+    uint64_t sBits = summary[s] & maskUpTo(prevW & 63);
+    while (!sBits) {
+        if (--s < 0) return NO_FLOOR;
+        sBits = summary[s];
+    }
+
+    int foundW = (s << 6) + highestBit(sBits);
+    return (foundW << 6) + highestBit(words[foundW]) + 1;
+}
+
+int FloorBitset::first() const { return nextAtOrAbove(1); }
+int FloorBitset::last() const { return nextAtOrBelow(floorCount); }
+
+int FloorBitset::countBetween(int fromFloorNum, int toFloorNum) const {
+    int low = std::max(std::min(fromFloorNum, toFloorNum), 1);
+    int high = std::min(std::max(fromFloorNum, toFloorNum), floorCount);
+    if (low > high) return 0;
+
+    int lowBit = low - 1;
+    int highBit = high - 1;
+    int lowW = lowBit >> 6;
+    int highW = highBit >> 6;
+
+    if (lowW == highW)
+        return popCount(words[lowW] & maskFrom(lowBit & 63) &
+                        maskUpTo(highBit & 63));
+
+    // Partial words at both ends, whole words in between
+    int counted = popCount(words[lowW] & maskFrom(lowBit & 63)) +
+                  popCount(words[highW] & maskUpTo(highBit & 63));
+    for (int w = lowW + 1; w < highW; ++w) counted += popCount(words[w]);
+    return counted;
+}
+
+const std::vector<int> FloorBitset::toVector() const {
+    std::vector<int> floors;
+    floors.reserve(setCount);
+
+    // Walk set bits only, in ascending order
+    for (int w = 0, end = int(words.size()); w < end; ++w) {
+        uint64_t bits = words[w];
+        while (bits) {
+            floors.push_back((w << 6) + lowestBit(bits) + 1);
+            bits &= bits - 1;
+        }
+    }
+    return floors;
+}
+
+bool FloorBitset::operator==(const FloorBitset &other) const {
+    // Summaries follow from the words.
+    return floorCount == other.floorCount && setCount == other.setCount &&
+           words == other.words;
+}
+
+bool FloorBitset::operator!=(const FloorBitset &other) const {
+    return !(*this == other);
+}
@@ -0,0 +1,97 @@
+#ifndef FLOORBITSET_H
+#define FLOORBITSET_H
+
+#include <cstdint>
+#include <vector>
+
+/** Set of floor numbers answering nearest-floor queries in near-constant time.
+ *
+ * Two-level bitset over floor numbers 1 to floorCount. Each floor is one bit
+ * in words; each bit of summary marks a nonzero word. Nearest-set-floor
+ * queries scan at most one word, the summary, and one more word, so they stay
+ * fast regardless of the number of floors or calls. Set and clear update both
+ * levels incrementally.
+ *
+ * Data Members:
+ * + NO_FLOOR: int
+ *      Returned by queries when no floor matches. Floor numbers start from 1.
+ *
+ * - floorCount: int
+ *      Number of floors the set covers.
+ * - setCount: int
+ *      Number of floors currently in the set.
+ * - words: std::vector<uint64_t>
+ *      One bit per floor, bit (floor number - 1).
+ * - summary: std::vector<uint64_t>
+ *      One bit per word of words, set if the word is nonzero.
+ *
+ * Class Methods:
+ * + test(int): bool
+ *      Returns true if the floor is in the set.
+ * + set(int, bool): bool
+ *      Adds or removes a floor. Returns true if the set changed.
+ * + clear(): void
+ *      Removes every floor.
+ * + count(): int
+ * + empty(): bool
+ *      Number of floors in the set, or whether there are none.
+ *
+ * + nextAtOrAbove(int): int
+ * + nextAtOrBelow(int): int
+ *      Returns the closest floor in the set at or above / at or below the
+ *      given floor number, or NO_FLOOR if there is none.
+ * + first(): int
+ * + last(): int
+ *      Returns the lowest / highest floor in the set, or NO_FLOOR.
+ * + countBetween(int, int): int
+ *      Returns the number of floors in the set within an inclusive range of
+ *      floor numbers, in either order.
+ *
+ * + toVector(): std::vector<int>
+ *      Returns an ascending list of the floors in the set.
+ *
+ * + operator==(const FloorBitset &): bool
+ * + operator!=(const FloorBitset &): bool
+ *      Compare floor ranges and the floors in the sets.
+ *
+ * - validateFloorNum(int): void
+ *      Throws an exception if the floor number is outside the set's range.
+ */
+class FloorBitset {
+   public:
+    explicit FloorBitset(int floorCount);
+
+    /* Public data members */
+    static const int NO_FLOOR = 0;
+
+    /* Public methods */
+    bool test(int floorNum) const;
+    bool set(int floorNum, bool active);
+    void clear();
+
+    int count() const;
+    bool empty() const;
+
+    int nextAtOrAbove(int floorNum) const;
+    int nextAtOrBelow(int floorNum) const;
+    int first() const;
+    int last() const;
+    int countBetween(int fromFloorNum, int toFloorNum) const;
+
+    const std::vector<int> toVector() const;
+
+    bool operator==(const FloorBitset &) const;
+    bool operator!=(const FloorBitset &) const;
+
+   private:
+    /* Private data members */
+    int floorCount;
+    int setCount;
+    std::vector<uint64_t> words;
+    std::vector<uint64_t> summary;
+
+    /* Private methods */
+    void validateFloorNum(int) const;
+};
+
+#endif /* FLOORBITSET_H */
@@ -0,0 +1,409 @@
+#include "InputJournal.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "SimBuilding.h"
+#include "SimElevator.h"
+#include "SimInput.h"
+#include "TrajectoryDigest.h"
+
+namespace {
+
+// "A3J" and a format version. Older versions lack the newer car settings,
+// which load at their defaults.
+const char magic[4] = {'A', '3', 'J', '7'};
+const char firstVersion = '1';
+const int kindCount = int(SimInput::Kind::DESTINATION_CALL) + 1;
+
+// Bounds keeping a corrupt journal from asking for absurd buildings.
+const uint64_t maxFloors = 1 << 20;
+const uint64_t maxElevators = 1 << 16;
+const uint64_t maxSetting = 0x7fffffff;
+
+bool hasCar(SimInput::Kind kind) {
+    return kind != SimInput::Kind::HALL_CALL &&
+           kind != SimInput::Kind::BUILDING_FIRE &&
+           kind != SimInput::Kind::BUILDING_POWER_OUT &&
+           kind != SimInput::Kind::DESTINATION_CALL;
+}
+
+bool hasFloor(SimInput::Kind kind) {
+    return kind == SimInput::Kind::HALL_CALL ||
+           kind == SimInput::Kind::CAR_CALL ||
+           kind == SimInput::Kind::DESTINATION_CALL;
+}
+
+void writeVarint(std::ostream &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.put(char((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.put(char(value));
+}
+
+uint8_t readByte(std::istream &in) {
+    int c = in.get();
+    if (c == std::char_traits<char>::eof())
+        throw "ERROR: Input journal ends unexpectedly";
+    return uint8_t(c);
+}
+
+uint64_t readVarint(std::istream &in) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = readByte(in);
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    throw "ERROR: Input journal has a malformed number";
+}
+
+// Shares and power draws, which may be 0
+int readShare(std::istream &in, uint64_t max) {
+    uint64_t value = readVarint(in);
+    if (value > max) throw "ERROR: Input journal has an invalid car setting";
+    return int(value);
+}
+
+// Car timings and thresholds, positive ints
+int readSetting(std::istream &in) {
+    uint64_t value = readVarint(in);
+    if (value < 1 || value > maxSetting)
+        throw "ERROR: Input journal has an invalid car setting";
+    return int(value);
+}
+
+}  // namespace
+
+InputJournal::InputJournal(int floorCount, int elevatorCount,
+                           const std::vector<int> &initialFloorNums,
+                           const std::vector<CarConfig> &carConfigs,
+                           SimBuilding::DispatchMode dispatchMode,
+                           long long energyBudgetMs, bool idleParking,
+                           long long parkDelayMs,
+                           const std::string &dispatchPolicy)
+    : floorCount(floorCount),
+      elevatorCount(elevatorCount),
+      initialFloorNums(initialFloorNums),
+      carConfigs(carConfigs),
+      dispatchMode(dispatchMode),
+      dispatchPolicy(dispatchPolicy),
+      energyBudgetMs(energyBudgetMs),
+      idleParking(idleParking),
+      parkDelayMs(parkDelayMs),
+      endMs(0),
+      digest(0),
+      hasDigest(false) {
+    if (int(initialFloorNums.size()) != elevatorCount)
+        throw "ERROR: Initial floor count doesn't match elevator count";
+    if (int(carConfigs.size()) != elevatorCount)
+        throw "ERROR: Car config count doesn't match elevator count";
+    if (energyBudgetMs < 0)
+        throw "ERROR: Energy wait budget can't be negative";
+    if (parkDelayMs < 0) throw "ERROR: Park delay can't be negative";
+    std::vector<std::string> names = SimBuilding::dispatchPolicyNames();
+    if (std::find(names.begin(), names.end(), dispatchPolicy) == names.end())
+        throw "ERROR: Unknown dispatch policy";
+}
+
+InputJournal InputJournal::forBuilding(const SimBuilding &building) {
+    std::vector<int> floorNums;
+    std::vector<CarConfig> configs;
+    for (int carId = 1; carId <= building.elevatorCount; ++carId) {
+        const SimElevator &car = building.getElevator_byCarId(carId);
+        floorNums.push_back(car.currentFloorNum);
+        configs.push_back(car.config);
+    }
+
+    InputJournal journal(building.floorCount, building.elevatorCount,
+                         floorNums, configs, building.getDispatchMode(),
+                         building.getEnergyBudgetMs(),
+                         building.getIdleParking(), building.getParkDelayMs(),
+                         building.getDispatchPolicy());
+    journal.endMs = building.getScheduler().now();
+    return journal;
+}
+
+void InputJournal::record(long long timeMs, const SimInput &input) {
+    if (timeMs < endMs)
+        throw "ERROR: Journal inputs must not go back in time";
+    entries.push_back(Entry{timeMs, input});
+    endMs = timeMs;
+}
+
+void InputJournal::finish(long long newEndMs, uint64_t newDigest) {
+    if (newEndMs < endMs) throw "ERROR: Journal can't end before its inputs";
+    endMs = newEndMs;
+    digest = newDigest;
+    hasDigest = true;
+}
+
+int InputJournal::getFloorCount() const { return floorCount; }
+int InputJournal::getElevatorCount() const { return elevatorCount; }
+const std::vector<int> &InputJournal::getInitialFloorNums() const {
+    return initialFloorNums;
+}
+const std::vector<CarConfig> &InputJournal::getCarConfigs() const {
+    return carConfigs;
+}
+SimBuilding::DispatchMode InputJournal::getDispatchMode() const {
+    return dispatchMode;
+}
+const std::string &InputJournal::getDispatchPolicy() const {
+    return dispatchPolicy;
+}
+long long InputJournal::getEnergyBudgetMs() const { return energyBudgetMs; }
+bool InputJournal::getIdleParking() const { return idleParking; }
+long long InputJournal::getParkDelayMs() const { return parkDelayMs; }
+const std::vector<InputJournal::Entry> &InputJournal::getEntries() const {
+    return entries;
+}
+long long InputJournal::getEndMs() const { return endMs; }
+bool InputJournal::hasStoredDigest() const { return hasDigest; }
+uint64_t InputJournal::getDigest() const { return digest; }
+
+void InputJournal::save(std::ostream &out) const {
+    out.write(magic, sizeof(magic));
+    writeVarint(out, floorCount);
+    writeVarint(out, elevatorCount);
+    out.put(char(dispatchMode));
+    writeVarint(out, uint64_t(energyBudgetMs));
+    out.put(char(idleParking));
+    writeVarint(out, uint64_t(parkDelayMs));
+    std::vector<std::string> names = SimBuilding::dispatchPolicyNames();
+    out.put(char(std::find(names.begin(), names.end(), dispatchPolicy) -
+                 names.begin()));
+    for (int floorNum : initialFloorNums) writeVarint(out, floorNum);
+    for (const CarConfig &config : carConfigs) {
+        writeVarint(out, config.movementMs);
+        writeVarint(out, config.doorSpeedMs);
+        writeVarint(out, config.doorWaitMs);
+        writeVarint(out, config.doorCloseFailThreshold);
+        writeVarint(out, config.safeFloorNums.size());
+        for (int floorNum : config.safeFloorNums) writeVarint(out, floorNum);
+        writeVarint(out, config.floorHeightMm);
+        writeVarint(out, config.maxSpeedMmps);
+        writeVarint(out, config.accelMmps2);
+        writeVarint(out, config.jerkMmps3);
+        writeVarint(out, config.ratedLoadKg);
+        writeVarint(out, config.transferMs);
+
+        // Served floors as runs of consecutive floors, none for every floor
+        std::vector<int> served = config.servedFloorNums;
+        std::sort(served.begin(), served.end());
+        served.erase(std::unique(served.begin(), served.end()), served.end());
+        std::vector<std::pair<int, int>> runs;
+        for (int floorNum : served) {
+            if (!runs.empty() && runs.back().second == floorNum - 1)
+                runs.back().second = floorNum;
+            else
+                runs.push_back(std::make_pair(floorNum, floorNum));
+        }
+        writeVarint(out, runs.size());
+        for (const std::pair<int, int> &run : runs) {
+            writeVarint(out, run.first);
+            writeVarint(out, run.second);
+        }
+
+        writeVarint(out, config.carMassKg);
+        writeVarint(out, config.counterweightPercent);
+        writeVarint(out, config.driveEfficiencyPercent);
+        writeVarint(out, config.regenPercent);
+        writeVarint(out, config.doorPowerW);
+        writeVarint(out, config.standbyPowerW);
+    }
+
+    writeVarint(out, entries.size());
+    long long lastMs = 0;
+    for (const Entry &entry : entries) {
+        const SimInput &input = entry.input;
+
+        writeVarint(out, uint64_t(entry.timeMs - lastMs));
+        lastMs = entry.timeMs;
+
+        out.put(char(int(input.kind) << 2 | (input.dir == Direction::UP) << 1 |
+                     int(input.active)));
+        if (hasCar(input.kind)) writeVarint(out, input.carId);
+        if (hasFloor(input.kind)) writeVarint(out, input.floorNum);
+        if (input.kind == SimInput::Kind::DESTINATION_CALL)
+            writeVarint(out, input.destinationFloorNum);
+    }
+
+    writeVarint(out, uint64_t(endMs - lastMs));
+    out.put(char(hasDigest));
+    for (int byte = 0; byte < 8; ++byte)
+        out.put(char((digest >> (8 * byte)) & 0xff));
+}
+
+InputJournal InputJournal::load(std::istream &in) {
+    char header[sizeof(magic)];
+    if (!in.read(header, sizeof(header)) ||
+        !std::equal(header, header + 3, magic) || header[3] < firstVersion ||
+        header[3] > magic[3])
+        throw "ERROR: Not an input journal";
+    int version = header[3] - '0';
+
+    uint64_t floors = readVarint(in);
+    uint64_t elevators = readVarint(in);
+    if (floors < 1 || floors > maxFloors || elevators < 1 ||
+        elevators > maxElevators)
+        throw "ERROR: Input journal has an invalid building size";
+
+    uint8_t mode = readByte(in);
+    if (mode > uint8_t(SimBuilding::DispatchMode::DESTINATION))
+        throw "ERROR: Input journal has an invalid dispatch mode";
+    uint64_t budgetMs = version >= 5 ? readVarint(in) : 0;
+    if (budgetMs > maxSetting)
+        throw "ERROR: Input journal has an invalid energy budget";
+    bool parking = version >= 6 && readByte(in);
+    uint64_t parkDelay = version >= 6
+                             ? readVarint(in)
+                             : uint64_t(SimBuilding::defaultParkDelayMs);
+    if (parkDelay > maxSetting)
+        throw "ERROR: Input journal has an invalid park delay";
+    std::vector<std::string> policyNames = SimBuilding::dispatchPolicyNames();
+    uint8_t policy = version >= 7 ? readByte(in) : 0;
+    if (policy >= policyNames.size())
+        throw "ERROR: Input journal has an unknown dispatch policy";
+
+    std::vector<int> floorNums;
+    for (uint64_t e_ind = 0; e_ind < elevators; ++e_ind) {
+        uint64_t floorNum = readVarint(in);
+        if (floorNum < 1 || floorNum > floors)
+            throw "ERROR: Input journal has an invalid initial floor";
+        floorNums.push_back(int(floorNum));
+    }
+
+    std::vector<CarConfig> configs;
+    for (uint64_t e_ind = 0; e_ind < elevators; ++e_ind) {
+        CarConfig config;
+        config.movementMs = readSetting(in);
+        config.doorSpeedMs = readSetting(in);
+        config.doorWaitMs = readSetting(in);
+        config.doorCloseFailThreshold = readSetting(in);
+
+        uint64_t safeCount = readVarint(in);
+        if (safeCount < 1 || safeCount > floors)
+            throw "ERROR: Input journal has an invalid safe floor count";
+        config.safeFloorNums.clear();
+        for (uint64_t s_ind = 0; s_ind < safeCount; ++s_ind) {
+            uint64_t floorNum = readVarint(in);
+            if (floorNum < 1 || floorNum > floors)
+                throw "ERROR: Input journal has an invalid safe floor";
+            config.safeFloorNums.push_back(int(floorNum));
+        }
+
+        if (version >= 2) {
+            config.floorHeightMm = readSetting(in);
+            uint64_t maxSpeed = readVarint(in);  // 0 without a motion profile
+            if (maxSpeed > maxSetting)
+                throw "ERROR: Input journal has an invalid car setting";
+            config.maxSpeedMmps = int(maxSpeed);
+            config.accelMmps2 = readSetting(in);
+            config.jerkMmps3 = readSetting(in);
+        }
+        if (version >= 3) {
+            config.ratedLoadKg = readSetting(in);
+            config.transferMs = readSetting(in);
+        }
+        if (version >= 4) {
+            uint64_t runCount = readVarint(in);
+            if (runCount > floors)
+                throw "ERROR: Input journal has invalid served floors";
+            for (uint64_t r_ind = 0; r_ind < runCount; ++r_ind) {
+                uint64_t first = readVarint(in);
+                uint64_t last = readVarint(in);
+                if (first < 1 || first > last || last > floors)
+                    throw "ERROR: Input journal has invalid served floors";
+                for (uint64_t floorNum = first; floorNum <= last; ++floorNum)
+                    config.servedFloorNums.push_back(int(floorNum));
+            }
+        }
+        if (version >= 5) {
+            config.carMassKg = readSetting(in);
+            config.counterweightPercent = readShare(in, 100);
+            config.driveEfficiencyPercent = readShare(in, 100);
+            config.regenPercent = readShare(in, 100);
+            config.doorPowerW = readShare(in, maxSetting);
+            config.standbyPowerW = readShare(in, maxSetting);
+            if (config.driveEfficiencyPercent < 1)
+                throw "ERROR: Input journal has an invalid car setting";
+        }
+        configs.push_back(config);
+    }
+
+    InputJournal journal(int(floors), int(elevators), floorNums, configs,
+                         SimBuilding::DispatchMode(mode), (long long)budgetMs,
+                         parking, (long long)parkDelay,
+                         policyNames[policy]);
+
+    uint64_t entryCount = readVarint(in);
+    long long timeMs = 0;
+    for (uint64_t e_ind = 0; e_ind < entryCount; ++e_ind) {
+        timeMs += (long long)readVarint(in);
+
+        uint8_t code = readByte(in);
+        if ((code >> 2) >= kindCount)
+            throw "ERROR: Input journal has an unknown input";
+
+        SimInput input{SimInput::Kind(code >> 2), 0, 0, Direction::NONE,
+                       bool(code & 1), 0};
+        if (hasCar(input.kind)) input.carId = int(readVarint(in));
+        if (hasFloor(input.kind)) input.floorNum = int(readVarint(in));
+        if (input.kind == SimInput::Kind::DESTINATION_CALL)
+            input.destinationFloorNum = int(readVarint(in));
+        if (input.kind == SimInput::Kind::HALL_CALL)
+            input.dir = (code & 2) ? Direction::UP : Direction::DOWN;
+
+        journal.record(timeMs, input);
+    }
+
+    long long endMs = timeMs + (long long)readVarint(in);
+    bool stored = readByte(in);
+    uint64_t storedDigest = 0;
+    for (int byte = 0; byte < 8; ++byte)
+        storedDigest |= uint64_t(readByte(in)) << (8 * byte);
+
+    journal.endMs = endMs;
+    journal.digest = storedDigest;
+    journal.hasDigest = stored;
+    return journal;
+}
+
+std::unique_ptr<SimBuilding> InputJournal::createBuilding() const {
+    std::unique_ptr<SimBuilding> building(
+        new SimBuilding(floorCount, elevatorCount, initialFloorNums,
+                        carConfigs));
+    building->setDispatchMode(dispatchMode);
+    building->setDispatchPolicy(dispatchPolicy);
+    building->setEnergyBudgetMs(energyBudgetMs);
+    building->setParkDelayMs(parkDelayMs);
+    building->setIdleParking(idleParking);
+    return building;
+}
+
+void InputJournal::replay(SimBuilding &building) const {
+    SimScheduler &scheduler = building.getScheduler();
+
+    for (const Entry &entry : entries) {
+        scheduler.runUntil(entry.timeMs);
+        entry.input.apply(building);
+    }
+    scheduler.runUntil(endMs);
+}
+
+bool InputJournal::verify() const {
+    if (!hasDigest) throw "ERROR: Input journal has no digest to verify";
+
+    std::unique_ptr<SimBuilding> building = createBuilding();
+    TrajectoryDigest replayed(building.get());
+    replay(*building);
+    return replayed.value() == digest;
+}
@@ -0,0 +1,153 @@
+#ifndef INPUTJOURNAL_H
+#define INPUTJOURNAL_H
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "CarConfig.h"
+#include "SimBuilding.h"
+#include "SimInput.h"
+
+/** Recording of a simulation's external inputs, for exact replay.
+ *
+ * The simulation is deterministic given its starting state and its inputs,
+ * so a journal of the building layout, the initial car floors and settings,
+ * the dispatch mode and policy, energy budget and idle parking, and every
+ * input with its simulated time is enough to reproduce a run exactly,
+ * headless and at full speed. Recording can also store the run's end time and
+ * TrajectoryDigest, so a replay can prove it took the same trajectory.
+ *
+ * Inputs are replayed the way they were applied: the scheduler first runs
+ * every event due up to the input's time, then the input is applied.
+ *
+ * Binary format, integers as unsigned LEB128 varints unless noted:
+ *      "A3J7" magic, floorCount, elevatorCount, dispatch mode (1 byte),
+ *      energyBudgetMs, idle parking flag (1 byte), parkDelayMs, dispatch policy
+ *      (1 byte, its registry index), initial floor of each car, then each car's
+ *      CarConfig (movementMs, doorSpeedMs, doorWaitMs, doorCloseFailThreshold,
+ *      safe floor count, safe floors, floorHeightMm, maxSpeedMmps, accelMmps2,
+ *      jerkMmps3, ratedLoadKg, transferMs, served floors as a run count and the
+ *      first and last floor of each run, no runs for every floor, carMassKg,
+ *      counterweightPercent, driveEfficiencyPercent, regenPercent, doorPowerW,
+ *      standbyPowerW), entry count, then per entry: time since the previous
+ *      entry, code byte (kind << 2 | UP << 1 | active), car ID for car inputs,
+ *      floor number for hall, car and destination calls, destination floor
+ *      number for destination calls. Then the end time since the last entry, a
+ *      digest flag byte and the digest (8 bytes, little-endian). Older versions
+ *      load with the settings they lack at their defaults: "A3J1" has no motion
+ *      profile settings, "A3J2" no ratedLoadKg and transferMs, "A3J3" no served
+ *      floors, "A3J4" no energy budget and energy settings, "A3J5" no idle
+ *      parking, "A3J6" no dispatch policy.
+ *
+ * Data Members:
+ * + Entry: struct
+ *      An input and the simulated time it was applied at.
+ *
+ * - floorCount / elevatorCount: int
+ * - initialFloorNums: std::vector<int>
+ * - carConfigs: std::vector<CarConfig>
+ * - dispatchMode: SimBuilding::DispatchMode
+ * - dispatchPolicy: std::string
+ * - energyBudgetMs: long long
+ * - idleParking / parkDelayMs: bool / long long
+ *      Starting state of the recorded building.
+ * - entries: std::vector<Entry>
+ *      Inputs in the order applied, times never decreasing.
+ * - endMs: long long
+ *      Simulated time the recording ended at.
+ * - digest / hasDigest: uint64_t / bool
+ *      TrajectoryDigest of the recorded run up to endMs, if stored.
+ *
+ * Class Methods:
+ * + forBuilding(const SimBuilding &): InputJournal
+ *      Starts a journal from a building's current layout, car floors and
+ *      settings, dispatch mode and policy, energy budget and idle parking.
+ *      Meant for buildings that haven't run yet.
+ *
+ * + record(long long, const SimInput &): void
+ *      Appends an input. Throws if time goes backwards.
+ * + finish(long long, uint64_t): void
+ *      Stores the end time and digest of the recorded run.
+ *
+ * + Getters for each data member.
+ *
+ * + save(std::ostream &): void
+ * + load(std::istream &): InputJournal
+ *      Write / read the binary format. Loading throws on malformed data.
+ *
+ * + createBuilding(): std::unique_ptr<SimBuilding>
+ *      Builds the recorded building in its starting state.
+ * + replay(SimBuilding &): void
+ *      Applies every input at its time, then runs up to the end time.
+ * + verify(): bool
+ *      Replays on a new building and returns true if the digest matches
+ *      the stored one. Throws if no digest is stored.
+ */
+class InputJournal {
+   public:
+    /* Public data structs */
+    typedef struct Entry {
+        long long timeMs;
+        SimInput input;
+    } Entry;
+
+    InputJournal(int floorCount, int elevatorCount,
+                 const std::vector<int> &initialFloorNums,
+                 const std::vector<CarConfig> &carConfigs,
+                 SimBuilding::DispatchMode, long long energyBudgetMs = 0,
+                 bool idleParking = false,
+                 long long parkDelayMs = SimBuilding::defaultParkDelayMs,
+                 const std::string &dispatchPolicy =
+                     SimBuilding::defaultDispatchPolicy);
+
+    /* Public methods */
+    static InputJournal forBuilding(const SimBuilding &);
+
+    void record(long long timeMs, const SimInput &);
+    void finish(long long endMs, uint64_t digest);
+
+    int getFloorCount() const;
+    int getElevatorCount() const;
+    const std::vector<int> &getInitialFloorNums() const;
+    const std::vector<CarConfig> &getCarConfigs() const;
+    SimBuilding::DispatchMode getDispatchMode() const;
+    const std::string &getDispatchPolicy() const;
+    long long getEnergyBudgetMs() const;
+    bool getIdleParking() const;
+    long long getParkDelayMs() const;
+    const std::vector<Entry> &getEntries() const;
+    long long getEndMs() const;
+    bool hasStoredDigest() const;
+    uint64_t getDigest() const;
+
+    void save(std::ostream &) const;
+    static InputJournal load(std::istream &);
+
+    std::unique_ptr<SimBuilding> createBuilding() const;
+    void replay(SimBuilding &) const;
+    bool verify() const;
+
+   private:
+    /* Private data members */
+    int floorCount;
+    int elevatorCount;
+    std::vector<int> initialFloorNums;
+    std::vector<CarConfig> carConfigs;
+    SimBuilding::DispatchMode dispatchMode;
+    std::string dispatchPolicy;
+    long long energyBudgetMs;
+    bool idleParking;
+    long long parkDelayMs;
+
+    std::vector<Entry> entries;
+
+    long long endMs;
+    uint64_t digest;
+    bool hasDigest;
+};
+
+#endif /* INPUTJOURNAL_H */
@@ -0,0 +1,121 @@
+#include "LogFileSink.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LogRecord.h"
+
+const int LogFileSink::flushIntervalMs;
+
+LogFileSink::LogFileSink(const std::string &path, size_t maxPending)
+    : out(path, std::ios::out | std::ios::app),
+      maxPending(maxPending),
+      droppedCount(0),
+      totalDropped(0),
+      stopping(false) {
+    if (!out) throw "ERROR: Log file can't be opened";
+    if (maxPending < 1) throw "ERROR: Log sink needs room for one record";
+
+    pending.reserve(maxPending);
+    writer = std::thread(&LogFileSink::run, this);
+}
+
+LogFileSink::~LogFileSink() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+void LogFileSink::write(const LogRecord &record) {
+    bool halfFull;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (pending.size() >= maxPending) {
+            ++droppedCount;
+            ++totalDropped;
+            return;
+        }
+        pending.push_back(record);
+        halfFull = pending.size() == (maxPending + 1) / 2;
+    }
+
+    // Only wake the writer early when a batch risks overflowing.
+    if (halfFull) wake.notify_one();
+}
+
+unsigned long long LogFileSink::dropped() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return totalDropped;
+}
+
+void LogFileSink::run() {
+    std::vector<LogRecord> batch;
+    batch.reserve(maxPending);
+
+    while (true) {
+        unsigned long long batchDropped;
+        bool done;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait_for(guard, std::chrono::milliseconds(flushIntervalMs),
+                          [this]() {
+                              return stopping || pending.size() >=
+                                                     (maxPending + 1) / 2;
+                          });
+            batch.swap(pending);
+            batchDropped = droppedCount;
+            droppedCount = 0;
+            done = stopping;
+        }
+
+        for (const LogRecord &record : batch) writeRecord(out, record);
+        if (batchDropped)
+            out << "{\"dropped\": " << batchDropped << "}\n";
+        if (!batch.empty() || batchDropped) out.flush();
+        batch.clear();
+
+        // Records queued before stopping was set were in this batch.
+        if (done) return;
+    }
+}
+
+void LogFileSink::writeRecord(std::ostream &out, const LogRecord &record) {
+    out << "{\"time_ms\": " << record.timeMs << ", \"car\": " << record.carId
+        << ", \"text\": \"";
+
+    // JSON string escaping
+    for (unsigned char c : record.text) {
+        switch (c) {
+            case '"':
+                out << "\\\"";
+                break;
+            case '\\':
+                out << "\\\\";
+                break;
+            case '\n':
+                out << "\\n";
+                break;
+            case '\t':
+                out << "\\t";
+                break;
+            default:
+                if (c < 0x20) {
+                    char escaped[7];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out << escaped;
+                } else {
+                    out << char(c);
+                }
+        }
+    }
+    out << "\"}\n";
+}
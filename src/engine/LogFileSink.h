@@ -0,0 +1,92 @@
+#ifndef LOGFILESINK_H
+#define LOGFILESINK_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LogRecord.h"
+
+/** Writes log records to a file on a background thread.
+ *
+ * write() only appends the record to a pending batch under a short lock;
+ * a writer thread swaps the batch out every flushIntervalMs (or sooner once
+ * it is half full) and writes it as JSON Lines, one object per record:
+ *
+ *      {"time_ms": 1500, "car": 2, "text": "*ring!*"}
+ *
+ * So logging never waits on the disk. If the disk can't keep up and
+ * maxPending records are already waiting, new records are dropped instead,
+ * and a {"dropped": n} line marks the gap.
+ *
+ * Data Members:
+ * - out: std::ofstream
+ *      File written to, only touched by the writer thread after opening.
+ * - pending: std::vector<LogRecord>
+ *      Records waiting to be written. Guarded by lock.
+ * - maxPending: size_t
+ *      Most records pending before new ones are dropped.
+ * - droppedCount: unsigned long long
+ *      Records dropped since the last batch was written. Guarded by lock.
+ * - totalDropped: unsigned long long
+ *      Records dropped overall. Guarded by lock.
+ * - stopping: bool
+ *      Set when the sink is destroyed. Guarded by lock.
+ * - lock: std::mutex
+ * - wake: std::condition_variable
+ *      Wakes the writer early, for a half-full batch or shutdown.
+ * - writer: std::thread
+ *      Background thread writing batches.
+ * - flushIntervalMs: int
+ *      Longest time a record waits before being written.
+ *
+ * Class Methods:
+ * + write(const LogRecord &): void
+ *      Queues a record for writing. Never blocks on file I/O.
+ * + dropped(): unsigned long long
+ *      Number of records dropped because the writer fell behind.
+ *
+ * - run(): void
+ *      Writer thread loop.
+ * - writeRecord(std::ostream &, const LogRecord &): void
+ *      Writes one record as a JSON line.
+ */
+class LogFileSink {
+   public:
+    // Throws if the file can't be opened.
+    explicit LogFileSink(const std::string &path, size_t maxPending = 65536);
+    ~LogFileSink();
+
+    LogFileSink(const LogFileSink &) = delete;
+    LogFileSink &operator=(const LogFileSink &) = delete;
+
+    /* Public methods */
+    void write(const LogRecord &);
+    unsigned long long dropped() const;
+
+   private:
+    /* Private data members */
+    std::ofstream out;
+
+    std::vector<LogRecord> pending;
+    const size_t maxPending;
+    unsigned long long droppedCount;
+    unsigned long long totalDropped;
+    bool stopping;
+
+    mutable std::mutex lock;
+    std::condition_variable wake;
+    std::thread writer;
+
+    static const int flushIntervalMs = 100;
+
+    /* Private methods */
+    void run();
+    static void writeRecord(std::ostream &, const LogRecord &);
+};
+
+#endif /* LOGFILESINK_H */
@@ -0,0 +1,117 @@
+#include "LogHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Index of the highest set bit of a nonzero value.
+inline int highestBit(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return int(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+}  // namespace
+
+LogHistogram::LogHistogram()
+    : counts(bucketOf(INT64_MAX) + 1, 0),
+      sampleCount(0),
+      sampleSum(0),
+      minValue(0),
+      maxValue(0) {}
+
+int LogHistogram::bucketOf(long long value) {
+    if (value < subBuckets) return int(value);
+
+    // Power of two, then which of its sub-buckets
+    int shift = highestBit(uint64_t(value)) - subBucketBits;
+    int sub = int(value >> shift) - subBuckets;
+    return subBuckets + shift * subBuckets + sub;
+}
+
+long long LogHistogram::bucketLow(int bucket) {
+    if (bucket < subBuckets) return bucket;
+
+    int shift = (bucket - subBuckets) / subBuckets;
+    int sub = (bucket - subBuckets) % subBuckets;
+    return (long long)(subBuckets + sub) << shift;
+}
+
+long long LogHistogram::bucketHigh(int bucket) {
+    if (bucket < subBuckets) return bucket;
+
+    int shift = (bucket - subBuckets) / subBuckets;
+    return bucketLow(bucket) + ((1LL << shift) - 1);
+}
+
+void LogHistogram::record(long long value) {
+    if (value < 0) value = 0;
+
+    ++counts[bucketOf(value)];
+    if (sampleCount == 0 || value < minValue) minValue = value;
+    if (sampleCount == 0 || value > maxValue) maxValue = value;
+    ++sampleCount;
+    sampleSum += value;
+}
+
+void LogHistogram::clear() {
+    counts.assign(counts.size(), 0);
+    sampleCount = 0;
+    sampleSum = 0;
+    minValue = maxValue = 0;
+}
+
+void LogHistogram::merge(const LogHistogram &other) {
+    if (other.sampleCount == 0) return;
+
+    for (size_t b_ind = 0; b_ind < counts.size(); ++b_ind)
+        counts[b_ind] += other.counts[b_ind];
+
+    if (sampleCount == 0 || other.minValue < minValue)
+        minValue = other.minValue;
+    if (sampleCount == 0 || other.maxValue > maxValue)
+        maxValue = other.maxValue;
+    sampleCount += other.sampleCount;
+    sampleSum += other.sampleSum;
+}
+
+unsigned long long LogHistogram::count() const { return sampleCount; }
+
+double LogHistogram::mean() const {
+    return sampleCount ? double(sampleSum / sampleCount) : 0.0;
+}
+
+long long LogHistogram::min() const { return minValue; }
+long long LogHistogram::max() const { return maxValue; }
+
+long long LogHistogram::percentile(double fraction) const {
+    if (sampleCount == 0) return 0;
+    fraction = std::min(std::max(fraction, 0.0), 1.0);
+
+    // Rank of the sample wanted, counting from 1
+    unsigned long long rank =
+        std::max(1ULL, (unsigned long long)std::ceil(fraction * sampleCount));
+
+    unsigned long long seen = 0;
+    for (size_t b_ind = 0; b_ind < counts.size(); ++b_ind) {
+        seen += counts[b_ind];
+        if (seen >= rank) {
+            long long middle =
+                bucketLow(int(b_ind)) +
+                (bucketHigh(int(b_ind)) - bucketLow(int(b_ind))) / 2;
+            return std::min(std::max(middle, minValue), maxValue);
+        }
+    }
+    return maxValue;
+}
@@ -0,0 +1,79 @@
+#ifndef LOGHISTOGRAM_H
+#define LOGHISTOGRAM_H
+
+#include <cstdint>
+#include <vector>
+
+/** Histogram of non-negative integer samples in logarithmic buckets.
+ *
+ * Values below subBuckets get a bucket each; above that every power of two
+ * is split into subBuckets equal buckets, so a bucket is never wider than
+ * 1/subBuckets of the values it holds. Percentiles are answered from the
+ * bucket counts within that relative error, in constant memory however many
+ * samples are recorded. Count, sum, minimum and maximum are exact.
+ *
+ * Data Members:
+ * - subBuckets: int
+ *      Buckets per power of two (16, for at most ~6% relative error).
+ * - counts: std::vector<uint64_t>
+ *      Samples recorded in each bucket.
+ * - sampleCount / sampleSum: unsigned long long / long double
+ * - minValue / maxValue: long long
+ *      Exact statistics of every sample recorded.
+ *
+ * Class Methods:
+ * + record(long long): void
+ *      Records a sample. Negative samples are recorded as 0.
+ * + clear(): void
+ *      Forgets every sample.
+ * + merge(const LogHistogram &): void
+ *      Adds another histogram's samples to this one.
+ *
+ * + count(): unsigned long long
+ * + mean(): double
+ * + min(): long long
+ * + max(): long long
+ *      Exact statistics of the samples, 0 when empty.
+ * + percentile(double): long long
+ *      Value at or below which the given fraction (0 to 1) of samples fall,
+ *      taken as the middle of its bucket and kept within min() and max().
+ *      0 when empty.
+ *
+ * - bucketOf(long long): int
+ * - bucketLow(int): long long
+ * - bucketHigh(int): long long
+ *      Bucket holding a value, and the range of values a bucket holds.
+ */
+class LogHistogram {
+   public:
+    LogHistogram();
+
+    /* Public methods */
+    void record(long long value);
+    void clear();
+    void merge(const LogHistogram &);
+
+    unsigned long long count() const;
+    double mean() const;
+    long long min() const;
+    long long max() const;
+    long long percentile(double fraction) const;
+
+   private:
+    /* Private data members */
+    static const int subBuckets = 16;
+    static const int subBucketBits = 4;
+
+    std::vector<uint64_t> counts;
+    unsigned long long sampleCount;
+    long double sampleSum;
+    long long minValue;
+    long long maxValue;
+
+    /* Private methods */
+    static int bucketOf(long long value);
+    static long long bucketLow(int bucket);
+    static long long bucketHigh(int bucket);
+};
+
+#endif /* LOGHISTOGRAM_H */
@@ -0,0 +1,22 @@
+#ifndef LOGRECORD_H
+#define LOGRECORD_H
+
+#include <string>
+
+/** One message of the simulation's event log.
+ *
+ * Data Members:
+ * + timeMs: long long
+ *      Simulated time the message was emitted at.
+ * + carId: int
+ *      Car that emitted the message, or 0 for building-wide messages.
+ * + text: std::string
+ *      The message.
+ */
+typedef struct LogRecord {
+    long long timeMs;
+    int carId;
+    std::string text;
+} LogRecord;
+
+#endif /* LOGRECORD_H */
@@ -0,0 +1,156 @@
+#include "MetricsReport.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+typedef struct HistogramField {
+    const char *name;
+    const LogHistogram *histogram;
+} HistogramField;
+
+// Summary statistics exported for every histogram, as (name, value) pairs.
+typedef struct Statistic {
+    const char *name;
+    double value;
+} Statistic;
+
+std::vector<Statistic> summarize(const LogHistogram &histogram) {
+    return {{"count", double(histogram.count())},
+            {"mean", histogram.mean()},
+            {"p50", double(histogram.percentile(0.50))},
+            {"p95", double(histogram.percentile(0.95))},
+            {"p99", double(histogram.percentile(0.99))},
+            {"max", double(histogram.max())}};
+}
+
+}  // namespace
+
+MetricsReport::MetricsReport() : runs(0), elapsedMs(0) {}
+
+void MetricsReport::merge(const MetricsReport &other) {
+    if (other.runs == 0) return;
+    if (runs == 0) {
+        *this = other;
+        return;
+    }
+    if (cars.size() != other.cars.size())
+        throw "ERROR: Can't merge metrics of different car counts";
+
+    runs += other.runs;
+    elapsedMs += other.elapsedMs;
+    waitTimes.merge(other.waitTimes);
+    rideTimes.merge(other.rideTimes);
+    journeyTimes.merge(other.journeyTimes);
+    handlingCapacity.merge(other.handlingCapacity);
+
+    for (size_t e_ind = 0; e_ind < cars.size(); ++e_ind) {
+        CarStats &stats = cars[e_ind];
+        const CarStats &otherStats = other.cars[e_ind];
+        stats.movingMs += otherStats.movingMs;
+        stats.busyMs += otherStats.busyMs;
+        stats.stops += otherStats.stops;
+        stats.trips += otherStats.trips;
+        stats.doorCycles += otherStats.doorCycles;
+        stats.tractionKWh += otherStats.tractionKWh;
+        stats.regeneratedKWh += otherStats.regeneratedKWh;
+        stats.doorKWh += otherStats.doorKWh;
+        stats.standbyKWh += otherStats.standbyKWh;
+    }
+}
+
+double MetricsReport::utilization(int carId) const {
+    return elapsedMs ? double(cars.at(carId - 1).busyMs) / elapsedMs : 0.0;
+}
+
+double MetricsReport::movingFraction(int carId) const {
+    return elapsedMs ? double(cars.at(carId - 1).movingMs) / elapsedMs : 0.0;
+}
+
+double MetricsReport::energyKWh() const {
+    double total = 0;
+    for (const CarStats &stats : cars) total += stats.netKWh();
+    return total;
+}
+
+double MetricsReport::energyPerTripKWh() const {
+    unsigned long long trips = journeyTimes.count();
+    return trips ? energyKWh() / trips : 0.0;
+}
+
+void MetricsReport::writeJson(std::ostream &out) const {
+    const HistogramField histograms[] = {
+        {"wait_ms", &waitTimes},
+        {"ride_ms", &rideTimes},
+        {"journey_ms", &journeyTimes},
+        {"delivered_per_5min", &handlingCapacity}};
+
+    out << "{\n  \"runs\": " << runs << ",\n  \"elapsed_ms\": " << elapsedMs
+        << ",\n  \"passengers\": {";
+    for (int h_ind = 0; h_ind < 4; ++h_ind) {
+        out << (h_ind ? "," : "") << "\n    \"" << histograms[h_ind].name
+            << "\": {";
+        std::vector<Statistic> stats = summarize(*histograms[h_ind].histogram);
+        for (size_t s_ind = 0; s_ind < stats.size(); ++s_ind)
+            out << (s_ind ? ", " : "") << '"' << stats[s_ind].name
+                << "\": " << stats[s_ind].value;
+        out << "}";
+    }
+    out << "\n  },\n  \"energy\": {\"net_kwh\": " << energyKWh()
+        << ", \"kwh_per_trip\": " << energyPerTripKWh()
+        << "},\n  \"cars\": [";
+
+    for (int carId = 1; carId <= int(cars.size()); ++carId) {
+        const CarStats &stats = cars[carId - 1];
+        out << (carId > 1 ? "," : "") << "\n    {\"car\": " << carId
+            << ", \"utilization\": " << utilization(carId)
+            << ", \"moving_fraction\": " << movingFraction(carId)
+            << ", \"stops\": " << stats.stops << ", \"trips\": " << stats.trips
+            << ", \"stops_per_trip\": " << stats.stopsPerTrip()
+            << ", \"door_cycles\": " << stats.doorCycles
+            << ", \"traction_kwh\": " << stats.tractionKWh
+            << ", \"regenerated_kwh\": " << stats.regeneratedKWh
+            << ", \"door_kwh\": " << stats.doorKWh
+            << ", \"standby_kwh\": " << stats.standbyKWh << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+void MetricsReport::writeCsv(std::ostream &out) const {
+    const HistogramField histograms[] = {
+        {"wait_ms", &waitTimes},
+        {"ride_ms", &rideTimes},
+        {"journey_ms", &journeyTimes},
+        {"delivered_per_5min", &handlingCapacity}};
+
+    out << "scope,metric,statistic,value\n";
+    out << "run,runs,value," << runs << '\n';
+    out << "run,elapsed_ms,value," << elapsedMs << '\n';
+
+    for (const HistogramField &field : histograms)
+        for (const Statistic &stat : summarize(*field.histogram))
+            out << "passengers," << field.name << ',' << stat.name << ','
+                << stat.value << '\n';
+    out << "energy,net_kwh,value," << energyKWh() << '\n';
+    out << "energy,kwh_per_trip,value," << energyPerTripKWh() << '\n';
+
+    for (int carId = 1; carId <= int(cars.size()); ++carId) {
+        const CarStats &stats = cars[carId - 1];
+        std::string scope = "car" + std::to_string(carId);
+        out << scope << ",utilization,value," << utilization(carId) << '\n'
+            << scope << ",moving_fraction,value," << movingFraction(carId)
+            << '\n'
+            << scope << ",stops,value," << stats.stops << '\n'
+            << scope << ",trips,value," << stats.trips << '\n'
+            << scope << ",stops_per_trip,value," << stats.stopsPerTrip()
+            << '\n'
+            << scope << ",door_cycles,value," << stats.doorCycles << '\n'
+            << scope << ",traction_kwh,value," << stats.tractionKWh << '\n'
+            << scope << ",regenerated_kwh,value," << stats.regeneratedKWh
+            << '\n'
+            << scope << ",door_kwh,value," << stats.doorKWh << '\n'
+            << scope << ",standby_kwh,value," << stats.standbyKWh << '\n';
+    }
+}
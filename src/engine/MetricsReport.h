@@ -0,0 +1,112 @@
+#ifndef METRICSREPORT_H
+#define METRICSREPORT_H
+
+#include <ostream>
+#include <vector>
+
+#include "LogHistogram.h"
+
+/** Snapshot of service-level metrics, detached from any simulation.
+ *
+ * Produced by SimMetrics::report(). Reports of several runs of the same
+ * building layout can be merged into one: histograms pool their samples,
+ * and per-car counters and times add up, so utilization stays the share of
+ * the total simulated time. Energy is what the cars' EnergyModels accrued.
+ *
+ * Data Members:
+ * + CarStats: struct
+ *      Activity of one car.
+ *      - movingMs: time spent moving.
+ *      - busyMs: time spent moving or with doors not closed.
+ *      - stops: stops made to take passengers.
+ *      - trips: runs of travel in one direction.
+ *      - doorCycles: times the doors started opening.
+ *      - tractionKWh / regeneratedKWh / doorKWh / standbyKWh: energy drawn
+ *        for runs, fed back, drawn by the doors and standing by.
+ *      - stopsPerTrip(): average stops per trip.
+ *      - netKWh(): energy drawn less fed back.
+ *
+ * + runs: int
+ *      Number of runs merged into the report.
+ * + elapsedMs: long long
+ *      Simulated time covered, summed over runs.
+ * + waitTimes: LogHistogram
+ *      Per passenger, hall call press to car arrival, in ms.
+ * + rideTimes: LogHistogram
+ *      Per passenger, boarding to alighting, in ms.
+ * + journeyTimes: LogHistogram
+ *      Per passenger, hall call press to alighting, in ms.
+ * + handlingCapacity: LogHistogram
+ *      Per completed 5-minute window (handlingWindowMs) of a run, passengers
+ *      delivered. Its maximum is the handling capacity shown, in passengers
+ *      per 5 minutes.
+ * + cars: std::vector<CarStats>
+ *      Indexed by car ID - 1.
+ *
+ * Class Methods:
+ * + merge(const MetricsReport &): void
+ *      Adds another report's runs to this one. An empty report (no runs)
+ *      takes on the other's layout. Throws if the car counts differ.
+ * + utilization(int): double
+ * + movingFraction(int): double
+ *      Share of the elapsed time a car (by ID) was busy / moving.
+ * + energyKWh(): double
+ *      Net energy of every car.
+ * + energyPerTripKWh(): double
+ *      Net energy per passenger delivered, 0 if none was.
+ *
+ * + writeJson(std::ostream &): void
+ * + writeCsv(std::ostream &): void
+ *      Export every metric, with count, mean, p50, p95, p99 and max for each
+ *      histogram. The CSV is in long form: scope, metric, statistic, value.
+ */
+class MetricsReport {
+   public:
+    /* Public data structs */
+    typedef struct CarStats {
+        long long movingMs;
+        long long busyMs;
+        unsigned long long stops;
+        unsigned long long trips;
+        unsigned long long doorCycles;
+        double tractionKWh;
+        double regeneratedKWh;
+        double doorKWh;
+        double standbyKWh;
+
+        double stopsPerTrip() const {
+            return trips ? double(stops) / trips : 0.0;
+        }
+        double netKWh() const {
+            return tractionKWh + doorKWh + standbyKWh - regeneratedKWh;
+        }
+    } CarStats;
+
+    MetricsReport();
+
+    /* Public data members */
+    static const long long handlingWindowMs = 5 * 60 * 1000;
+
+    int runs;
+    long long elapsedMs;
+
+    LogHistogram waitTimes;
+    LogHistogram rideTimes;
+    LogHistogram journeyTimes;
+    LogHistogram handlingCapacity;
+
+    std::vector<CarStats> cars;
+
+    /* Public methods */
+    void merge(const MetricsReport &);
+
+    double utilization(int carId) const;
+    double movingFraction(int carId) const;
+    double energyKWh() const;
+    double energyPerTripKWh() const;
+
+    void writeJson(std::ostream &) const;
+    void writeCsv(std::ostream &) const;
+};
+
+#endif /* METRICSREPORT_H */
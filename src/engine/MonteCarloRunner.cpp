@@ -0,0 +1,70 @@
+#include "MonteCarloRunner.h"
+
+#include <random>
+#include <vector>
+
+#include "MetricsReport.h"
+#include "SimBuilding.h"
+#include "SimMetrics.h"
+#include "TrafficGenerator.h"
+
+MonteCarloRunner::MonteCarloRunner(unsigned threadCount) : pool(threadCount) {}
+
+unsigned MonteCarloRunner::threadCount() const { return pool.threadCount(); }
+
+unsigned MonteCarloRunner::replicationSeed(unsigned baseSeed,
+                                           int replication) {
+    // Nearby base seeds and indices still give unrelated streams.
+    std::seed_seq mixer{baseSeed, unsigned(replication)};
+    unsigned seed;
+    mixer.generate(&seed, &seed + 1);
+    return seed;
+}
+
+MetricsReport MonteCarloRunner::runReplication(const Scenario &scenario,
+                                               unsigned seed) {
+    std::mt19937 rng(seed);
+
+    // Zoned cars start on floors they serve.
+    std::vector<int> initialFloorNums =
+        scenario.carConfigs.empty()
+            ? SimBuilding::randomInitialFloorNums(scenario.floorCount,
+                                                  scenario.elevatorCount, rng)
+            : SimBuilding::randomInitialFloorNums(scenario.floorCount,
+                                                  scenario.carConfigs, rng);
+    SimBuilding building(scenario.floorCount, scenario.elevatorCount,
+                         initialFloorNums, scenario.carConfigs);
+    building.setDispatchMode(scenario.dispatchMode);
+    building.setDispatchPolicy(scenario.dispatchPolicy);
+    building.setEnergyBudgetMs(scenario.energyBudgetMs);
+    building.setParkDelayMs(scenario.parkDelayMs);
+    building.setIdleParking(scenario.idleParking);
+
+    SimMetrics metrics(&building);
+    TrafficGenerator traffic(&building, rng());
+    traffic.setProfile(scenario.profile);
+    traffic.setRateSchedule(scenario.rates);
+    if (scenario.setup) scenario.setup(building, traffic);
+
+    traffic.start();
+    building.getScheduler().runUntil(scenario.durationMs);
+    return metrics.report();
+}
+
+MetricsReport MonteCarloRunner::run(const Scenario &scenario,
+                                    int replications, unsigned baseSeed) {
+    // One slot per replication, so tasks never share a report.
+    std::vector<MetricsReport> reports(replications);
+    for (int r_ind = 0; r_ind < replications; ++r_ind) {
+        MetricsReport *slot = &reports[r_ind];
+        unsigned seed = replicationSeed(baseSeed, r_ind);
+        pool.submit([&scenario, slot, seed]() {
+            *slot = runReplication(scenario, seed);
+        });
+    }
+    pool.wait();
+
+    MetricsReport merged;
+    for (const MetricsReport &report : reports) merged.merge(report);
+    return merged;
+}
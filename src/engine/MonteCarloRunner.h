@@ -0,0 +1,99 @@
+#ifndef MONTECARLORUNNER_H
+#define MONTECARLORUNNER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "CarConfig.h"
+#include "MetricsReport.h"
+#include "SimBuilding.h"
+#include "TrafficGenerator.h"
+#include "WorkStealingPool.h"
+
+/** Runs independent replications of a simulation in parallel.
+ *
+ * Each replication builds its own SimBuilding, TrafficGenerator and
+ * SimMetrics, and runs headless for the scenario's duration. Replications
+ * share nothing, so they run on a WorkStealingPool with one replication per
+ * task and scale with the number of cores. Every replication draws all its
+ * randomness (initial car floors, passenger traffic) from its own generator,
+ * seeded from the base seed and its index, so results are reproducible and
+ * independent of the thread count. Reports are merged in replication order.
+ *
+ * Data Members:
+ * + Scenario: struct
+ *      Simulation run by every replication.
+ *      - floorCount, elevatorCount: building size.
+ *      - carConfigs: settings of each car, by car ID. Empty uses defaults.
+ *      - dispatchMode: how hall calls are distributed among cars.
+ *      - dispatchPolicy: how cars pick their next floor, by name.
+ *      - energyBudgetMs: wait traded for energy, see SimBuilding.
+ *      - idleParking, parkDelayMs: parking of idle cars, see SimBuilding.
+ *      - profile, rates: passenger demand and arrival rate schedule.
+ *      - durationMs: simulated time each replication runs for.
+ *      - setup: optional, called on each replication's building and
+ *        generator before it starts, for settings not covered above. Runs on
+ *        worker threads, so must not touch shared state.
+ *
+ * - pool: WorkStealingPool
+ *      Worker threads running the replications.
+ *
+ * Class Methods:
+ * + threadCount(): unsigned
+ *      Number of worker threads.
+ * + run(Scenario, int, unsigned): MetricsReport
+ *      Runs replications of a scenario and returns their merged metrics.
+ *      Rethrows the first exception a replication threw.
+ * + runReplication(Scenario, unsigned): MetricsReport
+ *      Runs one replication with the given seed on the calling thread.
+ * + replicationSeed(unsigned, int): unsigned
+ *      Seed of a replication, mixed from the base seed and its index.
+ */
+class MonteCarloRunner {
+   public:
+    /* Public data structs */
+    typedef struct Scenario {
+        int floorCount;
+        int elevatorCount;
+        std::vector<CarConfig> carConfigs;
+        SimBuilding::DispatchMode dispatchMode;
+        std::string dispatchPolicy;
+        long long energyBudgetMs;
+        bool idleParking;
+        long long parkDelayMs;
+        TrafficGenerator::Profile profile;
+        std::vector<TrafficGenerator::RatePoint> rates;
+        long long durationMs;
+        std::function<void(SimBuilding &, TrafficGenerator &)> setup;
+
+        Scenario()
+            : floorCount(10),
+              elevatorCount(3),
+              dispatchMode(SimBuilding::DispatchMode::GROUP),
+              dispatchPolicy(SimBuilding::defaultDispatchPolicy),
+              energyBudgetMs(0),
+              idleParking(false),
+              parkDelayMs(SimBuilding::defaultParkDelayMs),
+              profile(TrafficGenerator::Profile::INTERFLOOR),
+              rates({{0, 10.0}}),
+              durationMs(60 * 60 * 1000) {}
+    } Scenario;
+
+    // 0 threads uses one per hardware thread.
+    explicit MonteCarloRunner(unsigned threadCount = 0);
+
+    /* Public methods */
+    unsigned threadCount() const;
+
+    MetricsReport run(const Scenario &, int replications, unsigned baseSeed);
+
+    static MetricsReport runReplication(const Scenario &, unsigned seed);
+    static unsigned replicationSeed(unsigned baseSeed, int replication);
+
+   private:
+    /* Private data members */
+    WorkStealingPool pool;
+};
+
+#endif /* MONTECARLORUNNER_H */
@@ -0,0 +1,38 @@
+#ifndef PASSENGER_H
+#define PASSENGER_H
+
+/** A passenger's trip through the building.
+ *
+ * Times are simulated milliseconds from the SimScheduler clock. Fields set
+ * later in the trip stay at -1 (or 0 for the car) until then.
+ *
+ * Data Members:
+ * + id: unsigned long long
+ *      Sequence number, unique within the generator that created it.
+ * + originFloorNum / destinationFloorNum: int
+ *      Floor the passenger starts from and travels to.
+ * + legFloorNum: int
+ *      Floor the passenger rides to in their current car: the destination,
+ *      or in a zoned building the transfer floor where they change cars.
+ * + massKg: int
+ *      Weight the passenger adds to a car's load.
+ * + arrivalMs: long long
+ *      Time the passenger arrived at their origin and pressed the hall call.
+ * + boardedMs: long long
+ *      Time a car stopped at the origin and the passenger boarded it.
+ * + carId: int
+ *      Car the passenger is riding. Under destination dispatch, also the car
+ *      assigned to them while they wait, 0 while they wait for one.
+ */
+typedef struct Passenger {
+    unsigned long long id;
+    int originFloorNum;
+    int destinationFloorNum;
+    int legFloorNum;
+    int massKg;
+    long long arrivalMs;
+    long long boardedMs;
+    int carId;
+} Passenger;
+
+#endif /* PASSENGER_H */
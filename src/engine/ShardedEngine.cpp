@@ -0,0 +1,316 @@
+#include "ShardedEngine.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "BuildingConfig.h"
+#include "CarConfig.h"
+#include "CarSnapshot.h"
+#include "FloorBitset.h"
+#include "SimBuilding.h"
+#include "SimElevator.h"
+#include "SimInput.h"
+#include "SimShard.h"
+
+namespace {
+
+// Whether a car serving the floors goes on from the floor in the direction,
+// either direction for Direction::NONE.
+bool goesOn(const FloorBitset &floors, int floorNum, Direction dir) {
+    if (!floors.test(floorNum)) return false;
+    bool up = floors.nextAtOrAbove(floorNum + 1) != FloorBitset::NO_FLOOR;
+    bool down = floors.nextAtOrBelow(floorNum - 1) != FloorBitset::NO_FLOOR;
+
+    switch (dir) {
+        case Direction::UP:
+            return up;
+        case Direction::DOWN:
+            return down;
+        case Direction::NONE:
+        default:
+            return up || down;
+    }
+}
+
+}  // namespace
+
+ShardedEngine::ShardedEngine(const BuildingConfig &config,
+                             const std::vector<int> &initialFloorNums,
+                             int shardCount, double timeScale)
+    : floorCount(config.floorCount),
+      elevatorCount(config.elevatorCount),
+      carShards(config.elevatorCount, 0),
+      cars(config.elevatorCount),
+      servedFloors(),
+      bankFloors(),
+      transferFloors(),
+      shardCalls(shardCount > 0 ? shardCount : 0),
+      upHolders(config.floorCount, 0),
+      downHolders(config.floorCount, 0),
+      timeMs(0) {
+    if (shardCount < 1) throw "ERROR: Building needs at least one shard";
+    if (shardCount > elevatorCount)
+        throw "ERROR: Building has fewer elevators than shards";
+    if (int(initialFloorNums.size()) != elevatorCount)
+        throw "ERROR: Initial floor count doesn't match elevator count";
+
+    const std::vector<CarConfig> carConfigs = config.carConfigs();
+
+    // Floors each car stops at, all of them unless it's zoned
+    for (const CarConfig &carConfig : carConfigs) {
+        FloorBitset floors(floorCount);
+        for (int floorNum : carConfig.servedFloorNums)
+            floors.set(floorNum, true);
+        if (carConfig.servedFloorNums.empty())
+            for (int floorNum = 1; floorNum <= floorCount; ++floorNum)
+                floors.set(floorNum, true);
+        servedFloors.push_back(floors);
+
+        // Banks in the order of their lowest car ID, as SimBuilding groups them
+        if (std::find(bankFloors.begin(), bankFloors.end(), floors) ==
+            bankFloors.end())
+            bankFloors.push_back(floors);
+    }
+    transferFloors = SimBuilding::transferFloorsOf(bankFloors);
+
+    /* Give each shard a contiguous block of cars */
+    for (int s_ind = 0; s_ind < shardCount; ++s_ind) {
+        int first = s_ind * elevatorCount / shardCount;
+        int last = (s_ind + 1) * elevatorCount / shardCount;
+
+        std::vector<int> floorNums(initialFloorNums.begin() + first,
+                                   initialFloorNums.begin() + last);
+        std::vector<CarConfig> configs(carConfigs.begin() + first,
+                                       carConfigs.begin() + last);
+        shards.emplace_back(new SimShard(floorCount, first + 1, floorNums,
+                                         configs, config.dispatchMode,
+                                         config.energyBudgetMs,
+                                         config.idleParking,
+                                         config.parkDelayMs,
+                                         config.dispatchPolicy, timeScale));
+
+        for (int e_ind = first; e_ind < last; ++e_ind) carShards[e_ind] = s_ind;
+    }
+
+    // Present the initial snapshots right away.
+    std::vector<std::pair<int, Direction>> changedCalls;
+    for (int s_ind = 0; s_ind < shardCount; ++s_ind)
+        takeSnapshot(s_ind, changedCalls);
+}
+
+int ShardedEngine::shardCount() const { return int(shards.size()); }
+
+void ShardedEngine::start() {
+    for (auto &shard : shards) shard->start();
+}
+
+void ShardedEngine::stop() {
+    for (auto &shard : shards) shard->stop();
+}
+
+bool ShardedEngine::post(const SimInput &input) {
+    switch (input.kind) {
+        case SimInput::Kind::HALL_CALL:
+            if (input.active) {
+                if (input.floorNum < 1 || input.floorNum > floorCount)
+                    throw "ERROR: Floor number trying to be accessed doesn't "
+                          "exist";
+                int shardIndex = routeHallCall(input.floorNum, input.dir);
+                if (shardIndex < 0)
+                    throw "ERROR: Floor has no hall button in that direction";
+                return shards[shardIndex]->post(input);
+            }
+            break;  // Cleared wherever it is held
+        case SimInput::Kind::DESTINATION_CALL: {
+            if (input.floorNum < 1 || input.floorNum > floorCount ||
+                input.destinationFloorNum < 1 ||
+                input.destinationFloorNum > floorCount)
+                throw "ERROR: Floor number trying to be accessed doesn't exist";
+            if (input.floorNum == input.destinationFloorNum)
+                throw "ERROR: Destination is the floor the request comes from";
+
+            // No shard may hold every bank of the trip: route the first leg
+            // over all banks here, the passenger asks again at the transfer
+            // floor.
+            int toFloorNum =
+                legFloorNum(input.floorNum, input.destinationFloorNum);
+            if (toFloorNum == FloorBitset::NO_FLOOR)
+                throw "ERROR: No elevators connect those floors";
+
+            Direction dir = (toFloorNum > input.floorNum) ? Direction::UP
+                                                          : Direction::DOWN;
+            int shardIndex = routeHallCall(input.floorNum, dir, toFloorNum);
+            if (shardIndex < 0)
+                throw "ERROR: No elevators connect those floors";
+            return shards[shardIndex]->post(
+                SimInput::destinationCall(input.floorNum, toFloorNum));
+        }
+        case SimInput::Kind::BUILDING_FIRE:
+        case SimInput::Kind::BUILDING_POWER_OUT:
+            break;
+        default:
+            if (input.carId < 1 || input.carId > elevatorCount)
+                throw "ERROR: Car ID trying to be accessed doesn't exist";
+            return shards[carShards[input.carId - 1]]->post(input);
+    }
+
+    bool posted = true;
+    for (auto &shard : shards) posted = shard->post(input) && posted;
+    return posted;
+}
+
+bool ShardedEngine::poll(
+    std::vector<int> &changedCarIds,
+    std::vector<std::pair<int, Direction>> &changedCalls) {
+    changedCarIds.clear();
+    changedCalls.clear();
+
+    bool taken = false;
+    for (int s_ind = 0; s_ind < shardCount(); ++s_ind) {
+        if (!takeSnapshot(s_ind, changedCalls)) continue;
+
+        const SimShard &shard = *shards[s_ind];
+        for (int c_ind = 0; c_ind < shard.carCount; ++c_ind)
+            changedCarIds.push_back(shard.firstCarId + c_ind);
+        taken = true;
+    }
+    return taken;
+}
+
+bool ShardedEngine::takeLog(LogRecord &record) {
+    for (auto &shard : shards)
+        if (shard->takeLog(record)) return true;
+    return false;
+}
+
+const CarSnapshot &ShardedEngine::getCar(int carId) const {
+    if (carId < 1 || carId > elevatorCount)
+        throw "ERROR: Car ID trying to be accessed doesn't exist";
+    return cars[carId - 1];
+}
+
+bool ShardedEngine::hasHallCall(int floorNum, Direction dir) const {
+    if (floorNum < 1 || floorNum > floorCount)
+        throw "ERROR: Floor number trying to be accessed doesn't exist";
+
+    switch (dir) {
+        case Direction::UP:
+            return upHolders[floorNum - 1] > 0;
+        case Direction::DOWN:
+            return downHolders[floorNum - 1] > 0;
+        case Direction::NONE:
+        default:
+            return upHolders[floorNum - 1] > 0 ||
+                   downHolders[floorNum - 1] > 0;
+    }
+}
+
+bool ShardedEngine::servesFloor(int carId, int floorNum) const {
+    if (carId < 1 || carId > elevatorCount)
+        throw "ERROR: Car ID trying to be accessed doesn't exist";
+    return servedFloors[carId - 1].test(floorNum);
+}
+
+bool ShardedEngine::hasHallButton(int floorNum, Direction dir) const {
+    if (floorNum < 1 || floorNum > floorCount)
+        throw "ERROR: Floor number trying to be accessed doesn't exist";
+
+    for (const FloorBitset &floors : servedFloors)
+        if (goesOn(floors, floorNum, dir)) return true;
+    return false;
+}
+
+int ShardedEngine::legFloorNum(int originFloorNum,
+                               int destinationFloorNum) const {
+    if (originFloorNum < 1 || originFloorNum > floorCount ||
+        destinationFloorNum < 1 || destinationFloorNum > floorCount)
+        throw "ERROR: Floor number trying to be accessed doesn't exist";
+    return SimBuilding::legFloorNum(bankFloors, transferFloors,
+                                    originFloorNum, destinationFloorNum);
+}
+
+long long ShardedEngine::now() const { return timeMs; }
+
+int ShardedEngine::routeHallCall(int floorNum, Direction dir,
+                                 int destinationFloorNum) const {
+    // A shard already holding the call keeps it, if it has a car stopping
+    // at the destination too.
+    for (int s_ind = 0; s_ind < shardCount(); ++s_ind) {
+        const std::vector<int> &held = (dir == Direction::UP)
+                                           ? shardCalls[s_ind].first
+                                           : shardCalls[s_ind].second;
+        if (!std::binary_search(held.begin(), held.end(), floorNum))
+            continue;
+        if (destinationFloorNum == 0) return s_ind;
+
+        const SimShard &shard = *shards[s_ind];
+        for (int c_ind = 0; c_ind < shard.carCount; ++c_ind) {
+            const FloorBitset &floors =
+                servedFloors[shard.firstCarId + c_ind - 1];
+            if (goesOn(floors, floorNum, dir) &&
+                floors.test(destinationFloorNum))
+                return s_ind;
+        }
+    }
+
+    // Otherwise the shard of the nearest car that stops at the floor, and
+    // at the destination if there is one, preferring cars able to take hall
+    // calls. With none able, that shard holds the call until one is.
+    int bestCarId = 0;
+    int bestDistance = 0;
+    bool bestAvailable = false;
+    for (const CarSnapshot &car : cars) {
+        const FloorBitset &floors = servedFloors[car.carId - 1];
+        if (!goesOn(floors, floorNum, dir)) continue;
+        if (destinationFloorNum != 0 && !floors.test(destinationFloorNum))
+            continue;
+
+        bool available = car.emergency == SimElevator::EmergencyState::NONE ||
+                         car.emergency == SimElevator::EmergencyState::HELP;
+        int distance = std::abs(car.floorNum - floorNum);
+        if (bestCarId == 0 || (available && !bestAvailable) ||
+            (available == bestAvailable && distance < bestDistance)) {
+            bestCarId = car.carId;
+            bestDistance = distance;
+            bestAvailable = available;
+        }
+    }
+    return bestCarId == 0 ? -1 : carShards[bestCarId - 1];
+}
+
+bool ShardedEngine::takeSnapshot(
+    int shardIndex, std::vector<std::pair<int, Direction>> &changedCalls) {
+    SimShard::Snapshot snapshot;
+    if (!shards[shardIndex]->takeSnapshot(snapshot)) return false;
+
+    if (snapshot.timeMs > timeMs) timeMs = snapshot.timeMs;
+    for (CarSnapshot &car : snapshot.cars)
+        cars[car.carId - 1] = std::move(car);
+
+    /* Update holder counts from the calls the shard gained and lost */
+    auto merge = [&](std::vector<int> &held, std::vector<int> &now,
+                     std::vector<int> &holders, Direction dir) {
+        std::vector<int> gained, lost;
+        std::set_difference(now.begin(), now.end(), held.begin(), held.end(),
+                            std::back_inserter(gained));
+        std::set_difference(held.begin(), held.end(), now.begin(), now.end(),
+                            std::back_inserter(lost));
+
+        for (int floorNum : gained)
+            if (holders[floorNum - 1]++ == 0)
+                changedCalls.emplace_back(floorNum, dir);
+        for (int floorNum : lost)
+            if (--holders[floorNum - 1] == 0)
+                changedCalls.emplace_back(floorNum, dir);
+        held.swap(now);
+    };
+    merge(shardCalls[shardIndex].first, snapshot.upCalls, upHolders,
+          Direction::UP);
+    merge(shardCalls[shardIndex].second, snapshot.downCalls, downHolders,
+          Direction::DOWN);
+    return true;
+}
@@ -0,0 +1,163 @@
+#ifndef SHARDEDENGINE_H
+#define SHARDEDENGINE_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "CarSnapshot.h"
+#include "Direction.h"
+#include "FloorBitset.h"
+#include "LogRecord.h"
+#include "SimInput.h"
+#include "SimShard.h"
+
+// Forward declarations
+class BuildingConfig;
+
+/** A building whose cars are split over several worker threads.
+ *
+ * Splits the configured cars into contiguous groups, one SimShard each, so
+ * the simulation of large buildings no longer runs on the thread presenting
+ * it. Each shard is a group of cars with its own group dispatch; a new hall
+ * call is handed to the shard whose nearest available car stopping at the
+ * floor is closest to it, and the shard assigns it among its cars. Zoned
+ * cars (see CarConfig::servedFloorNums) form banks within their shard. A
+ * destination request needing a change of car is routed over the banks of
+ * every shard, and its first leg handed to a shard with a car serving it;
+ * the passenger asks again at the transfer floor, as in SimBuilding.
+ *
+ * The owner thread (the GUI thread) talks to the shards only through their
+ * queues. poll() takes the newest snapshot of each shard into a merged view
+ * of the building, which stays the same until the next poll, so the owner
+ * always presents one consistent state. Inputs are not journaled: the
+ * shards' clocks aren't synchronized, so a sharded run can't be replayed
+ * exactly.
+ *
+ * Data Members:
+ * + floorCount / elevatorCount: int
+ *      Size of the building.
+ *
+ * - shards: std::vector<std::unique_ptr<SimShard>>
+ *      The shards, in car ID order.
+ * - carShards: std::vector<int>
+ *      Index of the shard running each car, indexed by car ID - 1.
+ * - cars: std::vector<CarSnapshot>
+ *      Latest state of each car, indexed by car ID - 1.
+ * - servedFloors: std::vector<FloorBitset>
+ *      Floors each car stops at, indexed by car ID - 1.
+ * - bankFloors: std::vector<FloorBitset>
+ * - transferFloors: std::vector<std::vector<int>>
+ *      Banks of the whole building and the transfer floors between them,
+ *      as in SimBuilding.
+ * - shardCalls: std::vector<std::pair<std::vector<int>, std::vector<int>>>
+ *      UP / DOWN hall calls each shard held in its latest snapshot.
+ * - upHolders / downHolders: std::vector<int>
+ *      Number of shards holding each floor's UP / DOWN call, indexed by
+ *      floor number - 1.
+ * - timeMs: long long
+ *      Simulated time of the newest snapshot taken.
+ *
+ * Class Methods:
+ * + shardCount(): int
+ *      Returns the number of shards.
+ * + start(): void
+ * + stop(): void
+ *      Start or stop every shard's worker thread.
+ *
+ * + post(const SimInput &): bool
+ *      Routes an input: car inputs to the car's shard, building emergencies
+ *      and cleared hall calls to every shard, new hall calls and destination
+ *      requests to the shard with the closest car stopping at the floor,
+ *      available cars first; with none available, that shard holds the call
+ *      until a car is. Destination requests are for their first leg, see
+ *      SimBuilding::legFloorNum().
+ *      Returns false if a shard's inbox was full and the input was dropped
+ *      there. Throws for floors that don't exist, a floor without the hall
+ *      button, or a request for floors no banks connect.
+ * + poll(std::vector<int> &, std::vector<std::pair<int, Direction>> &):
+ *   bool
+ *      Takes the newest snapshot of every shard. Fills the IDs of the cars
+ *      in shards that sent one, and the hall calls that changed, and returns
+ *      true if any shard sent one.
+ * + takeLog(LogRecord &): bool
+ *      Moves out a message of any shard, or returns false if there is none.
+ *
+ * + getCar(int): const CarSnapshot &
+ *      Returns the latest state of a car by ID.
+ * + hasHallCall(int, Direction): bool
+ *      Returns true if a shard holds the floor's hall call in the direction,
+ *      either direction for Direction::NONE.
+ * + servesFloor(int, int): bool
+ *      Returns true if a car (by ID) stops at the floor.
+ * + hasHallButton(int, Direction): bool
+ *      Returns true if a car stopping at the floor goes on from it in the
+ *      direction, either direction for Direction::NONE.
+ * + legFloorNum(int, int): int
+ *      Returns the floor a passenger going from one floor to another rides
+ *      to in their first car, over the banks of every shard, see
+ *      SimBuilding::legFloorNum(). FloorBitset::NO_FLOOR if no banks
+ *      connect the floors.
+ * + now(): long long
+ *      Returns the simulated time of the newest snapshot.
+ *
+ * - routeHallCall(int, Direction, int): int
+ *      Returns the index of the shard a new hall call goes to, or a request
+ *      for the given destination floor (0 for none): one with a car stopping
+ *      at both floors. Returns -1 if no car does.
+ * - takeSnapshot(int, std::vector<std::pair<int, Direction>> &): bool
+ *      Merges a shard's newest snapshot, collecting the hall calls it
+ *      changed. Returns false if none arrived since the last one.
+ */
+class ShardedEngine {
+   public:
+    ShardedEngine(const BuildingConfig &,
+                  const std::vector<int> &initialFloorNums, int shardCount,
+                  double timeScale = 1.0);
+
+    ShardedEngine(const ShardedEngine &) = delete;
+    ShardedEngine &operator=(const ShardedEngine &) = delete;
+
+    /* Public data members */
+    const int floorCount;
+    const int elevatorCount;
+
+    /* Public methods */
+    int shardCount() const;
+    void start();
+    void stop();
+
+    bool post(const SimInput &);
+    bool poll(std::vector<int> &changedCarIds,
+              std::vector<std::pair<int, Direction>> &changedCalls);
+    bool takeLog(LogRecord &);
+
+    const CarSnapshot &getCar(int carId) const;
+    bool hasHallCall(int floorNum, Direction) const;
+    bool servesFloor(int carId, int floorNum) const;
+    bool hasHallButton(int floorNum, Direction) const;
+    int legFloorNum(int originFloorNum, int destinationFloorNum) const;
+    long long now() const;
+
+   private:
+    /* Private data members */
+    std::vector<std::unique_ptr<SimShard>> shards;
+    std::vector<int> carShards;
+
+    std::vector<CarSnapshot> cars;
+    std::vector<FloorBitset> servedFloors;
+    std::vector<FloorBitset> bankFloors;
+    std::vector<std::vector<int>> transferFloors;
+    std::vector<std::pair<std::vector<int>, std::vector<int>>> shardCalls;
+    std::vector<int> upHolders;
+    std::vector<int> downHolders;
+    long long timeMs;
+
+    /* Private methods */
+    int routeHallCall(int floorNum, Direction,
+                      int destinationFloorNum = 0) const;
+    bool takeSnapshot(int shardIndex,
+                      std::vector<std::pair<int, Direction>> &changedCalls);
+};
+
+#endif /* SHARDEDENGINE_H */
@@ -0,0 +1,1334 @@
+#include "SimBuilding.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "DemandModel.h"
+#include "DispatchPolicy.h"
+#include "EnergyModel.h"
+#include "FleetState.h"
+#include "FlightTable.h"
+#include "FloorBitset.h"
+#include "SimElevator.h"
+
+namespace {
+
+typedef SimElevator::MovementState MovementState;
+typedef SimElevator::DoorState DoorState;
+
+// Arrival estimate from a car's state, whether read from the car object or
+// from the fleet state.
+long long arrivalMs(int pos, MovementState movement, DoorState door,
+                    const FlightTable &flights, int doorSpeedMs,
+                    int doorWaitMs, const FloorBitset &carCalls,
+                    const FloorBitset &stops, int floorNum, int floorCount) {
+    const long long doorCycleMs = 2 * doorSpeedMs + doorWaitMs;
+
+    // Committed stops strictly between two floors
+    auto stopsBetween = [&carCalls, &stops](int from, int to) {
+        int low = std::min(from, to) + 1;
+        int high = std::max(from, to) - 1;
+        if (low > high) return 0;
+        return carCalls.countBetween(low, high) + stops.countBetween(low, high);
+    };
+
+    // Next committed stop from one floor towards another, or that floor.
+    auto nextStop = [&carCalls, &stops](int at, int to) {
+        int next;
+        if (to > at) {
+            int car = carCalls.nextAtOrAbove(at + 1);
+            int hall = stops.nextAtOrAbove(at + 1);
+            next = (car == FloorBitset::NO_FLOOR)    ? hall
+                   : (hall == FloorBitset::NO_FLOOR) ? car
+                                                     : std::min(car, hall);
+            return (next == FloorBitset::NO_FLOOR || next > to) ? to : next;
+        }
+        next = std::max(carCalls.nextAtOrBelow(at - 1),
+                        stops.nextAtOrBelow(at - 1));
+        return (next == FloorBitset::NO_FLOOR || next < to) ? to : next;
+    };
+
+    // Flight time between two floors. Kinematic cars fly each leg between
+    // committed stops as its own run; without a motion profile, the time
+    // doesn't depend on where the car stops.
+    auto travelMs = [&](int from, int to) {
+        if (!flights.isKinematic())
+            return flights.flightMs(std::abs(to - from));
+
+        long long totalMs = 0;
+        for (int at = from; at != to;) {
+            int next = nextStop(at, to);
+            totalMs += flights.flightMs(std::abs(next - at));
+            at = next;
+        }
+        return totalMs;
+    };
+
+    // Doors must finish their current cycle before the car can leave.
+    long long etaMs = 0;
+    switch (door) {
+        case DoorState::OPENING:
+            etaMs = doorCycleMs;
+            break;
+        case DoorState::OPEN:
+            etaMs = doorWaitMs + doorSpeedMs;
+            break;
+        case DoorState::CLOSING:
+            etaMs = doorSpeedMs;
+            break;
+        case DoorState::CLOSED:
+        default:
+            break;
+    }
+
+    long long flightMs;
+    int committedStops;
+
+    bool goingUpAway = movement == MovementState::UPWARDS && floorNum < pos;
+    bool goingDownAway =
+        movement == MovementState::DOWNWARDS && floorNum > pos;
+
+    if (goingUpAway || goingDownAway) {
+        // Finish the run to the furthest committed stop, then turn around.
+        // A car still flagged as moving can be at the end of the shaft.
+        int turn;
+        if (goingUpAway) {
+            turn = std::max(carCalls.last(), stops.last());
+            turn = std::min(std::max(turn, pos + 1), floorCount);
+        } else {
+            int lowest = carCalls.first();
+            if (lowest == FloorBitset::NO_FLOOR ||
+                (stops.first() != FloorBitset::NO_FLOOR &&
+                 stops.first() < lowest))
+                lowest = stops.first();
+            turn = (lowest == FloorBitset::NO_FLOOR) ? pos - 1
+                                                     : std::min(lowest, pos - 1);
+            turn = std::max(turn, 1);
+        }
+        bool turnIsStop = carCalls.test(turn) || stops.test(turn);
+
+        flightMs = travelMs(pos, turn) + travelMs(turn, floorNum);
+        committedStops = stopsBetween(pos, turn) + (turnIsStop ? 1 : 0) +
+                         stopsBetween(turn, floorNum);
+    } else {
+        flightMs = travelMs(pos, floorNum);
+        committedStops = stopsBetween(pos, floorNum);
+    }
+
+    return etaMs + flightMs + committedStops * doorCycleMs;
+}
+
+}  // namespace
+
+const long long SimBuilding::defaultParkDelayMs;
+const char *const SimBuilding::defaultDispatchPolicy = "nearest-floor";
+
+// Dispatch policies by name. Journals store the index: append only.
+const SimBuilding::PolicyEntry SimBuilding::policies[] = {
+    {"nearest-floor", &SimBuilding::moveDirtyCars<NearestFloorPolicy>},
+    {"collective", &SimBuilding::moveDirtyCars<CollectivePolicy>}};
+
+SimBuilding::SimBuilding(int f, int e, const std::vector<int> &initialFloorNums,
+                         const std::vector<CarConfig> &carConfigs)
+    : floorCount(f),
+      elevatorCount(e),
+      upCalls(f),
+      downCalls(f),
+      onFire(false),
+      powerOut(false),
+      dirtyCars(e, false),
+      dirtyCount(0),
+      dispatchPending(false),
+      dispatching(false),
+      policy(&policies[0]),
+      dispatchMode(DispatchMode::GROUP),
+      energyBudgetMs(0),
+      assignedStops(e, FloorBitset(f)),
+      destinationCalls(e),
+      fleet(e),
+      parkDelayMs(defaultParkDelayMs),
+      idleCars(e, false),
+      idleGenerations(e, 0) {
+    if (floorCount < 1 || elevatorCount < 1)
+        throw "ERROR: Building needs at least one floor and one elevator";
+    if (int(initialFloorNums.size()) != elevatorCount)
+        throw "ERROR: Initial floor count doesn't match elevator count";
+    if (!carConfigs.empty() && int(carConfigs.size()) != elevatorCount)
+        throw "ERROR: Car config count doesn't match elevator count";
+
+    /* Initialize elevators */
+    for (int e_ind = 0; e_ind < elevatorCount; ++e_ind) {
+        validateFloorNum(initialFloorNums[e_ind]);
+        cars.emplace_back(new SimElevator(
+            e_ind + 1, initialFloorNums[e_ind], this,
+            carConfigs.empty() ? CarConfig() : carConfigs[e_ind]));
+        fleet.update(*cars.back());
+    }
+
+    groupBanks();
+}
+
+SimBuilding::~SimBuilding() = default;
+
+std::vector<int> SimBuilding::randomInitialFloorNums(int floorCount,
+                                                     int elevatorCount,
+                                                     std::mt19937 &rng) {
+    std::uniform_int_distribution<int> floorDist(1, floorCount);
+    std::vector<int> floorNums;
+
+    // Generate random starting floor for each elevator
+    for (int e_ind = 0; e_ind < elevatorCount; ++e_ind)
+        floorNums.push_back(floorDist(rng));
+
+    return floorNums;
+}
+
+std::vector<int> SimBuilding::randomInitialFloorNums(
+    int floorCount, const std::vector<CarConfig> &carConfigs,
+    std::mt19937 &rng) {
+    std::uniform_int_distribution<int> floorDist(1, floorCount);
+    std::vector<int> floorNums;
+
+    // Zoned cars start on one of their own floors.
+    for (const CarConfig &config : carConfigs) {
+        const std::vector<int> &served = config.servedFloorNums;
+        if (served.empty()) {
+            floorNums.push_back(floorDist(rng));
+        } else {
+            std::uniform_int_distribution<size_t> servedDist(
+                0, served.size() - 1);
+            floorNums.push_back(served[servedDist(rng)]);
+        }
+    }
+
+    return floorNums;
+}
+
+bool SimBuilding::isFloorNum(int floorNum) const {
+    return (floorNum >= 1 && floorNum <= floorCount);
+}
+bool SimBuilding::isCarId(int carId) const {
+    return (carId >= 1 && carId <= elevatorCount);
+}
+void SimBuilding::validateFloorNum(int floorNum) const {
+    if (!isFloorNum(floorNum))
+        throw "ERROR: Floor number trying to be accessed doesn't exist";
+}
+void SimBuilding::validateBankNum(int bankNum) const {
+    if (bankNum < 1 || bankNum > bankCount())
+        throw "ERROR: Bank trying to be accessed doesn't exist";
+}
+
+void SimBuilding::groupBanks() {
+    // Banks in the order of their lowest car ID.
+    for (int e_ind = 0; e_ind < elevatorCount; ++e_ind) {
+        const FloorBitset &served = cars[e_ind]->getServedFloors();
+
+        int bankNum = 0;
+        for (int b_ind = 0; b_ind < int(bankFloors.size()); ++b_ind)
+            if (bankFloors[b_ind] == served) bankNum = b_ind + 1;
+        if (bankNum == 0) {
+            bankFloors.push_back(served);
+            bankNum = int(bankFloors.size());
+        }
+        carBankNums.push_back(bankNum);
+    }
+
+    int banks = bankCount();
+    bankUpCalls.assign(banks, FloorBitset(floorCount));
+    bankDownCalls.assign(banks, FloorBitset(floorCount));
+    upAssignees.assign(banks, std::vector<int>(floorCount, 0));
+    downAssignees.assign(banks, std::vector<int>(floorCount, 0));
+    pendingCalls.resize(banks);
+
+    transferFloors = transferFloorsOf(bankFloors);
+}
+
+std::vector<std::vector<int>> SimBuilding::transferFloorsOf(
+    const std::vector<FloorBitset> &bankFloors) {
+    int banks = int(bankFloors.size());
+    std::vector<std::vector<int>> transferFloors(banks * banks);
+    for (int from = 0; from < banks; ++from)
+        for (int to = 0; to < banks; ++to)
+            if (from != to)
+                for (int floorNum : bankFloors[from].toVector())
+                    if (bankFloors[to].test(floorNum))
+                        transferFloors[from * banks + to].push_back(floorNum);
+    return transferFloors;
+}
+
+int SimBuilding::bankCount() const { return int(bankFloors.size()); }
+
+int SimBuilding::getBankNum(int carId) const {
+    if (!isCarId(carId))
+        throw "ERROR: Elevator trying to be accessed doesn't exist";
+    return carBankNums[carId - 1];
+}
+
+const FloorBitset &SimBuilding::getBankFloors(int bankNum) const {
+    validateBankNum(bankNum);
+    return bankFloors[bankNum - 1];
+}
+
+int SimBuilding::legFloorNum(int originFloorNum,
+                             int destinationFloorNum) const {
+    validateFloorNum(originFloorNum);
+    validateFloorNum(destinationFloorNum);
+
+    return legFloorNum(bankFloors, transferFloors, originFloorNum,
+                       destinationFloorNum);
+}
+
+int SimBuilding::legFloorNum(
+    const std::vector<FloorBitset> &bankFloors,
+    const std::vector<std::vector<int>> &transferFloors, int originFloorNum,
+    int destinationFloorNum) {
+    int banks = int(bankFloors.size());
+    for (const FloorBitset &floors : bankFloors)
+        if (floors.test(originFloorNum) && floors.test(destinationFloorNum))
+            return destinationFloorNum;
+
+    // Changes of car each bank is from the destination, -1 if unreachable.
+    // Banks are few, a breadth-first search over them is cheap.
+    std::vector<int> changes(banks, -1);
+    std::vector<int> frontier;
+    for (int b_ind = 0; b_ind < banks; ++b_ind) {
+        if (!bankFloors[b_ind].test(destinationFloorNum)) continue;
+        changes[b_ind] = 0;
+        frontier.push_back(b_ind);
+    }
+    while (!frontier.empty()) {
+        std::vector<int> next;
+        for (int to : frontier) {
+            for (int from = 0; from < banks; ++from) {
+                if (changes[from] >= 0 ||
+                    transferFloors[from * banks + to].empty())
+                    continue;
+                changes[from] = changes[to] + 1;
+                next.push_back(from);
+            }
+        }
+        frontier.swap(next);
+    }
+
+    // Fewest changes first, then the least detour, then the lowest floor.
+    int bestFloorNum = FloorBitset::NO_FLOOR;
+    int bestChanges = 0;
+    int bestDetour = 0;
+    for (int from = 0; from < banks; ++from) {
+        if (changes[from] < 1 || !bankFloors[from].test(originFloorNum))
+            continue;
+
+        for (int to = 0; to < banks; ++to) {
+            if (changes[to] != changes[from] - 1) continue;
+
+            for (int floorNum : transferFloors[from * banks + to]) {
+                if (floorNum == originFloorNum) continue;
+                int detour = std::abs(floorNum - originFloorNum) +
+                             std::abs(destinationFloorNum - floorNum);
+
+                if (bestFloorNum == FloorBitset::NO_FLOOR ||
+                    changes[from] < bestChanges ||
+                    (changes[from] == bestChanges &&
+                     (detour < bestDetour ||
+                      (detour == bestDetour && floorNum < bestFloorNum)))) {
+                    bestFloorNum = floorNum;
+                    bestChanges = changes[from];
+                    bestDetour = detour;
+                }
+            }
+        }
+    }
+    return bestFloorNum;
+}
+
+bool SimBuilding::hasHallButton(int floorNum, Direction dir,
+                                int bankNum) const {
+    validateFloorNum(floorNum);
+
+    if (bankNum == 0) {
+        for (int b_num = 1; b_num <= bankCount(); ++b_num)
+            if (hasHallButton(floorNum, dir, b_num)) return true;
+        return false;
+    }
+    validateBankNum(bankNum);
+
+    // A button towards each direction the bank goes on from the floor.
+    const FloorBitset &floors = bankFloors[bankNum - 1];
+    if (!floors.test(floorNum)) return false;
+    bool up = floorNum < floorCount &&
+              floors.nextAtOrAbove(floorNum + 1) != FloorBitset::NO_FLOOR;
+    bool down = floorNum > 1 &&
+                floors.nextAtOrBelow(floorNum - 1) != FloorBitset::NO_FLOOR;
+
+    switch (dir) {
+        case Direction::UP:
+            return up;
+        case Direction::DOWN:
+            return down;
+        case Direction::NONE:
+        default:
+            return up || down;
+    }
+}
+
+bool SimBuilding::hasHallCall(int floorNum, Direction dir,
+                              int bankNum) const {
+    validateFloorNum(floorNum);
+    if (bankNum != 0) validateBankNum(bankNum);
+
+    const FloorBitset &up = bankNum ? bankUpCalls[bankNum - 1] : upCalls;
+    const FloorBitset &down =
+        bankNum ? bankDownCalls[bankNum - 1] : downCalls;
+
+    switch (dir) {
+        case Direction::UP:
+            return up.test(floorNum);
+        case Direction::DOWN:
+            return down.test(floorNum);
+        case Direction::NONE:
+        default:
+            return up.test(floorNum) || down.test(floorNum);
+    }
+}
+
+void SimBuilding::setHallCall(int floorNum, Direction dir, bool active,
+                              int bankNum) {
+    validateFloorNum(floorNum);
+    if (bankNum != 0) validateBankNum(bankNum);
+
+    // No UP button on the top floor a bank serves, no DOWN button on the
+    // bottom one.
+    if (dir == Direction::NONE || !hasHallButton(floorNum, dir, bankNum))
+        throw "ERROR: Floor has no hall button in that direction";
+
+    if (bankNum != 0) {
+        setBankHallCall(floorNum, dir, active, bankNum);
+        return;
+    }
+    for (int b_num = 1; b_num <= bankCount(); ++b_num)
+        if (hasHallButton(floorNum, dir, b_num))
+            setBankHallCall(floorNum, dir, active, b_num);
+}
+
+void SimBuilding::setBankHallCall(int floorNum, Direction dir, bool active,
+                                  int bankNum) {
+    bool up = dir == Direction::UP;
+    FloorBitset &calls = (up ? bankUpCalls : bankDownCalls)[bankNum - 1];
+    if (!calls.set(floorNum, active)) return;
+    if (active && demand) demand->record(scheduler.now(), floorNum);
+
+    // Hall call lamps show a call in any bank.
+    bool anyActive = active;
+    for (const FloorBitset &bankCalls : (up ? bankUpCalls : bankDownCalls))
+        anyActive = anyActive || bankCalls.test(floorNum);
+
+    if ((up ? upCalls : downCalls).set(floorNum, anyActive)) {
+        if (hooks.hallCallChanged)
+            hooks.hallCallChanged(floorNum, dir, anyActive);
+        for (SimObserver *observer : observers)
+            observer->hallCallChanged(floorNum, dir, anyActive);
+    }
+
+    if (dispatchMode != DispatchMode::NEAREST_CALL) {
+        // Only the car assigned to the call is concerned.
+        if (active)
+            pendingCalls[bankNum - 1].emplace_back(floorNum, dir);
+        else
+            setAssignee(floorNum, dir, 0, bankNum);
+
+        if (hooks.buildingDataChanged) hooks.buildingDataChanged();
+        scheduleDispatch();
+    } else {
+        // Floor state changes mean building data has changed
+        buildingDataChanged();
+    }
+}
+
+void SimBuilding::pressLegHallCalls(int originFloorNum, int legFloorNum) {
+    Direction dir =
+        legFloorNum > originFloorNum ? Direction::UP : Direction::DOWN;
+
+    for (int b_num = 1; b_num <= bankCount(); ++b_num) {
+        const FloorBitset &floors = bankFloors[b_num - 1];
+        if (floors.test(originFloorNum) && floors.test(legFloorNum))
+            setBankHallCall(originFloorNum, dir, true, b_num);
+    }
+}
+
+const std::vector<int> SimBuilding::getQueuedFloors(Direction dir,
+                                                    int bankNum) const {
+    if (bankNum != 0) validateBankNum(bankNum);
+
+    const FloorBitset &upFloors =
+        bankNum ? bankUpCalls[bankNum - 1] : upCalls;
+    const FloorBitset &downFloors =
+        bankNum ? bankDownCalls[bankNum - 1] : downCalls;
+
+    switch (dir) {
+        case Direction::UP:
+            return upFloors.toVector();
+        case Direction::DOWN:
+            return downFloors.toVector();
+        case Direction::NONE:
+        default:
+            break;
+    }
+
+    // Both directions: merge the two ascending lists without duplicates.
+    const std::vector<int> up = upFloors.toVector();
+    const std::vector<int> down = downFloors.toVector();
+
+    std::vector<int> matchingFloors;
+    matchingFloors.reserve(up.size() + down.size());
+    std::set_union(up.begin(), up.end(), down.begin(), down.end(),
+                   std::back_inserter(matchingFloors));
+
+    // Return ascending list of all matching floor numbers.
+    return matchingFloors;
+}
+
+int SimBuilding::nearestHallCall(int floorNum, Direction searchDir,
+                                 Direction callDir, int bankNum) const {
+    if (bankNum != 0) validateBankNum(bankNum);
+
+    const FloorBitset &upFloors =
+        bankNum ? bankUpCalls[bankNum - 1] : upCalls;
+    const FloorBitset &downFloors =
+        bankNum ? bankDownCalls[bankNum - 1] : downCalls;
+    int upFound = FloorBitset::NO_FLOOR;
+    int downFound = FloorBitset::NO_FLOOR;
+
+    switch (searchDir) {
+        case Direction::UP:
+            if (callDir != Direction::DOWN)
+                upFound = upFloors.nextAtOrAbove(floorNum);
+            if (callDir != Direction::UP)
+                downFound = downFloors.nextAtOrAbove(floorNum);
+
+            // Lowest of the floors found above
+            if (upFound == FloorBitset::NO_FLOOR) return downFound;
+            if (downFound == FloorBitset::NO_FLOOR) return upFound;
+            return std::min(upFound, downFound);
+        case Direction::DOWN:
+            if (callDir != Direction::DOWN)
+                upFound = upFloors.nextAtOrBelow(floorNum);
+            if (callDir != Direction::UP)
+                downFound = downFloors.nextAtOrBelow(floorNum);
+
+            // Highest of the floors found below (NO_FLOOR is lowest)
+            return std::max(upFound, downFound);
+        case Direction::NONE:
+        default:
+            throw "ERROR: Hall call search needs a direction";
+    }
+}
+
+int SimBuilding::nearestServedHallCall(const SimElevator &car,
+                                       Direction searchDir) const {
+    // Every car answers every call of its bank when dispatch is not
+    // grouped, unless full.
+    if (dispatchMode == DispatchMode::NEAREST_CALL)
+        return car.isFull() ? FloorBitset::NO_FLOOR
+                            : nearestHallCall(car.currentFloorNum, searchDir,
+                                              Direction::NONE,
+                                              carBankNums[car.carId - 1]);
+
+    const FloorBitset &stops = assignedStops[car.carId - 1];
+
+    switch (searchDir) {
+        case Direction::UP:
+            return stops.nextAtOrAbove(car.currentFloorNum);
+        case Direction::DOWN:
+            return stops.nextAtOrBelow(car.currentFloorNum);
+        case Direction::NONE:
+        default:
+            throw "ERROR: Hall call search needs a direction";
+    }
+}
+
+SimBuilding::DispatchMode SimBuilding::getDispatchMode() const {
+    return dispatchMode;
+}
+
+void SimBuilding::setDispatchMode(DispatchMode newMode) {
+    if (dispatchMode == newMode) return;
+    dispatchMode = newMode;
+
+    // Destination requests only exist in DESTINATION mode.
+    std::vector<std::pair<int, int>> requests;
+    std::vector<int> requestCarIds;
+    for (int e_ind = 0; e_ind < elevatorCount; ++e_ind) {
+        for (const auto &request : destinationCalls[e_ind]) {
+            requests.push_back(request);
+            requestCarIds.push_back(e_ind + 1);
+        }
+        destinationCalls[e_ind].clear();
+    }
+    for (const auto &request : pendingDestinations) {
+        requests.push_back(request);
+        requestCarIds.push_back(0);
+    }
+    pendingDestinations.clear();
+
+    // Start over: drop all assignments, queue every active call if grouped.
+    for (int b_ind = 0; b_ind < bankCount(); ++b_ind) {
+        upAssignees[b_ind].assign(floorCount, 0);
+        downAssignees[b_ind].assign(floorCount, 0);
+        pendingCalls[b_ind].clear();
+
+        if (dispatchMode == DispatchMode::NEAREST_CALL) continue;
+        for (int floorNum : bankUpCalls[b_ind].toVector())
+            pendingCalls[b_ind].emplace_back(floorNum, Direction::UP);
+        for (int floorNum : bankDownCalls[b_ind].toVector())
+            pendingCalls[b_ind].emplace_back(floorNum, Direction::DOWN);
+    }
+    for (FloorBitset &stops : assignedStops) stops.clear();
+
+    // Passengers still waiting press the hall calls for their leg.
+    for (size_t r_ind = 0; r_ind < requests.size(); ++r_ind) {
+        int originFloorNum = requests[r_ind].first;
+        int destinationFloorNum = requests[r_ind].second;
+
+        if (requestCarIds[r_ind] != 0)
+            notifyDestinationAssigned(originFloorNum, destinationFloorNum,
+                                      requestCarIds[r_ind], 0);
+        pressLegHallCalls(originFloorNum, destinationFloorNum);
+    }
+
+    buildingDataChanged();
+}
+
+std::vector<std::string> SimBuilding::dispatchPolicyNames() {
+    std::vector<std::string> names;
+    for (const PolicyEntry &entry : policies) names.push_back(entry.name);
+    return names;
+}
+
+std::string SimBuilding::getDispatchPolicy() const { return policy->name; }
+
+void SimBuilding::setDispatchPolicy(const std::string &name) {
+    for (const PolicyEntry &entry : policies) {
+        if (name != entry.name) continue;
+
+        if (policy != &entry) {
+            policy = &entry;
+            buildingDataChanged();
+        }
+        return;
+    }
+    throw "ERROR: Unknown dispatch policy";
+}
+
+long long SimBuilding::getEnergyBudgetMs() const { return energyBudgetMs; }
+
+void SimBuilding::setEnergyBudgetMs(long long budgetMs) {
+    if (budgetMs < 0) throw "ERROR: Energy wait budget can't be negative";
+    energyBudgetMs = budgetMs;
+}
+
+int SimBuilding::getHallCallAssignee(int floorNum, Direction dir,
+                                     int bankNum) const {
+    validateFloorNum(floorNum);
+    validateBankNum(bankNum);
+
+    switch (dir) {
+        case Direction::UP:
+            return upAssignees[bankNum - 1][floorNum - 1];
+        case Direction::DOWN:
+            return downAssignees[bankNum - 1][floorNum - 1];
+        case Direction::NONE:
+        default:
+            throw "ERROR: Hall call assignee needs a direction";
+    }
+}
+
+const FloorBitset &SimBuilding::getAssignedStops(int carId) const {
+    if (!isCarId(carId))
+        throw "ERROR: Elevator trying to be accessed doesn't exist";
+    return assignedStops[carId - 1];
+}
+
+int SimBuilding::requestDestination(int originFloorNum,
+                                    int destinationFloorNum) {
+    validateFloorNum(originFloorNum);
+    validateFloorNum(destinationFloorNum);
+    if (originFloorNum == destinationFloorNum)
+        throw "ERROR: Destination is the floor the request comes from";
+
+    // Trips needing a change of car are requested a leg at a time.
+    int toFloorNum = legFloorNum(originFloorNum, destinationFloorNum);
+    if (toFloorNum == FloorBitset::NO_FLOOR)
+        throw "ERROR: No elevators connect those floors";
+
+    // Without destination dispatch, the kiosk is just a hall button.
+    if (dispatchMode != DispatchMode::DESTINATION) {
+        pressLegHallCalls(originFloorNum, toFloorNum);
+        return 0;
+    }
+
+    if (demand) demand->record(scheduler.now(), originFloorNum);
+    return assignDestination(originFloorNum, toFloorNum, 0);
+}
+
+const std::vector<std::pair<int, int>> &SimBuilding::getDestinationCalls(
+    int carId) const {
+    if (!isCarId(carId))
+        throw "ERROR: Elevator trying to be accessed doesn't exist";
+    return destinationCalls[carId - 1];
+}
+
+bool SimBuilding::canServeHallCalls(const SimElevator &car) const {
+    // Full cars bypass hall calls, leaving room for their riders.
+    return car.isInService() && !car.isFull();
+}
+
+long long SimBuilding::estimateArrivalMs(const SimElevator &car,
+                                         int floorNum) const {
+    validateFloorNum(floorNum);
+
+    return arrivalMs(car.currentFloorNum, car.getMovement(),
+                     car.getDoorState(), car.flights, car.config.doorSpeedMs,
+                     car.config.doorWaitMs,
+                     car.getCarCalls(), assignedStops[car.carId - 1],
+                     floorNum, floorCount);
+}
+
+int SimBuilding::soonestArrivingCar(int floorNum, int bankNum) const {
+    validateFloorNum(floorNum);
+    if (bankNum != 0) validateBankNum(bankNum);
+
+    const std::vector<int> &floorNums = fleet.getFloorNums();
+    const std::vector<MovementState> &movements = fleet.getMovements();
+    const std::vector<DoorState> &doors = fleet.getDoors();
+    const std::vector<const FlightTable *> &flights = fleet.getFlights();
+    const std::vector<int> &doorSpeedMs = fleet.getDoorSpeedMs();
+    const std::vector<int> &doorWaitMs = fleet.getDoorWaitMs();
+    const std::vector<const FloorBitset *> &carCalls = fleet.getCarCalls();
+
+    // Lowest car ID on ties.
+    int bestCarId = 0;
+    long long bestEtaMs = 0;
+    for (int e_ind = 0; e_ind < elevatorCount; ++e_ind) {
+        if (!fleet.canServeHallCalls(e_ind)) continue;
+
+        // Only the bank's cars, or any car stopping at the floor.
+        int carBankNum = carBankNums[e_ind];
+        if (bankNum != 0 ? carBankNum != bankNum
+                         : !bankFloors[carBankNum - 1].test(floorNum))
+            continue;
+
+        long long etaMs =
+            arrivalMs(floorNums[e_ind], movements[e_ind], doors[e_ind],
+                      *flights[e_ind], doorSpeedMs[e_ind], doorWaitMs[e_ind],
+                      *carCalls[e_ind], assignedStops[e_ind], floorNum,
+                      floorCount);
+        if (bestCarId == 0 || etaMs < bestEtaMs) {
+            bestCarId = e_ind + 1;
+            bestEtaMs = etaMs;
+        }
+    }
+    return bestCarId;
+}
+
+int SimBuilding::leastEnergyCar(int floorNum, int bankNum) const {
+    validateFloorNum(floorNum);
+    validateBankNum(bankNum);
+
+    std::vector<std::pair<int, long long>> candidates;
+    for (int e_ind = 0; e_ind < elevatorCount; ++e_ind) {
+        if (!fleet.canServeHallCalls(e_ind) || carBankNums[e_ind] != bankNum)
+            continue;
+
+        candidates.emplace_back(
+            e_ind,
+            arrivalMs(fleet.getFloorNums()[e_ind], fleet.getMovements()[e_ind],
+                      fleet.getDoors()[e_ind], *fleet.getFlights()[e_ind],
+                      fleet.getDoorSpeedMs()[e_ind],
+                      fleet.getDoorWaitMs()[e_ind], *fleet.getCarCalls()[e_ind],
+                      assignedStops[e_ind], floorNum, floorCount));
+    }
+    return pickLeastEnergy(candidates, floorNum);
+}
+
+double SimBuilding::estimateServiceEnergyJ(const SimElevator &car,
+                                           int floorNum) const {
+    validateFloorNum(floorNum);
+
+    const FloorBitset &carCalls = car.getCarCalls();
+    const FloorBitset &stops = assignedStops[car.carId - 1];
+    const EnergyModel &model = car.energyModel;
+    int pos = car.currentFloorNum;
+    if (floorNum == pos || carCalls.test(floorNum) || stops.test(floorNum))
+        return 0;
+
+    // Floors the car runs over anyway
+    int low = pos, high = pos;
+    if (!carCalls.empty()) {
+        low = std::min(low, carCalls.first());
+        high = std::max(high, carCalls.last());
+    }
+    if (!stops.empty()) {
+        low = std::min(low, stops.first());
+        high = std::max(high, stops.last());
+    }
+    double doorsJ = 2 * model.doorStrokeJ();
+
+    // On the way, the stop splits a run in two: one more braking and start.
+    // The car runs over the floor away from its position, whichever way the
+    // passenger is going.
+    if (floorNum > low && floorNum < high) {
+        Direction runDir = (pos < floorNum) ? Direction::UP : Direction::DOWN;
+        int below = std::max(carCalls.nextAtOrBelow(floorNum - 1),
+                             stops.nextAtOrBelow(floorNum - 1));
+        if (pos < floorNum) below = std::max(below, pos);
+
+        int above = high;
+        int nextCall = carCalls.nextAtOrAbove(floorNum + 1);
+        int nextStop = stops.nextAtOrAbove(floorNum + 1);
+        if (nextCall != FloorBitset::NO_FLOOR)
+            above = std::min(above, nextCall);
+        if (nextStop != FloorBitset::NO_FLOOR)
+            above = std::min(above, nextStop);
+        if (pos > floorNum) above = std::min(above, pos);
+
+        int load = car.getLoadKg();
+        return doorsJ + model.runNetJ(floorNum - below, runDir, load) +
+               model.runNetJ(above - floorNum, runDir, load) -
+               model.runNetJ(above - below, runDir, load);
+    }
+
+    // Beyond, the car travels on from its last stop that way, with its
+    // riders off by then.
+    int from = (floorNum < low) ? low : high;
+    int load = carCalls.empty() ? car.getLoadKg() : 0;
+    return doorsJ +
+           model.runNetJ(std::abs(floorNum - from),
+                         floorNum > from ? Direction::UP : Direction::DOWN,
+                         load);
+}
+
+bool SimBuilding::getIdleParking() const { return bool(demand); }
+
+void SimBuilding::setIdleParking(bool enabled) {
+    if (enabled == bool(demand)) return;
+
+    if (enabled) {
+        demand.reset(new DemandModel(floorCount));
+    } else {
+        demand.reset();
+        for (int e_ind = 0; e_ind < elevatorCount; ++e_ind) {
+            idleCars[e_ind] = false;
+            ++idleGenerations[e_ind];
+            cars[e_ind]->setParkFloor(FloorBitset::NO_FLOOR);
+        }
+    }
+
+    // Idle cars are found as they are recomputed.
+    buildingDataChanged();
+}
+
+long long SimBuilding::getParkDelayMs() const { return parkDelayMs; }
+
+void SimBuilding::setParkDelayMs(long long delayMs) {
+    if (delayMs < 0) throw "ERROR: Park delay can't be negative";
+    parkDelayMs = delayMs;
+}
+
+int SimBuilding::parkingFloor(const SimElevator &car) const {
+    int pos = car.currentFloorNum;
+    if (!demand) return pos;
+
+    // Nearest other idle or parking cars of the bank on either side, by
+    // where they wait. Cars on the same floor split by car ID.
+    int carIndex = car.carId - 1;
+    int bankNum = carBankNums[carIndex];
+    int below = 0, above = floorCount + 1;
+    for (int e_ind = 0; e_ind < elevatorCount; ++e_ind) {
+        const SimElevator &other = *cars[e_ind];
+        if (e_ind == carIndex || carBankNums[e_ind] != bankNum) continue;
+
+        int at = other.getParkFloorNum();
+        if (at == FloorBitset::NO_FLOOR) {
+            if (!idleCars[e_ind]) continue;
+            at = other.currentFloorNum;
+        }
+        if (at < pos || (at == pos && e_ind < carIndex))
+            below = std::max(below, at);
+        else
+            above = std::min(above, at);
+    }
+    if (above - below < 2) return pos;
+
+    // Weighted median of the floors closer to the car than to its
+    // neighbours, which move with it: a few Lloyd steps of 1D k-median.
+    const FloorBitset &served = bankFloors[bankNum - 1];
+    long long now = scheduler.now();
+    int floorNum = demand->medianFloor(now, below + 1, above - 1, served);
+    if (floorNum == FloorBitset::NO_FLOOR) return pos;
+
+    for (int step = 0; step < 4; ++step) {
+        int from = below == 0 ? 1 : (below + floorNum) / 2 + 1;
+        int to = above > floorCount ? floorCount : (floorNum + above - 1) / 2;
+        int next = demand->medianFloor(now, from, to, served);
+        if (next == FloorBitset::NO_FLOOR || next == floorNum) break;
+        floorNum = next;
+    }
+    return floorNum;
+}
+
+bool SimBuilding::buildingOnFire() const { return onFire; }
+bool SimBuilding::buildingPowerOut() const { return powerOut; }
+
+void SimBuilding::setBuildingOnFire(bool active) {
+    if (onFire != active) {
+        onFire = active;
+        buildingDataChanged();
+    }
+}
+void SimBuilding::setBuildingPowerOut(bool active) {
+    if (powerOut != active) {
+        powerOut = active;
+        buildingDataChanged();
+    }
+}
+
+SimElevator &SimBuilding::getElevator_byCarId(int carId) {
+    if (!isCarId(carId))
+        throw "ERROR: Elevator trying to be accessed doesn't exist";
+    return *cars[carId - 1];
+}
+
+const SimElevator &SimBuilding::getElevator_byCarId(int carId) const {
+    if (!isCarId(carId))
+        throw "ERROR: Elevator trying to be accessed doesn't exist";
+    return *cars[carId - 1];
+}
+
+const FleetState &SimBuilding::getFleet() const { return fleet; }
+
+const FlightTable &SimBuilding::flightTableFor(const CarConfig &config) {
+    for (const auto &table : flightTables)
+        if (table->matches(config)) return *table;
+
+    flightTables.emplace_back(new FlightTable(config, floorCount));
+    return *flightTables.back();
+}
+
+SimScheduler &SimBuilding::getScheduler() { return scheduler; }
+const SimScheduler &SimBuilding::getScheduler() const { return scheduler; }
+
+void SimBuilding::addObserver(SimObserver *observer) {
+    if (std::find(observers.begin(), observers.end(), observer) ==
+        observers.end())
+        observers.push_back(observer);
+}
+
+void SimBuilding::removeObserver(SimObserver *observer) {
+    observers.erase(std::remove(observers.begin(), observers.end(), observer),
+                    observers.end());
+}
+
+const std::vector<SimObserver *> &SimBuilding::getObservers() const {
+    return observers;
+}
+
+const SimBuilding::DispatchStats &SimBuilding::getDispatchStats() const {
+    return dispatchStats;
+}
+
+void SimBuilding::buildingDataChanged() {
+    if (hooks.buildingDataChanged) hooks.buildingDataChanged();
+
+    // Every car needs to compute new movement
+    dispatchStats.requested += elevatorCount;
+    for (int e_ind = 0; e_ind < elevatorCount; ++e_ind) markDirty(e_ind);
+}
+
+void SimBuilding::elevatorStateChanged(const SimElevator &car) {
+    fleet.update(car);
+    buildingDataChanged();
+}
+
+void SimBuilding::elevatorDataChanged(const SimElevator &car) {
+    dispatchStats.requested += 1;
+    markDirty(car.carId - 1);
+}
+
+void SimBuilding::markDirty(int carIndex) {
+    if (!dirtyCars[carIndex]) {
+        dirtyCars[carIndex] = true;
+        ++dirtyCount;
+    }
+    scheduleDispatch();
+}
+
+void SimBuilding::scheduleDispatch() {
+    // A running pass picks changes up itself.
+    if (dispatching || dispatchPending) return;
+
+    // Run once the current event is done, at the same virtual time.
+    dispatchPending = true;
+    scheduler.schedule(0, [this]() { dispatchPass(); });
+}
+
+void SimBuilding::dispatchPass() {
+    dispatchPending = false;
+    dispatching = true;
+    ++dispatchStats.passes;
+
+    // Recomputing a car may dirty others again; repeat until settled.
+    while (true) {
+        // Hand out hall calls first, assigning dirties the chosen cars.
+        if (dispatchMode != DispatchMode::NEAREST_CALL) assignHallCalls();
+        if (dirtyCount == 0) break;
+
+        (this->*policy->moveCars)();
+    }
+
+    dispatching = false;
+}
+
+template <class Policy>
+void SimBuilding::moveDirtyCars() {
+    for (int e_ind = 0; e_ind < elevatorCount; ++e_ind) {
+        if (!dirtyCars[e_ind]) continue;
+
+        dirtyCars[e_ind] = false;
+        --dirtyCount;
+        ++dispatchStats.performed;
+        cars[e_ind]->determineMovement<Policy>();
+        if (demand) trackIdle(e_ind);
+    }
+}
+
+void SimBuilding::assignHallCalls() {
+    // Release calls held by cars that can no longer serve them.
+    for (int e_ind = 0; e_ind < elevatorCount; ++e_ind) {
+        if (assignedStops[e_ind].empty() || fleet.canServeHallCalls(e_ind))
+            continue;
+
+        int carId = e_ind + 1;
+        int bankNum = carBankNums[e_ind];
+        std::vector<std::pair<int, int>> released;
+        released.swap(destinationCalls[e_ind]);
+
+        for (int floorNum : assignedStops[e_ind].toVector()) {
+            if (upAssignees[bankNum - 1][floorNum - 1] == carId) {
+                setAssignee(floorNum, Direction::UP, 0, bankNum);
+                pendingCalls[bankNum - 1].emplace_back(floorNum,
+                                                       Direction::UP);
+            }
+            if (downAssignees[bankNum - 1][floorNum - 1] == carId) {
+                setAssignee(floorNum, Direction::DOWN, 0, bankNum);
+                pendingCalls[bankNum - 1].emplace_back(floorNum,
+                                                       Direction::DOWN);
+            }
+        }
+
+        // Passengers are sent to another car right away.
+        for (const auto &request : released) {
+            refreshAssignedStop(carId, request.first);
+            assignDestination(request.first, request.second, carId);
+        }
+    }
+
+    if (!pendingDestinations.empty()) assignPendingDestinations();
+
+    // Assign each call to the car of its bank arriving soonest, lowest car
+    // ID on ties, or the least energy within the wait budget.
+    for (int b_ind = 0; b_ind < bankCount(); ++b_ind) {
+        std::vector<std::pair<int, Direction>> &calls = pendingCalls[b_ind];
+        if (calls.empty()) continue;
+
+        int bankNum = b_ind + 1;
+        std::vector<std::pair<int, Direction>> waiting;
+        for (const auto &call : calls) {
+            // Call was cleared or already assigned since it was queued.
+            if (!hasHallCall(call.first, call.second, bankNum) ||
+                getHallCallAssignee(call.first, call.second, bankNum) != 0)
+                continue;
+
+            int bestCarId =
+                energyBudgetMs > 0
+                    ? leastEnergyCar(call.first, bankNum)
+                    : soonestArrivingCar(call.first, bankNum);
+
+            // No car available, try again on the next pass.
+            if (bestCarId == 0)
+                waiting.push_back(call);
+            else
+                setAssignee(call.first, call.second, bestCarId, bankNum);
+        }
+        calls.swap(waiting);
+    }
+}
+
+void SimBuilding::setAssignee(int floorNum, Direction dir, int carId,
+                              int bankNum) {
+    std::vector<int> &assignees = (dir == Direction::UP)
+                                      ? upAssignees[bankNum - 1]
+                                      : downAssignees[bankNum - 1];
+
+    int prevCarId = assignees[floorNum - 1];
+    if (prevCarId == carId) return;
+    assignees[floorNum - 1] = carId;
+
+    if (prevCarId != 0) {
+        // Keep the stop if the car still has other business there.
+        refreshAssignedStop(prevCarId, floorNum);
+        elevatorDataChanged(*cars[prevCarId - 1]);
+    }
+    if (carId != 0) {
+        assignedStops[carId - 1].set(floorNum, true);
+        elevatorDataChanged(*cars[carId - 1]);
+    }
+}
+
+void SimBuilding::refreshAssignedStop(int carId, int floorNum) {
+    int bankNum = carBankNums[carId - 1];
+    bool stop = upAssignees[bankNum - 1][floorNum - 1] == carId ||
+                downAssignees[bankNum - 1][floorNum - 1] == carId;
+    for (const auto &request : destinationCalls[carId - 1])
+        if (request.first == floorNum) stop = true;
+
+    assignedStops[carId - 1].set(floorNum, stop);
+}
+
+int SimBuilding::assignDestination(int originFloorNum,
+                                   int destinationFloorNum, int prevCarId) {
+    // Lowest car ID on ties. A car picks up at most its rated persons.
+    int bestCarId = 0;
+    long long bestCostMs = 0;
+    std::vector<std::pair<int, long long>> candidates;
+    for (int e_ind = 0; e_ind < elevatorCount; ++e_ind) {
+        const FloorBitset &served = bankFloors[carBankNums[e_ind] - 1];
+        if (!fleet.canServeHallCalls(e_ind) ||
+            !served.test(originFloorNum) ||
+            !served.test(destinationFloorNum) ||
+            int(destinationCalls[e_ind].size()) >= cars[e_ind]->ratedPersons())
+            continue;
+
+        long long costMs =
+            destinationCostMs(e_ind, originFloorNum, destinationFloorNum);
+        if (energyBudgetMs > 0) candidates.emplace_back(e_ind, costMs);
+        if (bestCarId == 0 || costMs < bestCostMs) {
+            bestCarId = e_ind + 1;
+            bestCostMs = costMs;
+        }
+    }
+    if (energyBudgetMs > 0)
+        bestCarId = pickLeastEnergy(candidates, originFloorNum);
+
+    // No car available, try again on the next pass.
+    if (bestCarId == 0) {
+        pendingDestinations.emplace_back(originFloorNum, destinationFloorNum);
+    } else {
+        destinationCalls[bestCarId - 1].emplace_back(originFloorNum,
+                                                     destinationFloorNum);
+        assignedStops[bestCarId - 1].set(originFloorNum, true);
+        elevatorDataChanged(*cars[bestCarId - 1]);
+    }
+
+    if (bestCarId != prevCarId)
+        notifyDestinationAssigned(originFloorNum, destinationFloorNum,
+                                  prevCarId, bestCarId);
+    return bestCarId;
+}
+
+void SimBuilding::assignPendingDestinations() {
+    std::vector<std::pair<int, int>> unassigned;
+    unassigned.swap(pendingDestinations);
+
+    int carLoad = 1;
+    for (const auto &car : cars)
+        carLoad = std::max(carLoad, car->ratedPersons());
+
+    // Order by the oldest request of each car load going to the same floor.
+    std::vector<int> groupStarts(floorCount, 0);
+    std::vector<int> groupSizes(floorCount, 0);
+    std::vector<std::pair<int, int>> order;
+    for (int r_ind = 0; r_ind < int(unassigned.size()); ++r_ind) {
+        int floorIndex = unassigned[r_ind].second - 1;
+        if (groupSizes[floorIndex]++ % carLoad == 0)
+            groupStarts[floorIndex] = r_ind;
+        order.emplace_back(groupStarts[floorIndex], r_ind);
+    }
+    std::sort(order.begin(), order.end());
+
+    for (const auto &entry : order)
+        assignDestination(unassigned[entry.second].first,
+                          unassigned[entry.second].second, 0);
+}
+
+void SimBuilding::trackIdle(int carIndex) {
+    const SimElevator &car = *cars[carIndex];
+    bool idle = car.isIdle();
+    if (bool(idleCars[carIndex]) == idle) return;
+
+    idleCars[carIndex] = idle;
+    if (idle) {
+        scheduleParking(carIndex);
+        return;
+    }
+    ++idleGenerations[carIndex];
+    if (car.getParkFloorNum() != FloorBitset::NO_FLOOR) return;
+
+    // Called away: the idle cars on either side now cover its floors too.
+    int pos = car.currentFloorNum;
+    int below = -1, above = -1;
+    for (int e_ind = 0; e_ind < elevatorCount; ++e_ind) {
+        if (!idleCars[e_ind] || carBankNums[e_ind] != carBankNums[carIndex])
+            continue;
+
+        int at = cars[e_ind]->currentFloorNum;
+        if (at <= pos && (below < 0 || at > cars[below]->currentFloorNum))
+            below = e_ind;
+        else if (at > pos && (above < 0 || at < cars[above]->currentFloorNum))
+            above = e_ind;
+    }
+    if (below >= 0) scheduleParking(below);
+    if (above >= 0) scheduleParking(above);
+}
+
+void SimBuilding::scheduleParking(int carIndex) {
+    // Checks already scheduled are of an earlier generation, and ignored.
+    unsigned generation = ++idleGenerations[carIndex];
+    scheduler.schedule(parkDelayMs, [this, carIndex, generation]() {
+        parkIfIdle(carIndex, generation);
+    });
+}
+
+void SimBuilding::parkIfIdle(int carIndex, unsigned generation) {
+    if (!demand || idleGenerations[carIndex] != generation) return;
+
+    SimElevator &car = *cars[carIndex];
+    int floorNum = parkingFloor(car);
+    if (floorNum != car.currentFloorNum) {
+        car.setParkFloor(floorNum);
+        return;
+    }
+
+    // Demand shifts with the time of day.
+    long long now = scheduler.now();
+    scheduler.schedule(DemandModel::slotMs - now % DemandModel::slotMs,
+                       [this, carIndex, generation]() {
+                           parkIfIdle(carIndex, generation);
+                       });
+}
+
+long long SimBuilding::destinationCostMs(int carIndex, int originFloorNum,
+                                         int destinationFloorNum) const {
+    const FloorBitset &carCalls = *fleet.getCarCalls()[carIndex];
+    const FloorBitset &stops = assignedStops[carIndex];
+    const std::vector<std::pair<int, int>> &requests =
+        destinationCalls[carIndex];
+
+    long long etaMs = arrivalMs(
+        fleet.getFloorNums()[carIndex], fleet.getMovements()[carIndex],
+        fleet.getDoors()[carIndex], *fleet.getFlights()[carIndex],
+        fleet.getDoorSpeedMs()[carIndex], fleet.getDoorWaitMs()[carIndex],
+        carCalls, stops, originFloorNum, floorCount);
+
+    // Stops the car makes anyway cost nothing more, which is what groups
+    // passengers going to the same floor.
+    int newStops = 0;
+    if (!carCalls.test(originFloorNum) && !stops.test(originFloorNum))
+        ++newStops;
+    bool destinationStop =
+        carCalls.test(destinationFloorNum) || stops.test(destinationFloorNum);
+    for (const auto &request : requests)
+        if (request.second == destinationFloorNum) destinationStop = true;
+    if (!destinationStop) ++newStops;
+
+    // A new stop delays everyone aboard or about to be.
+    long long stopMs = 2LL * fleet.getDoorSpeedMs()[carIndex] +
+                       fleet.getDoorWaitMs()[carIndex];
+    long long delayed =
+        1 + cars[carIndex]->getPassengerCount() + (long long)requests.size();
+    return etaMs + newStops * stopMs * delayed;
+}
+
+int SimBuilding::pickLeastEnergy(
+    const std::vector<std::pair<int, long long>> &candidates,
+    int floorNum) const {
+    long long soonestMs = 0;
+    for (size_t c_ind = 0; c_ind < candidates.size(); ++c_ind)
+        if (c_ind == 0 || candidates[c_ind].second < soonestMs)
+            soonestMs = candidates[c_ind].second;
+
+    // Lowest cost, then lowest car ID on ties.
+    int bestCarId = 0;
+    double bestJ = 0;
+    long long bestCostMs = 0;
+    for (const auto &candidate : candidates) {
+        if (candidate.second > soonestMs + energyBudgetMs) continue;
+
+        double energyJ =
+            estimateServiceEnergyJ(*cars[candidate.first], floorNum);
+        if (bestCarId == 0 || energyJ < bestJ ||
+            (energyJ == bestJ && candidate.second < bestCostMs)) {
+            bestCarId = candidate.first + 1;
+            bestJ = energyJ;
+            bestCostMs = candidate.second;
+        }
+    }
+    return bestCarId;
+}
+
+void SimBuilding::pickUpDestinations(const SimElevator &car) {
+    std::vector<std::pair<int, int>> &requests =
+        destinationCalls[car.carId - 1];
+    int floorNum = car.currentFloorNum;
+    SimElevator &stopped = *cars[car.carId - 1];
+
+    bool pickedUp = false;
+    for (size_t r_ind = 0; r_ind < requests.size();) {
+        if (requests[r_ind].first == floorNum) {
+            stopped.setCarCall(requests[r_ind].second, true);
+            requests[r_ind] = requests.back();
+            requests.pop_back();
+            pickedUp = true;
+        } else {
+            ++r_ind;
+        }
+    }
+
+    if (pickedUp) {
+        refreshAssignedStop(car.carId, floorNum);
+        elevatorDataChanged(car);
+    }
+}
+
+void SimBuilding::notifyDestinationAssigned(int originFloorNum,
+                                            int destinationFloorNum,
+                                            int prevCarId, int carId) {
+    if (hooks.destinationAssigned)
+        hooks.destinationAssigned(originFloorNum, destinationFloorNum,
+                                  prevCarId, carId);
+    for (SimObserver *observer : observers)
+        observer->destinationAssigned(originFloorNum, destinationFloorNum,
+                                      prevCarId, carId);
+}
+
+void SimBuilding::elevatorArrived(const SimElevator &car) {
+    // Passengers assigned to the car get on, if it can take them.
+    if (dispatchMode == DispatchMode::DESTINATION && canServeHallCalls(car))
+        pickUpDestinations(car);
+
+    for (SimObserver *observer : observers) observer->elevatorArrived(car);
+
+    // Elevator arrived, unset that floor's calls in its bank.
+    int floorNum = car.currentFloorNum;
+    int bankNum = carBankNums[car.carId - 1];
+
+    if (hasHallButton(floorNum, Direction::UP, bankNum))
+        setBankHallCall(floorNum, Direction::UP, false, bankNum);
+    if (hasHallButton(floorNum, Direction::DOWN, bankNum))
+        setBankHallCall(floorNum, Direction::DOWN, false, bankNum);
+}
@@ -0,0 +1,646 @@
+#ifndef SIMBUILDING_H
+#define SIMBUILDING_H
+
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CarConfig.h"
+#include "Direction.h"
+#include "FleetState.h"
+#include "FloorBitset.h"
+#include "SimObserver.h"
+#include "SimScheduler.h"
+
+// Forward declarations
+class DemandModel;
+class FlightTable;
+class SimElevator;
+
+/** Widget-free building holding floors, hall calls and elevator cars.
+ *
+ * Plain C++ core of the simulation, usable without a QApplication. Owns the
+ * SimElevator cars, stores hall calls and building-wide emergencies, and
+ * has cars recompute their movement when data changes. Changes only mark cars
+ * dirty; every change made during one scheduler event is coalesced into a
+ * single dispatch pass run right after it, at the same virtual time, which
+ * recomputes each dirty car once.
+ *
+ * In GROUP dispatch mode (the default), the pass also acts as the group
+ * controller: each hall call is assigned to exactly one car, the available
+ * car with the lowest estimated time of arrival, and cars only answer the
+ * hall calls assigned to them. Cars with nothing assigned stay put. In
+ * NEAREST_CALL mode every car chases the nearest hall call itself.
+ *
+ * DESTINATION mode adds destination dispatch: passengers enter their
+ * destination at a floor kiosk instead of pressing UP or DOWN, and are told
+ * which car to take. Knowing where everyone goes, the controller groups
+ * passengers with the same destination into the same car, so each trip makes
+ * fewer stops. A request goes to the car with the lowest cost: its estimated
+ * arrival at the origin, plus a door cycle for every stop the request adds,
+ * weighted by the passengers the stop delays. The car picks the request up
+ * when it stops at the origin, and the destination becomes its car call.
+ * Plain hall calls are still grouped as in GROUP mode.
+ *
+ * Whichever mode hands out the calls, each car picks the way to go among the
+ * floors queued for it by the building's dispatch policy, selected by name
+ * (setDispatchPolicy()): "nearest-floor", the closest one, by default, or
+ * "collective", carrying on the way it runs while it has floors queued that
+ * way. Policies are compile-time template parameters of the dispatch pass,
+ * see DispatchPolicy.h.
+ *
+ * With an energy budget (setEnergyBudgetMs()), both GROUP and DESTINATION
+ * assignment trade some waiting for energy: among the cars arriving (or
+ * costing) at most the budget later than the best one, the call goes to the
+ * car that would use the least energy to answer it, by its EnergyModel. A
+ * car already passing the floor, or running the way its counterweight pulls,
+ * is often cheaper than the nearest idle one. A budget of 0 (the default)
+ * leaves assignment as above.
+ *
+ * With idle parking (setIdleParking()), the building learns when and where
+ * hall calls are made (DemandModel), and sends cars that stayed idle for
+ * parkDelayMs to where the next call is expected: each one to the weighted
+ * median of the demand between its idle neighbours of the same bank,
+ * moving its share of the floors along with it until it settles. Demand at
+ * the lobby just before the usual up-peak thus pulls idle cars down there,
+ * and evenly spread demand spreads them evenly. Idle cars look again at
+ * every slot of the day.
+ *
+ * Cars may stop at only some floors (CarConfig::servedFloorNums), as in a
+ * zoned tower with low, mid and high-rise banks and express shuttles to sky
+ * lobbies. Cars serving the same floors form a bank, numbered from 1 in the
+ * order of their lowest car ID; an unzoned building is a single bank. Each
+ * bank has its own hall buttons, like the separate lobbies of real banks: a
+ * floor served by several banks has a pair of buttons for each, and a bank's
+ * hall calls are only ever answered by its own cars. Trips between floors no
+ * bank serves together change cars at transfer floors, see legFloorNum().
+ *
+ * All timing runs on the building's SimScheduler, so a headless run simply
+ * advances the scheduler: runUntil() for a fixed span of simulated time, or
+ * runNext() step by step. Floor numbers start from 1, car IDs start from 1.
+ * Each car takes its timings and safe floors from its CarConfig; without
+ * configs, every car uses the defaults.
+ *
+ * Data Members:
+ * + Hooks: struct
+ *      Callbacks invoked by the engine. Any of them may be left empty.
+ *      - buildingDataChanged: data in the building has changed.
+ *      - hallCallChanged: a floor's UP/DOWN call was set or cleared.
+ *      - destinationAssigned: a destination request moved from one car to
+ *        another, see SimObserver::destinationAssigned().
+ * + hooks: Hooks
+ * + defaultParkDelayMs: long long
+ *      Park delay of a new building.
+ * + defaultDispatchPolicy: const char *
+ *      Dispatch policy of a new building, the reference "nearest-floor".
+ *
+ * - observers: std::vector<SimObserver *>
+ *      Passive listeners informed of simulation events. Not owned.
+ *
+ * + DispatchMode: enum
+ *      How hall calls are distributed among cars (see above).
+ *
+ * + DispatchStats: struct
+ *      Counters describing the work done by dispatch passes.
+ *      - passes: dispatch passes run.
+ *      - requested: recomputations asked for, counting one per car for every
+ *        building-wide change, as a broadcast to every car would run.
+ *      - performed: recomputations actually run.
+ *      - saved(): recomputations avoided by coalescing.
+ *
+ * + floorCount: int
+ *      Number of floors in the building.
+ * + elevatorCount: int
+ *      Number of elevators in the building.
+ *
+ * - upCalls: FloorBitset
+ * - downCalls: FloorBitset
+ *      Floors with an active UP / DOWN hall call in any bank. Updated
+ *      incrementally when calls change, so nearest-call queries never scan
+ *      every floor.
+ * - bankUpCalls / bankDownCalls: std::vector<FloorBitset>
+ *      Floors with an active UP / DOWN hall call in each bank, indexed by
+ *      bank number - 1.
+ *
+ * - onFire: bool
+ * - powerOut: bool
+ *      Building-wide emergency states.
+ *
+ * - scheduler: SimScheduler
+ *      Virtual clock and event queue driving the cars' timers.
+ *
+ * - flightTables: std::vector<std::unique_ptr<FlightTable>>
+ *      One flight time table per distinct motion profile among the cars.
+ * - cars: std::vector<std::unique_ptr<SimElevator>>
+ *      Elevator cars, indexed by car ID - 1.
+ * - fleet: FleetState
+ *      Structure-of-arrays copy of the cars' state, refreshed whenever a car
+ *      reports a change. Dispatch rounds scan it instead of the cars.
+ *
+ * - carBankNums: std::vector<int>
+ *      Bank of each car, indexed by car ID - 1.
+ * - bankFloors: std::vector<FloorBitset>
+ *      Floors each bank serves, indexed by bank number - 1.
+ * - transferFloors: std::vector<std::vector<int>>
+ *      Ascending floors served by both of two different banks, indexed by
+ *      (bank number - 1) * bank count + other bank number - 1.
+ *
+ * - demand: std::unique_ptr<DemandModel>
+ *      Hall call demand learned while idle parking is on, null otherwise.
+ * - parkDelayMs: long long
+ *      How long a car stays idle before it is parked.
+ * - idleCars: std::vector<char>
+ * - idleGenerations: std::vector<unsigned>
+ *      Whether each car was idle when last recomputed, indexed by car ID -
+ *      1, and a counter bumped whenever that changes, so parking checks of
+ *      an earlier idle spell are ignored.
+ *
+ * - dirtyCars: std::vector<char>
+ * - dirtyCount: int
+ *      Cars needing a movement recomputation, indexed by car ID - 1, and how
+ *      many there are.
+ * - dispatchPending: bool
+ *      Whether a dispatch pass is scheduled.
+ * - dispatching: bool
+ *      Whether a dispatch pass is running. Cars dirtied during a pass are
+ *      recomputed by the same pass.
+ * - dispatchStats: DispatchStats
+ *      Counters of the dispatch passes run so far.
+ *
+ * - PolicyEntry: struct
+ *      A dispatch policy in the registry: its name, and the dispatch pass
+ *      loop instantiated for it.
+ * - policies: const PolicyEntry[]
+ *      Registry of the built-in dispatch policies. Journals store a policy
+ *      as its index, so new ones go at the end.
+ * - policy: const PolicyEntry *
+ *      Dispatch policy the cars move by.
+ *
+ * - dispatchMode: DispatchMode
+ * - energyBudgetMs: long long
+ *      How much later than the soonest car a call may be answered to save
+ *      energy, 0 to always send the soonest.
+ * - upAssignees: std::vector<std::vector<int>>
+ * - downAssignees: std::vector<std::vector<int>>
+ *      Car ID assigned to each floor's UP / DOWN hall call in each bank, 0 if
+ *      unassigned, indexed by bank number - 1, then floor number - 1.
+ * - assignedStops: std::vector<FloorBitset>
+ *      Floors with a hall call assigned to each car, indexed by car ID - 1.
+ * - pendingCalls: std::vector<std::vector<std::pair<int, Direction>>>
+ *      Hall calls of each bank waiting to be assigned to a car, indexed by
+ *      bank number - 1.
+ * - destinationCalls: std::vector<std::vector<std::pair<int, int>>>
+ *      Destination requests (origin, destination) assigned to each car and
+ *      not picked up yet, indexed by car ID - 1.
+ * - pendingDestinations: std::vector<std::pair<int, int>>
+ *      Destination requests waiting to be assigned to a car.
+ *
+ * Class Methods:
+ * + randomInitialFloorNums(int, int, std::mt19937 &): std::vector<int>
+ *      Draws a random starting floor number for each elevator from the
+ *      simulation's own generator, for reproducible runs.
+ * + randomInitialFloorNums(int, const std::vector<CarConfig> &,
+ *   std::mt19937 &): std::vector<int>
+ *      Same, drawing each car's floor from the floors it serves. Cars serving
+ *      every floor draw as above.
+ *
+ * + isFloorNum(int): bool
+ * + isCarId(int): bool
+ *      Returns true if the floor number / car ID exists in the building.
+ *
+ * + bankCount(): int
+ *      Returns the number of banks.
+ * + getBankNum(int): int
+ *      Returns the bank of a car by ID.
+ * + getBankFloors(int): const FloorBitset &
+ *      Returns the floors a bank serves.
+ * + legFloorNum(int, int): int
+ *      Returns the floor a passenger going from one floor to another rides
+ *      to in their first car: the destination if a bank serves both floors,
+ *      or else the transfer floor starting the route with the fewest changes
+ *      of car, the one nearest the way on a tie. Returns
+ *      FloorBitset::NO_FLOOR if no banks connect the floors.
+ * + legFloorNum(const std::vector<FloorBitset> &,
+ *   const std::vector<std::vector<int>> &, int, int): int
+ *      Same, over any banks (by served floors) and their transfer floors,
+ *      for callers grouping cars their own way, such as ShardedEngine.
+ * + transferFloorsOf(const std::vector<FloorBitset> &):
+ *   std::vector<std::vector<int>>
+ *      Returns the transfer floors between banks, laid out as
+ *      transferFloors.
+ *
+ * + hasHallButton(int, Direction, int): bool
+ *      Returns true if a bank (0 for any bank) has a hall button on the floor
+ *      in the direction, either direction for Direction::NONE: it serves the
+ *      floor and another floor that way.
+ * + hasHallCall(int, Direction, int): bool
+ * + setHallCall(int, Direction, bool, int): void
+ *      Query or set the hall call of a floor in the given direction, in a
+ *      bank or, for bank 0, the default, in any bank / every bank with the
+ *      button. Setting throws if there is no such hall button.
+ *
+ * + getQueuedFloors(Direction, int): std::vector<int>
+ *      Returns an ascending list of floor numbers where the calls active on
+ *      the floor match the direction given, in a bank or, for bank 0, in
+ *      any bank. If no direction (Direction::NONE) is given, return all
+ *      floors with any direction active.
+ *
+ * + nearestHallCall(int, Direction, Direction, int): int
+ *      Returns the closest floor at or above (Direction::UP) or at or below
+ *      (Direction::DOWN) the given floor with a hall call matching the call
+ *      direction, any direction if Direction::NONE, in a bank or, for bank
+ *      0, in any bank. Returns FloorBitset::NO_FLOOR if there is none.
+ * + nearestServedHallCall(const SimElevator &, Direction): int
+ *      Same search from the car's floor, limited to the hall calls the car
+ *      should answer: its assigned stops in GROUP and DESTINATION modes, any
+ *      call of its bank in NEAREST_CALL.
+ *
+ * + getDispatchMode(): DispatchMode
+ * + setDispatchMode(DispatchMode): void
+ *      Query or switch how hall calls are distributed among cars.
+ * + dispatchPolicyNames(): std::vector<std::string>
+ *      Returns the names of the dispatch policies, in registry order.
+ * + getDispatchPolicy(): std::string
+ * + setDispatchPolicy(const std::string &): void
+ *      Query or switch the dispatch policy by name. Throws if there is no
+ *      such policy.
+ * + getEnergyBudgetMs(): long long
+ * + setEnergyBudgetMs(long long): void
+ *      Query or set the wait budget of energy-aware dispatch, see below.
+ *      Throws if negative.
+ * + getHallCallAssignee(int, Direction, int): int
+ *      Returns the ID of the car assigned to a hall call of a bank, the
+ *      first by default, 0 if none.
+ * + getAssignedStops(int): const FloorBitset &
+ *      Returns the floors with a hall call or destination request assigned
+ *      to a car.
+ * + requestDestination(int, int): int
+ *      A passenger at a kiosk on the origin floor asks for the destination
+ *      floor. The request is for the first leg of the trip, to legFloorNum(),
+ *      and the passenger asks again at the transfer floor. Returns the ID of
+ *      the car assigned, or 0 if no car can take the request yet;
+ *      destinationAssigned reports when one does. Outside DESTINATION mode
+ *      the kiosk only presses the hall calls of the banks serving the leg,
+ *      in its direction, and returns 0. Throws for an invalid or equal pair
+ *      of floors, or floors no banks connect.
+ * + getDestinationCalls(int): const std::vector<std::pair<int, int>> &
+ *      Returns the destination requests a car is yet to pick up.
+ * + estimateArrivalMs(const SimElevator &, int): long long
+ *      Estimated time for a car to reach a floor and open its doors, from
+ *      the distance to travel, the stops it has already committed to on the
+ *      way, and the door cycles they take. Cars going away from the floor
+ *      first travel to their furthest committed stop in that direction.
+ *      Kinematic cars fly each leg between stops as its own run, timed by
+ *      their FlightTable.
+ * + soonestArrivingCar(int, int): int
+ *      Returns the ID of the car of a bank (0 for any car stopping at the
+ *      floor) that can serve hall calls with the lowest estimated arrival at
+ *      a floor, the lowest ID on ties, 0 if no car is available. Scans the
+ *      fleet state linearly.
+ * + leastEnergyCar(int, int): int
+ *      Returns the ID of the car of a bank that can serve hall calls whose
+ *      estimated arrival at a floor is within the energy budget of the
+ *      soonest one, and which would use the least energy to answer the
+ *      call, 0 if no car is available.
+ * + estimateServiceEnergyJ(const SimElevator &, int): double
+ *      Estimated energy a car would use to stop at a floor, on top of what
+ *      it uses anyway: the door cycle and the extra braking and start if the
+ *      floor is on its way (run the way the car passes it), or the run on
+ *      from its last committed stop that way, with its riders off. Floors it
+ *      stops at anyway cost nothing. Negative if the drive feeds more back.
+ * + canServeHallCalls(const SimElevator &): bool
+ *      Returns true if the car is in a state to be assigned hall calls: in
+ *      service and not full.
+ *
+ * + getIdleParking(): bool
+ * + setIdleParking(bool): void
+ *      Query or turn idle parking on or off, see above. Turning it off
+ *      forgets the learned demand and the cars' parking floors.
+ * + getParkDelayMs(): long long
+ * + setParkDelayMs(long long): void
+ *      Query or set how long a car must be idle to be parked. Throws if
+ *      negative.
+ * + parkingFloor(const SimElevator &): int
+ *      Returns the floor the learned demand says an idle car should wait
+ *      at, its current floor without idle parking or any expected calls.
+ *
+ * + buildingOnFire(): bool
+ * + buildingPowerOut(): bool
+ * + setBuildingOnFire(bool): void
+ * + setBuildingPowerOut(bool): void
+ *      Query or set the related building-wide emergency.
+ *
+ * + getElevator_byCarId(int): SimElevator &
+ *      Returns the car with a matching ID.
+ *
+ * + getFleet(): const FleetState &
+ *      Returns the structure-of-arrays state of every car.
+ * + flightTableFor(const CarConfig &): const FlightTable &
+ *      Returns the flight time table of a car's motion profile, creating it
+ *      on first use. Cars with the same profile share one table.
+ *
+ * + getScheduler(): SimScheduler &
+ *      Returns the scheduler driving the simulation.
+ *
+ * + addObserver(SimObserver *): void
+ * + removeObserver(SimObserver *): void
+ * + getObservers(): const std::vector<SimObserver *> &
+ *      Register, unregister or list passive listeners of simulation events.
+ *
+ * + getDispatchStats(): DispatchStats
+ *      Returns the dispatch pass counters.
+ *
+ * + buildingDataChanged(): void
+ *      Informs the hooks that building data has changed, and marks every car
+ *      for recomputation.
+ * + elevatorStateChanged(const SimElevator &): void
+ *      Called by a car whose state changed: refreshes its fleet state row,
+ *      then acts as buildingDataChanged().
+ * + elevatorDataChanged(const SimElevator &): void
+ *      Marks a single car for recomputation, for changes only concerning it.
+ * + elevatorArrived(const SimElevator &): void
+ *      Called by a car stopping at a floor; picks up the destination requests
+ *      assigned to it there, and clears that floor's hall calls in its bank.
+ *
+ * - validateFloorNum(int): void
+ * - validateBankNum(int): void
+ *      Throws an exception if the floor / bank number does not exist.
+ *
+ * - groupBanks(): void
+ *      Sorts the cars into banks by the floors they serve, and finds the
+ *      transfer floors between banks.
+ * - setBankHallCall(int, Direction, bool, int): void
+ *      Sets the hall call of a floor in one bank, which has the button.
+ * - pressLegHallCalls(int, int): void
+ *      Presses the hall calls of a leg from one floor to another, at every
+ *      bank serving both floors.
+ *
+ * - markDirty(int): void
+ *      Marks a car (by index) for recomputation and schedules a pass.
+ * - scheduleDispatch(): void
+ *      Schedules a dispatch pass unless one is pending or running.
+ * - dispatchPass(): void
+ *      Recomputes the movement of every dirty car until none are left.
+ * - moveDirtyCars<Policy>(): void
+ *      One round of dispatchPass(): recomputes the movement of the dirty
+ *      cars in car ID order, by a dispatch policy.
+ *
+ * - assignHallCalls(): void
+ *      Releases calls and destination requests held by cars that can no
+ *      longer serve them, then assigns every pending hall call to the car
+ *      with the lowest ETA, and every pending request to the car with the
+ *      lowest cost.
+ * - setAssignee(int, Direction, int, int): void
+ *      Records the car assigned to a hall call of a bank (0 to unassign),
+ *      keeping the per-car assigned stops in sync.
+ * - refreshAssignedStop(int, int): void
+ *      Marks a floor as an assigned stop of a car (by ID) if the car holds a
+ *      hall call or a destination request there, and clears it otherwise.
+ *
+ * - assignDestination(int, int, int): int
+ *      Assigns a destination request to the car with the lowest cost that
+ *      serves both floors and has room for it, or queues it if there is
+ *      none, and reports a change of car from the given one. Returns the car
+ *      ID, 0 if queued.
+ * - assignPendingDestinations(): void
+ *      Retries the queued requests. Up to a car load of requests for the
+ *      same floor go with the oldest of them, so a car with room fills up
+ *      with a few destinations rather than many, and the next car load for
+ *      that floor waits its turn.
+ * - pickLeastEnergy(const std::vector<std::pair<int, long long>> &, int):
+ *   int
+ *      From (car index, cost) pairs, returns the ID of the car using the
+ *      least energy to stop at a floor among those costing at most the
+ *      energy budget more than the cheapest, the lowest cost on ties.
+ * - trackIdle(int): void
+ *      After a car's recomputation, notes whether it is idle. Schedules a
+ *      parking check when it becomes so, or when it is called away for the
+ *      nearest idle cars of its bank on either side, whose share of the
+ *      floors grows.
+ * - scheduleParking(int): void
+ *      Schedules a parking check of an idle car parkDelayMs from now,
+ *      replacing any earlier one.
+ * - parkIfIdle(int, unsigned): void
+ *      Parking check of a car's idle spell: sends it to its parking floor,
+ *      or checks again at the next slot of the day if it is there already.
+ * - destinationCostMs(int, int, int): long long
+ *      Cost of a car (by index) taking a destination request, see above.
+ * - pickUpDestinations(const SimElevator &): void
+ *      Turns the requests assigned to a car at its floor into car calls.
+ * - notifyDestinationAssigned(int, int, int, int): void
+ *      Informs the hooks and observers of a request changing car.
+ */
+class SimBuilding {
+   public:
+    /* Public data structs */
+    typedef struct Hooks {
+        std::function<void()> buildingDataChanged;
+        std::function<void(int floorNum, Direction, bool active)>
+            hallCallChanged;
+        std::function<void(int originFloorNum, int destinationFloorNum,
+                           int prevCarId, int carId)>
+            destinationAssigned;
+    } Hooks;
+
+    enum class DispatchMode { NEAREST_CALL, GROUP, DESTINATION };
+
+    typedef struct DispatchStats {
+        unsigned long long passes;
+        unsigned long long requested;
+        unsigned long long performed;
+
+        DispatchStats() : passes(0), requested(0), performed(0) {}
+        unsigned long long saved() const { return requested - performed; }
+    } DispatchStats;
+
+    SimBuilding(int floorCount, int elevatorCount,
+                const std::vector<int> &initialFloorNums,
+                const std::vector<CarConfig> &carConfigs = {});
+    ~SimBuilding();
+
+    SimBuilding(const SimBuilding &) = delete;
+    SimBuilding &operator=(const SimBuilding &) = delete;
+
+    /* Public data members */
+    static const long long defaultParkDelayMs = 30 * 1000;
+    static const char *const defaultDispatchPolicy;
+
+    Hooks hooks;
+
+    const int floorCount;
+    const int elevatorCount;
+
+    /* Public methods */
+    static std::vector<int> randomInitialFloorNums(int floorCount,
+                                                   int elevatorCount,
+                                                   std::mt19937 &rng);
+    static std::vector<int> randomInitialFloorNums(
+        int floorCount, const std::vector<CarConfig> &carConfigs,
+        std::mt19937 &rng);
+
+    bool isFloorNum(int) const;
+    bool isCarId(int) const;
+
+    int bankCount() const;
+    int getBankNum(int carId) const;
+    const FloorBitset &getBankFloors(int bankNum) const;
+    int legFloorNum(int originFloorNum, int destinationFloorNum) const;
+    static int legFloorNum(
+        const std::vector<FloorBitset> &bankFloors,
+        const std::vector<std::vector<int>> &transferFloors,
+        int originFloorNum, int destinationFloorNum);
+    static std::vector<std::vector<int>> transferFloorsOf(
+        const std::vector<FloorBitset> &bankFloors);
+
+    bool hasHallButton(int floorNum, Direction, int bankNum = 0) const;
+    bool hasHallCall(int floorNum, Direction, int bankNum = 0) const;
+    void setHallCall(int floorNum, Direction, bool active, int bankNum = 0);
+
+    const std::vector<int> getQueuedFloors(Direction = Direction::NONE,
+                                           int bankNum = 0) const;
+
+    int nearestHallCall(int floorNum, Direction searchDir,
+                        Direction callDir = Direction::NONE,
+                        int bankNum = 0) const;
+    int nearestServedHallCall(const SimElevator &, Direction searchDir) const;
+
+    DispatchMode getDispatchMode() const;
+    void setDispatchMode(DispatchMode);
+    static std::vector<std::string> dispatchPolicyNames();
+    std::string getDispatchPolicy() const;
+    void setDispatchPolicy(const std::string &name);
+    long long getEnergyBudgetMs() const;
+    void setEnergyBudgetMs(long long budgetMs);
+    int getHallCallAssignee(int floorNum, Direction, int bankNum = 1) const;
+    const FloorBitset &getAssignedStops(int carId) const;
+    int requestDestination(int originFloorNum, int destinationFloorNum);
+    const std::vector<std::pair<int, int>> &getDestinationCalls(
+        int carId) const;
+    long long estimateArrivalMs(const SimElevator &, int floorNum) const;
+    int soonestArrivingCar(int floorNum, int bankNum = 0) const;
+    int leastEnergyCar(int floorNum, int bankNum) const;
+    double estimateServiceEnergyJ(const SimElevator &, int floorNum) const;
+    bool canServeHallCalls(const SimElevator &) const;
+
+    bool getIdleParking() const;
+    void setIdleParking(bool);
+    long long getParkDelayMs() const;
+    void setParkDelayMs(long long delayMs);
+    int parkingFloor(const SimElevator &) const;
+
+    bool buildingOnFire() const;
+    bool buildingPowerOut() const;
+    void setBuildingOnFire(bool);
+    void setBuildingPowerOut(bool);
+
+    SimElevator &getElevator_byCarId(int);
+    const SimElevator &getElevator_byCarId(int) const;
+
+    const FleetState &getFleet() const;
+    const FlightTable &flightTableFor(const CarConfig &);
+
+    SimScheduler &getScheduler();
+    const SimScheduler &getScheduler() const;
+
+    void addObserver(SimObserver *);
+    void removeObserver(SimObserver *);
+    const std::vector<SimObserver *> &getObservers() const;
+
+    const DispatchStats &getDispatchStats() const;
+
+    void buildingDataChanged();
+    void elevatorStateChanged(const SimElevator &);
+    void elevatorDataChanged(const SimElevator &);
+    void elevatorArrived(const SimElevator &);
+
+   private:
+    /* Private data structs */
+    typedef struct PolicyEntry {
+        const char *name;
+        void (SimBuilding::*moveCars)();
+    } PolicyEntry;
+
+    /* Private data members */
+    static const PolicyEntry policies[];
+
+    FloorBitset upCalls;
+    FloorBitset downCalls;
+    std::vector<FloorBitset> bankUpCalls;
+    std::vector<FloorBitset> bankDownCalls;
+
+    bool onFire;
+    bool powerOut;
+
+    SimScheduler scheduler;
+
+    std::vector<SimObserver *> observers;
+
+    std::vector<std::unique_ptr<FlightTable>> flightTables;
+    std::vector<std::unique_ptr<SimElevator>> cars;
+
+    std::vector<char> dirtyCars;
+    int dirtyCount;
+    bool dispatchPending;
+    bool dispatching;
+    DispatchStats dispatchStats;
+    const PolicyEntry *policy;
+
+    DispatchMode dispatchMode;
+    long long energyBudgetMs;
+    std::vector<std::vector<int>> upAssignees;
+    std::vector<std::vector<int>> downAssignees;
+    std::vector<FloorBitset> assignedStops;
+    std::vector<std::vector<std::pair<int, Direction>>> pendingCalls;
+    std::vector<std::vector<std::pair<int, int>>> destinationCalls;
+    std::vector<std::pair<int, int>> pendingDestinations;
+
+    FleetState fleet;
+
+    std::vector<int> carBankNums;
+    std::vector<FloorBitset> bankFloors;
+    std::vector<std::vector<int>> transferFloors;
+
+    std::unique_ptr<DemandModel> demand;
+    long long parkDelayMs;
+    std::vector<char> idleCars;
+    std::vector<unsigned> idleGenerations;
+
+    /* Private methods */
+    void validateFloorNum(int) const;
+    void validateBankNum(int) const;
+
+    void groupBanks();
+    void setBankHallCall(int floorNum, Direction, bool active, int bankNum);
+    void pressLegHallCalls(int originFloorNum, int legFloorNum);
+
+    void markDirty(int carIndex);
+    void scheduleDispatch();
+    void dispatchPass();
+    template <class Policy>
+    void moveDirtyCars();
+
+    void assignHallCalls();
+    void setAssignee(int floorNum, Direction, int carId, int bankNum);
+    void refreshAssignedStop(int carId, int floorNum);
+
+    int assignDestination(int originFloorNum, int destinationFloorNum,
+                          int prevCarId);
+    void assignPendingDestinations();
+    int pickLeastEnergy(
+        const std::vector<std::pair<int, long long>> &candidates,
+        int floorNum) const;
+    void trackIdle(int carIndex);
+    void scheduleParking(int carIndex);
+    void parkIfIdle(int carIndex, unsigned generation);
+    long long destinationCostMs(int carIndex, int originFloorNum,
+                                int destinationFloorNum) const;
+    void pickUpDestinations(const SimElevator &);
+    void notifyDestinationAssigned(int originFloorNum,
+                                   int destinationFloorNum, int prevCarId,
+                                   int carId);
+};
+
+#endif /* SIMBUILDING_H */
@@ -0,0 +1,628 @@
+#include "SimElevator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#include "DispatchPolicy.h"
+#include "EnergyModel.h"
+#include "FlightTable.h"
+#include "SimBuilding.h"
+#include "SimObserver.h"
+#include "SimScheduler.h"
+
+SimElevator::SimElevator(int carId, int initialFloorNum,
+                         SimBuilding *parentBuilding, const CarConfig &config)
+    : carId(carId),
+      currentFloorNum(initialFloorNum),
+      config(config),
+      flights(parentBuilding->flightTableFor(config)),
+      energyModel(config, flights),
+      parentBuilding(parentBuilding),
+      currentMovement(MovementState::STOPPED),
+      currentDoor(DoorState::CLOSED),
+      currentEmergency(EmergencyState::NONE),
+      carCalls(parentBuilding->floorCount),
+      servedFloors(parentBuilding->floorCount),
+      fireAlarmActive(false),
+      doorObstacleActive(false),
+      helpActive(false),
+      overloadActive(false),
+      loadKg(0),
+      passengerCount(0),
+      doorHoldMs(0),
+      doorCloseFailures(0),
+      timerGenerations{0, 0, 0},
+      runFromFloorNum(initialFloorNum),
+      runTargetFloorNum(FloorBitset::NO_FLOOR),
+      runStartMs(0),
+      parkFloorNum(FloorBitset::NO_FLOOR),
+      travelDir(Direction::NONE),
+      energy(),
+      energyFromFloorNum(initialFloorNum),
+      energySinceMs(parentBuilding->getScheduler().now()) {
+    if (config.movementMs < 1 || config.doorSpeedMs < 1 ||
+        config.doorWaitMs < 1)
+        throw "ERROR: Car timings must be at least 1 millisecond";
+    if (config.ratedLoadKg < 1 || config.transferMs < 1)
+        throw "ERROR: Car rated load and transfer time must be positive";
+    if (config.doorCloseFailThreshold < 1)
+        throw "ERROR: Door close failure threshold must be at least 1";
+    for (int floorNum : config.servedFloorNums) {
+        if (!parentBuilding->isFloorNum(floorNum))
+            throw "ERROR: Served floor number doesn't exist";
+        servedFloors.set(floorNum, true);
+    }
+    if (config.servedFloorNums.empty())
+        for (int floorNum = 1; floorNum <= parentBuilding->floorCount;
+             ++floorNum)
+            servedFloors.set(floorNum, true);
+    if (!servedFloors.test(initialFloorNum))
+        throw "ERROR: Car starts on a floor it doesn't serve";
+
+    bool safeFloorServed = false;
+    for (int floorNum : config.safeFloorNums) {
+        if (!parentBuilding->isFloorNum(floorNum))
+            throw "ERROR: Safe floor number doesn't exist";
+        if (servedFloors.test(floorNum)) safeFloorServed = true;
+    }
+    if (!safeFloorServed)
+        throw "ERROR: Car needs at least one safe floor it serves";
+}
+
+SimElevator::MovementState SimElevator::getMovement() const {
+    return currentMovement;
+}
+Direction SimElevator::getTravelDirection() const { return travelDir; }
+SimElevator::DoorState SimElevator::getDoorState() const { return currentDoor; }
+SimElevator::EmergencyState SimElevator::getEmergency() const {
+    return currentEmergency;
+}
+int SimElevator::getDoorCloseFailures() const { return doorCloseFailures; }
+
+bool SimElevator::hasCarCall(int floorNum) const {
+    if (!parentBuilding->isFloorNum(floorNum))
+        throw "ERROR: Car call floor number doesn't exist";
+    return carCalls.test(floorNum);
+}
+
+void SimElevator::setCarCall(int floorNum, bool active) {
+    if (!parentBuilding->isFloorNum(floorNum))
+        throw "ERROR: Car call floor number doesn't exist";
+    if (active && !servedFloors.test(floorNum))
+        throw "ERROR: Car doesn't stop at that floor";
+
+    if (carCalls.set(floorNum, active)) {
+        if (hooks.carCallChanged) hooks.carCallChanged(floorNum, active);
+        for (SimObserver *observer : parentBuilding->getObservers())
+            observer->carCallChanged(*this, floorNum, active);
+
+        // Destination panel changes only concern this car.
+        parentBuilding->elevatorDataChanged(*this);
+    }
+}
+
+const FloorBitset &SimElevator::getCarCalls() const { return carCalls; }
+
+bool SimElevator::servesFloor(int floorNum) const {
+    return parentBuilding->isFloorNum(floorNum) && servedFloors.test(floorNum);
+}
+const FloorBitset &SimElevator::getServedFloors() const {
+    return servedFloors;
+}
+
+bool SimElevator::fireAlarm() const { return fireAlarmActive; }
+bool SimElevator::doorObstacle() const { return doorObstacleActive; }
+bool SimElevator::helpRequested() const { return helpActive; }
+bool SimElevator::overloaded() const { return overloadActive; }
+
+void SimElevator::setFireAlarm(bool active) {
+    if (fireAlarmActive != active) {
+        fireAlarmActive = active;
+        updateEmergency();
+    }
+}
+void SimElevator::setDoorObstacle(bool active) {
+    if (doorObstacleActive != active) {
+        doorObstacleActive = active;
+        updateEmergency();
+    }
+}
+void SimElevator::setHelpRequested(bool active) {
+    if (helpActive != active) {
+        helpActive = active;
+        updateEmergency();
+    }
+}
+void SimElevator::setOverloaded(bool active) {
+    if (overloadActive != active) {
+        overloadActive = active;
+        updateEmergency();
+    }
+}
+
+int SimElevator::getLoadKg() const { return loadKg; }
+int SimElevator::getPassengerCount() const { return passengerCount; }
+
+void SimElevator::setLoad(int newLoadKg, int newPassengerCount) {
+    if (newLoadKg < 0 || newPassengerCount < 0)
+        throw "ERROR: Car load can't be negative";
+
+    if (loadKg != newLoadKg || passengerCount != newPassengerCount) {
+        loadKg = newLoadKg;
+        passengerCount = newPassengerCount;
+        updateEmergency();
+        notifyDataChanged();  // Fullness matters to dispatch
+    }
+}
+
+int SimElevator::ratedPersons() const {
+    return std::max(1, config.ratedLoadKg / personMassKg);
+}
+
+bool SimElevator::isOverweight() const { return loadKg > config.ratedLoadKg; }
+
+bool SimElevator::isFull() const {
+    return loadKg * 100LL >=
+               config.ratedLoadKg * (long long)loadBypassPercent ||
+           passengerCount >= ratedPersons();
+}
+
+bool SimElevator::isInService() const {
+    // Help requests don't stop the car, any other emergency does.
+    return currentEmergency == EmergencyState::NONE ||
+           currentEmergency == EmergencyState::HELP;
+}
+
+void SimElevator::holdDoors(long long holdMs) {
+    doorHoldMs = std::max(doorHoldMs, holdMs);
+
+    // Already open: the hold counts from now.
+    if (currentDoor == DoorState::OPEN) startTimer(Timer::DOOR_WAIT);
+}
+
+EnergyModel::EnergyUse SimElevator::getEnergy() const {
+    EnergyModel::EnergyUse use = energy;
+    use.standbyJ = energyModel.standbyJ(parentBuilding->getScheduler().now() -
+                                        energySinceMs);
+    return use;
+}
+
+bool SimElevator::isIdle() const {
+    return isInService() && !isMoving() && currentDoor == DoorState::CLOSED &&
+           parkFloorNum == FloorBitset::NO_FLOOR &&
+           nearestQueuedFloor(Direction::UP) == FloorBitset::NO_FLOOR &&
+           nearestQueuedFloor(Direction::DOWN) == FloorBitset::NO_FLOOR;
+}
+
+int SimElevator::getParkFloorNum() const { return parkFloorNum; }
+
+void SimElevator::setParkFloor(int floorNum) {
+    if (floorNum != FloorBitset::NO_FLOOR && !servesFloor(floorNum))
+        throw "ERROR: Car doesn't stop at that floor";
+
+    if (parkFloorNum != floorNum) {
+        parkFloorNum = floorNum;
+        parentBuilding->elevatorDataChanged(*this);
+    }
+}
+
+bool SimElevator::isMoving() const {
+    return currentMovement != MovementState::STOPPED;
+}
+
+bool SimElevator::isInRun() const {
+    return runTargetFloorNum != FloorBitset::NO_FLOOR;
+}
+
+int SimElevator::floorNumAt(long long timeMs) const {
+    if (!isInRun()) return currentFloorNum;
+
+    int floors = std::abs(runTargetFloorNum - runFromFloorNum);
+    int passed = flights.floorsPassed(floors, timeMs - runStartMs);
+    return runFromFloorNum +
+           (runTargetFloorNum > runFromFloorNum ? passed : -passed);
+}
+
+void SimElevator::updatePosition() {
+    int floorNum = floorNumAt(parentBuilding->getScheduler().now());
+    if (floorNum != currentFloorNum) {
+        currentFloorNum = floorNum;
+        notifyDataChanged();
+    }
+}
+
+bool SimElevator::isAtSafeFloor() const {
+    return std::find(config.safeFloorNums.begin(), config.safeFloorNums.end(),
+                     currentFloorNum) != config.safeFloorNums.end();
+}
+
+int SimElevator::nearestSafeFloor() const {
+    // The constructor made sure the car serves at least one.
+    int nearest = FloorBitset::NO_FLOOR;
+    for (int floorNum : config.safeFloorNums) {
+        if (!servedFloors.test(floorNum)) continue;
+        if (nearest == FloorBitset::NO_FLOOR) nearest = floorNum;
+
+        int distance = std::abs(floorNum - currentFloorNum);
+        int bestDistance = std::abs(nearest - currentFloorNum);
+        if (distance < bestDistance ||
+            (distance == bestDistance && floorNum < nearest))
+            nearest = floorNum;
+    }
+    return nearest;
+}
+
+void SimElevator::timerExpired(Timer timer) {
+    switch (timer) {
+        case Timer::MOVEMENT:
+            // A kinematic run ends at its stop, the next one starts afresh.
+            if (isInRun()) {
+                stopTimer(Timer::MOVEMENT);
+                currentFloorNum = runTargetFloorNum;
+                runTargetFloorNum = FloorBitset::NO_FLOOR;
+                accrueRun();
+                notifyDataChanged();
+                break;
+            }
+
+            // Elevator movement complete
+            switch (currentMovement) {
+                case MovementState::UPWARDS:
+                    // Elevator finishes upward movement.
+                    ++currentFloorNum;
+                    notifyDataChanged();
+                    break;
+                case MovementState::DOWNWARDS:
+                    // Elevator finishes downward movement.
+                    --currentFloorNum;
+                    notifyDataChanged();
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case Timer::DOOR_SPEED:
+            // Door transition complete. The door only moves again when
+            // restarted, so stop the timer instead of letting it idle.
+            stopTimer(Timer::DOOR_SPEED);
+
+            switch (currentDoor) {
+                case DoorState::CLOSING:
+                    // Check sensors to see if door closure can be completed
+                    if (doorObstacleActive) {
+                        // Obstacle detected, abort and open again
+                        doorCloseFailures++;
+                        textOut(
+                            "(Light sensors detected obstacle! Failures: " +
+                            std::to_string(doorCloseFailures) + "/" +
+                            std::to_string(config.doorCloseFailThreshold) +
+                            ")");
+                        openDoors();
+                    } else {
+                        // Successfully closed
+                        doorCloseFailures = 0;
+                        setDoorState(DoorState::CLOSED);
+                    }
+
+                    // Door obstacle state may have been triggered or cleared
+                    updateEmergency();
+                    break;
+                case DoorState::OPENING:
+                    // Successfully opened
+                    setDoorState(DoorState::OPEN);
+
+                    startTimer(Timer::DOOR_WAIT);  // Start idle timer
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case Timer::DOOR_WAIT:
+            // Doors automatically closing
+            if (currentDoor == DoorState::OPEN) closeDoors();
+            break;
+        default:
+            throw "ERROR: Invalid timer enum";
+    }
+}
+
+template <class Policy>
+void SimElevator::determineMovement() {
+    updateEmergency();  // Update emergency state first
+
+    // Kinematic cars are committed to their stop until they reach it.
+    if (isInRun()) {
+        updatePosition();
+        return;
+    }
+
+    int targetFloor;
+
+    if (currentEmergency == EmergencyState::OVERLOAD) {
+        // Cannot leave until overload is resolved
+        parkFloorNum = FloorBitset::NO_FLOOR;
+        targetFloor = currentFloorNum;
+    } else if (currentEmergency == EmergencyState::FIRE ||
+               currentEmergency == EmergencyState::POWER_OUT) {
+        // Seek a safe floor, disregard queues.
+        parkFloorNum = FloorBitset::NO_FLOOR;
+        targetFloor = nearestSafeFloor();
+    } else {
+        // Nearest floors on either side with a floor button this car answers,
+        // or targeted by this elevator's destination button panel.
+        int below = nearestQueuedFloor(Direction::DOWN);
+        int above = nearestQueuedFloor(Direction::UP);
+
+        // No eligible floors queued: park, if told where, without opening.
+        if (below == FloorBitset::NO_FLOOR && above == FloorBitset::NO_FLOOR) {
+            if (parkFloorNum == currentFloorNum)
+                parkFloorNum = FloorBitset::NO_FLOOR;
+            if (parkFloorNum == FloorBitset::NO_FLOOR) {
+                setMovement(MovementState::STOPPED);
+                return;
+            }
+            targetFloor = parkFloorNum;
+        } else {
+            // Let the dispatch policy pick the floor to move to
+            parkFloorNum = FloorBitset::NO_FLOOR;
+            targetFloor = Policy::nextStop(*this, below, above);
+        }
+    }
+
+    if (currentFloorNum == targetFloor) {
+        // Stop elevator on current floor.
+        setMovement(MovementState::STOPPED);
+        openDoors();
+        setCarCall(currentFloorNum, false);
+        notifyArrived();
+    } else if (currentDoor == DoorState::CLOSED) {
+        // Elevator needs to go to a target, and is able to move.
+        if (currentFloorNum < targetFloor)
+            setMovement(MovementState::UPWARDS);
+        else if (currentFloorNum > targetFloor)
+            setMovement(MovementState::DOWNWARDS);
+
+        if (flights.isKinematic()) startRun(targetFloor);
+    }
+}
+
+// Built-in dispatch policies, see SimBuilding's registry
+template void SimElevator::determineMovement<NearestFloorPolicy>();
+template void SimElevator::determineMovement<CollectivePolicy>();
+
+void SimElevator::determineMovement() {
+    determineMovement<NearestFloorPolicy>();
+}
+
+void SimElevator::ring() { textOut("*ring!*"); }
+
+void SimElevator::openDoors() {
+    // Only attempt to open doors if the elevator is not moving
+    if (isMoving()) return;
+
+    switch (currentDoor) {
+        case DoorState::CLOSED:
+        case DoorState::CLOSING:
+            // Start opening the doors and ring bell
+            setDoorState(DoorState::OPENING);
+            startTimer(Timer::DOOR_SPEED);  // Start door movement
+            ring();
+            break;
+        case DoorState::OPEN:
+            // Extend open time (reset timer)
+            startTimer(Timer::DOOR_WAIT);
+            break;
+        case DoorState::OPENING:
+            // Already opening, no effect.
+            break;
+        default:
+            throw "ERROR: Elevator in impossible DoorState";
+            break;
+    }
+}
+
+void SimElevator::closeDoors() {
+    // Doors would already be closed if elevator is moving,
+    // and doors should stay open in applicable emergency states
+    if (isMoving() || currentEmergency == EmergencyState::OVERLOAD ||
+        ((currentEmergency == EmergencyState::FIRE ||
+          currentEmergency == EmergencyState::POWER_OUT) &&
+         isAtSafeFloor()))
+        return;
+
+    switch (currentDoor) {
+        case DoorState::OPEN:
+        case DoorState::OPENING:
+            // Start closing the doors and ring bell
+            doorHoldMs = 0;
+            setDoorState(DoorState::CLOSING);
+            stopTimer(Timer::DOOR_WAIT);    // Door timeout not relevant anymore
+            startTimer(Timer::DOOR_SPEED);  // Start door movement
+            ring();
+            break;
+        case DoorState::CLOSED:
+        case DoorState::CLOSING:
+            // Already closing or closed, no effect.
+            break;
+        default:
+            throw "ERROR: Elevator in impossible DoorState";
+            break;
+    }
+}
+
+void SimElevator::setMovement(MovementState newMovement) {
+    if (currentMovement != newMovement) {
+        // A run ends when the car stops or turns around.
+        if (isMoving()) accrueRun();
+        energyFromFloorNum = currentFloorNum;
+        currentMovement = newMovement;
+        if (newMovement == MovementState::UPWARDS)
+            travelDir = Direction::UP;
+        else if (newMovement == MovementState::DOWNWARDS)
+            travelDir = Direction::DOWN;
+
+        // Kinematic cars time whole runs instead, see startRun().
+        if (!isMoving())
+            stopTimer(Timer::MOVEMENT);
+        else if (!flights.isKinematic())
+            startTimer(Timer::MOVEMENT);
+
+        for (SimObserver *observer : parentBuilding->getObservers())
+            observer->movementChanged(*this);
+        notifyDataChanged();
+    }
+}
+
+void SimElevator::setDoorState(DoorState newDoorState) {
+    if (currentDoor != newDoorState) {
+        currentDoor = newDoorState;
+        if (currentDoor == DoorState::OPENING ||
+            currentDoor == DoorState::CLOSING)
+            energy.doorJ += energyModel.doorStrokeJ();
+
+        for (SimObserver *observer : parentBuilding->getObservers())
+            observer->doorStateChanged(*this);
+        notifyDataChanged();
+    }
+}
+
+void SimElevator::accrueRun() {
+    Direction dir = (currentMovement == MovementState::UPWARDS)
+                        ? Direction::UP
+                        : Direction::DOWN;
+    energy += energyModel.run(std::abs(currentFloorNum - energyFromFloorNum),
+                              dir, loadKg);
+    energyFromFloorNum = currentFloorNum;
+}
+
+int SimElevator::nearestQueuedFloor(Direction searchDir) const {
+    int hallFloor = parentBuilding->nearestServedHallCall(*this, searchDir);
+
+    if (searchDir == Direction::UP) {
+        int carFloor = carCalls.nextAtOrAbove(currentFloorNum);
+
+        // Lowest of the floors found above
+        if (hallFloor == FloorBitset::NO_FLOOR) return carFloor;
+        if (carFloor == FloorBitset::NO_FLOOR) return hallFloor;
+        return std::min(hallFloor, carFloor);
+    } else {
+        int carFloor = carCalls.nextAtOrBelow(currentFloorNum);
+
+        // Highest of the floors found below (NO_FLOOR is lowest)
+        return std::max(hallFloor, carFloor);
+    }
+}
+
+void SimElevator::updateEmergency() {
+    EmergencyState newState;
+
+    // Earlier cases take priority when multiple are active.
+    if (overloadActive || isOverweight()) {
+        // Overload has first priority, elevator cannot move when overloaded
+        newState = EmergencyState::OVERLOAD;
+    } else if (parentBuilding->buildingPowerOut()) {
+        // Power out in building
+        newState = EmergencyState::POWER_OUT;
+    } else if (fireAlarmActive || parentBuilding->buildingOnFire()) {
+        // Fire in elevator or building
+        newState = EmergencyState::FIRE;
+    } else if (doorCloseFailures >= config.doorCloseFailThreshold) {
+        // Enough door close failures accumulated, start door obstacle state
+        newState = EmergencyState::DOOR_OBSTACLE;
+    } else if (helpActive) {
+        // Help button pressed, connect to safety services or 911.
+        newState = EmergencyState::HELP;
+    } else {
+        // No applicable emergencies
+        newState = EmergencyState::NONE;
+    }
+
+    if (currentEmergency != newState) {
+        currentEmergency = newState;
+
+        // Audio warnings (using text output instead of actual audio output)
+        switch (currentEmergency) {
+            case EmergencyState::FIRE:
+                textOut("A fire has been detected. Moving towards safe floor.");
+                break;
+            case EmergencyState::POWER_OUT:
+                textOut(
+                    "A power outage has been detected. Moving towards safe "
+                    "floor.");
+                break;
+            case EmergencyState::OVERLOAD:
+                textOut("Overload. Please reduce the load.");
+                break;
+            case EmergencyState::DOOR_OBSTACLE:
+                textOut("Door obstacle detected. Please clear the doorway.");
+                break;
+            case EmergencyState::HELP:
+                textOut("(connected to building safety service or 911)");
+                break;
+            case EmergencyState::NONE:
+            default:
+                break;
+        }
+
+        notifyDataChanged();
+    }
+}
+
+void SimElevator::notifyDataChanged() {
+    // Elevator changes mean building data has changed
+    parentBuilding->elevatorStateChanged(*this);
+    if (hooks.dataChanged) hooks.dataChanged();
+}
+
+void SimElevator::notifyArrived() {
+    parentBuilding->elevatorArrived(*this);
+    if (hooks.arrived) hooks.arrived();
+}
+
+void SimElevator::textOut(const std::string &text) {
+    if (hooks.textOut) hooks.textOut(text);
+}
+
+long long SimElevator::timerIntervalMs(Timer timer) const {
+    switch (timer) {
+        case Timer::MOVEMENT:
+            if (isInRun())
+                return flights.flightMs(
+                    std::abs(runTargetFloorNum - runFromFloorNum));
+            return config.movementMs;
+        case Timer::DOOR_SPEED:
+            return config.doorSpeedMs;
+        case Timer::DOOR_WAIT:
+            return std::max((long long)config.doorWaitMs, doorHoldMs);
+        default:
+            throw "ERROR: Invalid timer enum";
+    }
+}
+
+void SimElevator::startTimer(Timer timer) {
+    // Restarting invalidates any expiry already scheduled
+    scheduleExpiry(timer, ++timerGenerations[int(timer)]);
+}
+
+void SimElevator::stopTimer(Timer timer) { ++timerGenerations[int(timer)]; }
+
+void SimElevator::scheduleExpiry(Timer timer, unsigned generation) {
+    parentBuilding->getScheduler().schedule(
+        timerIntervalMs(timer), [this, timer, generation]() {
+            // Timer was stopped or restarted since, ignore.
+            if (timerGenerations[int(timer)] != generation) return;
+
+            // Periodic: schedule the next expiry before handling this one,
+            // handling it may stop or restart the timer.
+            scheduleExpiry(timer, generation);
+            timerExpired(timer);
+        });
+}
+
+void SimElevator::startRun(int targetFloorNum) {
+    runFromFloorNum = currentFloorNum;
+    runTargetFloorNum = targetFloorNum;
+    runStartMs = parentBuilding->getScheduler().now();
+    startTimer(Timer::MOVEMENT);
+}
@@ -0,0 +1,395 @@
+#ifndef SIMELEVATOR_H
+#define SIMELEVATOR_H
+
+#include <functional>
+#include <string>
+
+#include "CarConfig.h"
+#include "Direction.h"
+#include "EnergyModel.h"
+#include "FloorBitset.h"
+
+// Forward declarations
+class FlightTable;
+class SimBuilding;
+
+/** Widget-free elevator car state machine.
+ *
+ * Plain C++ core of the elevator simulation, usable without a QApplication.
+ * Holds the car's calls, doors, movement and emergency state, and computes
+ * movement whenever the parent SimBuilding reports a change. Anything outside
+ * the engine (the Qt UI, batch drivers) is reached through hooks.
+ *
+ * A car without a motion profile moves one floor per movementMs, deciding at
+ * every floor whether to stop. A kinematic car (see FlightTable) commits to
+ * its next stop when it departs and flies there in one run, woken only on
+ * arrival; calls it passes on the way are answered on a later run. Its
+ * currentFloorNum catches up with the floors it passed whenever its state
+ * machine runs.
+ *
+ * Enums:
+ * + MovementState
+ *      Whether the elevator is moving, and to which direction.
+ * + DoorState
+ *      What state the elevator's doors can be in.
+ * + EmergencyState
+ *      The exceptional states the elevator can be in.
+ * + Timer
+ *      The timers the state machine relies on, run on the parent building's
+ *      SimScheduler. Timers are periodic: once started they expire every
+ *      interval until stopped or restarted.
+ *
+ * Data Members:
+ * + Hooks: struct
+ *      Callbacks invoked by the engine. Any of them may be left empty.
+ *      - dataChanged: an aspect of the elevator has changed.
+ *      - arrived: the elevator stopped at a floor to take passengers.
+ *      - carCallChanged: a destination panel call was set or cleared.
+ *      - textOut: text to be displayed or logged.
+ * + loadBypassPercent: int
+ *      Share of the rated load from which a car counts as full.
+ * + personMassKg: int
+ *      Weight per person of a rated load (EN 81-20), setting how many
+ *      persons a car has room for.
+ * + hooks: Hooks
+ *
+ * + carId: int
+ *      ID of the car, incrementing from 1.
+ * + currentFloorNum: int
+ *      The number of the floor the elevator is currently at.
+ *
+ * - parentBuilding: SimBuilding *
+ *      Pointer to the SimBuilding that the elevator exists in.
+ *
+ * - currentMovement: MovementState
+ * - currentDoor: DoorState
+ * - currentEmergency: EmergencyState
+ *      Current elevator movement, door and emergency state. Elevator can be
+ *      in one emergency state, with implementation-dependent priorities.
+ *
+ * - carCalls: FloorBitset
+ *      Floors with an active destination panel call.
+ * - servedFloors: FloorBitset
+ *      Floors the car stops at, from config.servedFloorNums.
+ *
+ * - fireAlarmActive: bool
+ * - doorObstacleActive: bool
+ * - helpActive: bool
+ * - overloadActive: bool
+ *      Emergency inputs of the car (sensors and passenger buttons).
+ *      overloadActive reports an overload regardless of the weighed load,
+ *      e.g. freight the passenger model doesn't know about.
+ *
+ * - loadKg: int
+ * - passengerCount: int
+ *      Load the car's weighing device measures, and the persons aboard.
+ *      Above config.ratedLoadKg the car is overloaded.
+ * - doorHoldMs: long long
+ *      Least time the doors stay open at the current stop for passengers to
+ *      transfer, 0 once they start closing.
+ *
+ * - doorCloseFailures: int
+ *      Number of failed attempts to close the door, incremented when the door
+ *      sensors detect an obstacle, reset to zero when the door successfully
+ *      closes.
+ *
+ * - timerGenerations: unsigned[]
+ *      Per-timer counter bumped on every start or stop. Scheduled expiries
+ *      carrying an older generation are stale and ignored.
+ *
+ * - runFromFloorNum / runTargetFloorNum: int
+ * - runStartMs: long long
+ *      Start floor, stop and start time of a kinematic car's current run.
+ *      runTargetFloorNum is FloorBitset::NO_FLOOR between runs.
+ * - parkFloorNum: int
+ *      Floor the car heads for while it has nothing to do, or
+ *      FloorBitset::NO_FLOOR.
+ * - travelDir: Direction
+ *      Direction of the car's current or last run, Direction::NONE before
+ *      its first.
+ *
+ * - energy: EnergyModel::EnergyUse
+ *      Energy used by the car's runs and doors so far.
+ * - energyFromFloorNum: int
+ *      Floor the current run started from, for its traction energy.
+ * - energySinceMs: long long
+ *      Scheduler time the car started drawing standby power at.
+ *
+ * + config: CarConfig
+ *      Timings, motion profile, door obstacle threshold and safe floors of
+ *      the car.
+ * + flights: const FlightTable &
+ *      Flight times of the car's motion profile, shared with the parent
+ *      building's other cars of the same profile.
+ * + energyModel: EnergyModel
+ *      Energy the car's runs, doors and standby take.
+ *
+ * Class Methods:
+ * + getMovement(): MovementState
+ * + getTravelDirection(): Direction
+ * + getDoorState(): DoorState
+ * + getEmergency(): EmergencyState
+ * + getDoorCloseFailures(): int
+ *      Getters for the current car state.
+ *
+ * + hasCarCall(int): bool
+ * + setCarCall(int, bool): void
+ *      Query or set the destination panel call for a floor number.
+ * + getCarCalls(): const FloorBitset &
+ *      Returns every floor with an active destination panel call.
+ * + servesFloor(int): bool
+ * + getServedFloors(): const FloorBitset &
+ *      Query the floors the car stops at. Only those take car calls.
+ *
+ * + fireAlarm() / setFireAlarm(bool)
+ * + doorObstacle() / setDoorObstacle(bool)
+ * + helpRequested() / setHelpRequested(bool)
+ * + overloaded() / setOverloaded(bool)
+ *      Query or set the car's emergency inputs.
+ *
+ * + getLoadKg(): int
+ * + getPassengerCount(): int
+ * + setLoad(int, int): void
+ *      Query or set the weighed load and the persons aboard. Throws if
+ *      either is negative.
+ * + ratedPersons(): int
+ *      Returns how many persons the rated load allows, at least 1.
+ * + isOverweight(): bool
+ *      Returns true if the load is above the rated load.
+ * + isFull(): bool
+ *      Returns true if the load reaches loadBypassPercent of the rated load,
+ *      or the car holds ratedPersons(). A full car no longer takes hall
+ *      calls.
+ * + isInService(): bool
+ *      Returns true if no emergency keeps the car from taking passengers.
+ *      Help requests don't.
+ * + holdDoors(long long): void
+ *      Keeps the doors open at the current stop for at least the given time
+ *      after they finish opening, or from now if they are open already.
+ * + getEnergy(): EnergyModel::EnergyUse
+ *      Returns the energy the car has used: its runs completed so far, door
+ *      strokes started, and standby up to the current time.
+ * + isIdle(): bool
+ *      Returns true if the car is in service, stopped with its doors
+ *      closed, and has nothing queued and no parking floor to go to.
+ * + getParkFloorNum(): int
+ * + setParkFloor(int): void
+ *      Query or set the floor the car goes to while idle, NO_FLOOR for
+ *      none. The car runs there without opening its doors, and forgets it
+ *      once there, or as soon as it has something queued or an emergency.
+ *      Throws if the car doesn't stop at the floor.
+ *
+ * + determineMovement<Policy>(): void
+ *      Examine the current elevator data and compute next movement, heading
+ *      for the queued floor the dispatch policy picks (see DispatchPolicy.h).
+ *      Instantiated for the built-in policies.
+ * + determineMovement(): void
+ *      Same, with the reference NearestFloorPolicy.
+ * + updateEmergency(): void
+ *      Checks the relevant data for applicable elevator emergency states at
+ *      that moment, and applies it to the elevator.
+ * + openDoors(): void
+ * + closeDoors(): void
+ *      Opens or closes the elevator's doors if it is currently possible to.
+ *
+ * + isMoving(): bool
+ *      Returns true if the elevator is currently moving.
+ * + isInRun(): bool
+ *      Returns true if a kinematic car is between stops.
+ * + floorNumAt(long long): int
+ *      Returns the floor the car is at, or has last passed, at a simulated
+ *      time no earlier than its last change. Read-only, for presenting a
+ *      kinematic car mid-run without touching the simulation.
+ * + updatePosition(): void
+ *      Catches a kinematic car's currentFloorNum up with the floors it has
+ *      passed on its run, notifying the change.
+ * + isAtSafeFloor(): bool
+ *      Returns true if the elevator is currently at a safe floor.
+ * + nearestSafeFloor(): int
+ *      Returns the safe floor the car serves closest to the current floor,
+ *      the lower one on a tie.
+ *
+ * - setMovement(MovementState): void
+ * - setDoorState(DoorState): void
+ *      Private setters that will invoke hooks or trigger responses on data
+ *      change. They accrue the energy of runs ending and door strokes.
+ * - accrueRun(): void
+ *      Adds the traction energy of the run since energyFromFloorNum, with
+ *      the current load, and starts the next one from the current floor.
+ *
+ * - nearestQueuedFloor(Direction): int
+ *      Returns the closest floor at or above (Direction::UP) or at or below
+ *      (Direction::DOWN) the current floor with a hall call the car answers
+ *      or a destination panel call, or FloorBitset::NO_FLOOR.
+ *
+ * - ring(): void
+ *      Rings the bell of the elevator.
+ *
+ * - timerExpired(Timer): void
+ *      Advances the state machine when one of its timers expires.
+ *
+ * - notifyDataChanged(): void
+ * - notifyArrived(): void
+ * - textOut(const std::string &): void
+ *      Inform the parent building and the hooks of a change.
+ * - startTimer(Timer): void
+ * - stopTimer(Timer): void
+ *      (Re)start or stop one of the car's timers.
+ * - scheduleExpiry(Timer, unsigned): void
+ *      Schedules the next expiry of a running timer on the scheduler.
+ * - timerIntervalMs(Timer): long long
+ *      Returns the interval of a timer, in milliseconds. A kinematic car's
+ *      movement timer lasts its whole run, the door wait timer lasts at
+ *      least doorHoldMs.
+ *
+ * - startRun(int): void
+ *      Starts a kinematic car's run from the current floor to a stop.
+ */
+class SimElevator {
+   public:
+    /* Public enums */
+    enum class MovementState { STOPPED, UPWARDS, DOWNWARDS };
+    enum class DoorState { CLOSED, CLOSING, OPENING, OPEN };
+    enum class EmergencyState {
+        NONE,
+        FIRE,
+        POWER_OUT,
+        OVERLOAD,
+        DOOR_OBSTACLE,
+        HELP
+    };
+    enum class Timer { MOVEMENT, DOOR_SPEED, DOOR_WAIT };
+
+    /* Public data structs */
+    typedef struct Hooks {
+        std::function<void()> dataChanged;
+        std::function<void()> arrived;
+        std::function<void(int floorNum, bool active)> carCallChanged;
+        std::function<void(const std::string &)> textOut;
+    } Hooks;
+
+    SimElevator(int carId, int initialFloorNum, SimBuilding *parentBuilding,
+                const CarConfig &config = CarConfig());
+
+    /* Public data members */
+    static const int loadBypassPercent = 80;
+    static const int personMassKg = 75;
+
+    Hooks hooks;
+
+    const int carId;
+    int currentFloorNum;
+
+    const CarConfig config;
+    const FlightTable &flights;
+    const EnergyModel energyModel;
+
+    /* Public methods */
+    MovementState getMovement() const;
+    Direction getTravelDirection() const;
+    DoorState getDoorState() const;
+    EmergencyState getEmergency() const;
+    int getDoorCloseFailures() const;
+
+    bool hasCarCall(int floorNum) const;
+    void setCarCall(int floorNum, bool active);
+    const FloorBitset &getCarCalls() const;
+    bool servesFloor(int floorNum) const;
+    const FloorBitset &getServedFloors() const;
+
+    bool fireAlarm() const;
+    bool doorObstacle() const;
+    bool helpRequested() const;
+    bool overloaded() const;
+
+    void setFireAlarm(bool);
+    void setDoorObstacle(bool);
+    void setHelpRequested(bool);
+    void setOverloaded(bool);
+
+    int getLoadKg() const;
+    int getPassengerCount() const;
+    void setLoad(int loadKg, int passengerCount);
+    int ratedPersons() const;
+    bool isOverweight() const;
+    bool isFull() const;
+    bool isInService() const;
+    void holdDoors(long long holdMs);
+    EnergyModel::EnergyUse getEnergy() const;
+    bool isIdle() const;
+    int getParkFloorNum() const;
+    void setParkFloor(int floorNum);
+
+    template <class Policy>
+    void determineMovement();
+    void determineMovement();
+    void updateEmergency();
+
+    void openDoors();
+    void closeDoors();
+
+    bool isMoving() const;
+    bool isInRun() const;
+    int floorNumAt(long long timeMs) const;
+    void updatePosition();
+    bool isAtSafeFloor() const;
+    int nearestSafeFloor() const;
+
+   private:
+    /* Private data members */
+    SimBuilding *const parentBuilding;
+
+    MovementState currentMovement;
+    DoorState currentDoor;
+    EmergencyState currentEmergency;
+
+    FloorBitset carCalls;
+    FloorBitset servedFloors;
+
+    bool fireAlarmActive;
+    bool doorObstacleActive;
+    bool helpActive;
+    bool overloadActive;
+
+    int loadKg;
+    int passengerCount;
+    long long doorHoldMs;
+
+    int doorCloseFailures;
+
+    unsigned timerGenerations[3];
+
+    int runFromFloorNum;
+    int runTargetFloorNum;
+    long long runStartMs;
+    int parkFloorNum;
+    Direction travelDir;
+
+    EnergyModel::EnergyUse energy;
+    int energyFromFloorNum;
+    const long long energySinceMs;
+
+    /* Private methods */
+    void setMovement(MovementState);
+    void setDoorState(DoorState);
+    void accrueRun();
+
+    int nearestQueuedFloor(Direction searchDir) const;
+
+    void ring();
+
+    void timerExpired(Timer);
+
+    void notifyDataChanged();
+    void notifyArrived();
+    void textOut(const std::string &);
+
+    void startTimer(Timer);
+    void stopTimer(Timer);
+    void scheduleExpiry(Timer, unsigned generation);
+    long long timerIntervalMs(Timer) const;
+
+    void startRun(int targetFloorNum);
+};
+
+#endif /* SIMELEVATOR_H */
@@ -0,0 +1,76 @@
+#include "SimInput.h"
+
+#include "SimBuilding.h"
+#include "SimElevator.h"
+
+SimInput SimInput::hallCall(int floorNum, Direction dir, bool active) {
+    return SimInput{Kind::HALL_CALL, 0, floorNum, dir, active, 0};
+}
+
+SimInput SimInput::carCall(int carId, int floorNum, bool active) {
+    return SimInput{Kind::CAR_CALL, carId, floorNum, Direction::NONE, active,
+                    0};
+}
+
+SimInput SimInput::carInput(Kind kind, int carId, bool active) {
+    return SimInput{kind, carId, 0, Direction::NONE, active, 0};
+}
+
+SimInput SimInput::buildingInput(Kind kind, bool active) {
+    return SimInput{kind, 0, 0, Direction::NONE, active, 0};
+}
+
+SimInput SimInput::destinationCall(int originFloorNum,
+                                   int destinationFloorNum) {
+    return SimInput{Kind::DESTINATION_CALL, 0, originFloorNum,
+                    Direction::NONE, true, destinationFloorNum};
+}
+
+void SimInput::apply(SimBuilding &building) const {
+    switch (kind) {
+        case Kind::HALL_CALL:
+            building.setHallCall(floorNum, dir, active);
+            return;
+        case Kind::BUILDING_FIRE:
+            building.setBuildingOnFire(active);
+            return;
+        case Kind::BUILDING_POWER_OUT:
+            building.setBuildingPowerOut(active);
+            return;
+        case Kind::DESTINATION_CALL:
+            building.requestDestination(floorNum, destinationFloorNum);
+            return;
+        default:
+            break;
+    }
+
+    // The rest concern a single car.
+    if (!building.isCarId(carId)) throw "ERROR: Input car ID doesn't exist";
+    SimElevator &car = building.getElevator_byCarId(carId);
+
+    switch (kind) {
+        case Kind::CAR_CALL:
+            car.setCarCall(floorNum, active);
+            break;
+        case Kind::OPEN_DOORS:
+            car.openDoors();
+            break;
+        case Kind::CLOSE_DOORS:
+            car.closeDoors();
+            break;
+        case Kind::FIRE_ALARM:
+            car.setFireAlarm(active);
+            break;
+        case Kind::DOOR_OBSTACLE:
+            car.setDoorObstacle(active);
+            break;
+        case Kind::HELP:
+            car.setHelpRequested(active);
+            break;
+        case Kind::OVERLOAD:
+            car.setOverloaded(active);
+            break;
+        default:
+            throw "ERROR: Unknown input kind";
+    }
+}
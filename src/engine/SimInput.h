@@ -0,0 +1,76 @@
+#ifndef SIMINPUT_H
+#define SIMINPUT_H
+
+#include "Direction.h"
+
+// Forward declarations
+class SimBuilding;
+
+/** An external input to the simulation, as a value.
+ *
+ * Every button a user can press maps to one input: hall calls, destination
+ * panel calls, floor kiosk requests, door overrides and emergency toggles.
+ * Keeping inputs as values lets them be applied, recorded to an
+ * InputJournal and replayed alike.
+ *
+ * Data Members:
+ * + Kind: enum
+ *      - HALL_CALL: floorNum, dir, active.
+ *      - CAR_CALL: carId, floorNum, active.
+ *      - OPEN_DOORS / CLOSE_DOORS: carId. Door override buttons.
+ *      - FIRE_ALARM / DOOR_OBSTACLE / HELP / OVERLOAD: carId, active.
+ *      - BUILDING_FIRE / BUILDING_POWER_OUT: active.
+ *      - DESTINATION_CALL: floorNum, destinationFloorNum. A floor kiosk
+ *        request, see SimBuilding::requestDestination().
+ * + kind: Kind
+ * + carId: int
+ * + floorNum: int
+ * + dir: Direction
+ * + active: bool
+ * + destinationFloorNum: int
+ *      Operands, 0 / Direction::NONE / false where unused.
+ *
+ * Class Methods:
+ * + hallCall(int, Direction, bool): SimInput
+ * + carCall(int, int, bool): SimInput
+ * + carInput(Kind, int, bool): SimInput
+ * + buildingInput(Kind, bool): SimInput
+ * + destinationCall(int, int): SimInput
+ *      Build an input of each shape.
+ * + apply(SimBuilding &): void
+ *      Applies the input to a building. Throws if it doesn't fit the
+ *      building, like the matching engine call would.
+ */
+typedef struct SimInput {
+    enum class Kind {
+        HALL_CALL,
+        CAR_CALL,
+        OPEN_DOORS,
+        CLOSE_DOORS,
+        FIRE_ALARM,
+        DOOR_OBSTACLE,
+        HELP,
+        OVERLOAD,
+        BUILDING_FIRE,
+        BUILDING_POWER_OUT,
+        DESTINATION_CALL
+    };
+
+    Kind kind;
+    int carId;
+    int floorNum;
+    Direction dir;
+    bool active;
+    int destinationFloorNum;
+
+    static SimInput hallCall(int floorNum, Direction, bool active);
+    static SimInput carCall(int carId, int floorNum, bool active);
+    static SimInput carInput(Kind, int carId, bool active = false);
+    static SimInput buildingInput(Kind, bool active);
+    static SimInput destinationCall(int originFloorNum,
+                                    int destinationFloorNum);
+
+    void apply(SimBuilding &) const;
+} SimInput;
+
+#endif /* SIMINPUT_H */
@@ -0,0 +1,157 @@
+#include "SimMetrics.h"
+
+#include <ostream>
+#include <vector>
+
+#include "SimBuilding.h"
+#include "SimElevator.h"
+
+namespace {
+
+// Records the deliveries of every handling capacity window ended by nowMs,
+// the current window's first, then empty ones.
+void closeWindows(long long nowMs, LogHistogram &handlingCapacity,
+                  long long &windowEndMs, unsigned long long &deliveries) {
+    while (windowEndMs <= nowMs) {
+        handlingCapacity.record((long long)deliveries);
+        deliveries = 0;
+        windowEndMs += MetricsReport::handlingWindowMs;
+    }
+}
+
+double toKWh(double joules) { return joules / 3.6e6; }
+
+}  // namespace
+
+SimMetrics::SimMetrics(SimBuilding *building)
+    : building(building),
+      startMs(building->getScheduler().now()),
+      windowEndMs(startMs + MetricsReport::handlingWindowMs),
+      windowDeliveries(0) {
+    collected.runs = 1;
+    collected.cars.assign(building->elevatorCount, CarStats());
+    cars.assign(building->elevatorCount,
+                CarTracking{startMs, false, false, Direction::NONE});
+
+    for (int e_ind = 0; e_ind < building->elevatorCount; ++e_ind) {
+        const SimElevator &car = building->getElevator_byCarId(e_ind + 1);
+        accumulate(e_ind, car);
+        startEnergy.push_back(car.getEnergy());
+    }
+    building->addObserver(this);
+}
+
+SimMetrics::~SimMetrics() { building->removeObserver(this); }
+
+long long SimMetrics::elapsedMs() const {
+    return building->getScheduler().now() - startMs;
+}
+
+const LogHistogram &SimMetrics::getWaitTimes() const {
+    return collected.waitTimes;
+}
+const LogHistogram &SimMetrics::getRideTimes() const {
+    return collected.rideTimes;
+}
+const LogHistogram &SimMetrics::getJourneyTimes() const {
+    return collected.journeyTimes;
+}
+
+SimMetrics::CarStats SimMetrics::getCarStats(int carId) const {
+    if (!building->isCarId(carId)) throw "ERROR: Car ID doesn't exist";
+
+    // Include the time spent in the current state so far.
+    const CarTracking &tracking = cars[carId - 1];
+    CarStats stats = collected.cars[carId - 1];
+    long long sinceChange =
+        building->getScheduler().now() - tracking.lastChangeMs;
+    if (tracking.moving) stats.movingMs += sinceChange;
+    if (tracking.busy) stats.busyMs += sinceChange;
+
+    EnergyModel::EnergyUse energy =
+        building->getElevator_byCarId(carId).getEnergy();
+    const EnergyModel::EnergyUse &start = startEnergy[carId - 1];
+    stats.tractionKWh = toKWh(energy.tractionJ - start.tractionJ);
+    stats.regeneratedKWh = toKWh(energy.regeneratedJ - start.regeneratedJ);
+    stats.doorKWh = toKWh(energy.doorJ - start.doorJ);
+    stats.standbyKWh = toKWh(energy.standbyJ - start.standbyJ);
+    return stats;
+}
+
+MetricsReport SimMetrics::report() const {
+    MetricsReport snapshot = collected;
+    snapshot.elapsedMs = elapsedMs();
+
+    long long endMs = windowEndMs;
+    unsigned long long deliveries = windowDeliveries;
+    closeWindows(building->getScheduler().now(), snapshot.handlingCapacity,
+                 endMs, deliveries);
+    for (int carId = 1; carId <= building->elevatorCount; ++carId)
+        snapshot.cars[carId - 1] = getCarStats(carId);
+    return snapshot;
+}
+
+void SimMetrics::writeJson(std::ostream &out) const {
+    report().writeJson(out);
+}
+
+void SimMetrics::writeCsv(std::ostream &out) const { report().writeCsv(out); }
+
+void SimMetrics::accumulate(int carIndex, const SimElevator &car) {
+    CarTracking &tracking = cars[carIndex];
+    CarStats &stats = collected.cars[carIndex];
+
+    long long now = building->getScheduler().now();
+    long long sinceChange = now - tracking.lastChangeMs;
+    if (tracking.moving) stats.movingMs += sinceChange;
+    if (tracking.busy) stats.busyMs += sinceChange;
+
+    tracking.lastChangeMs = now;
+    tracking.moving = car.isMoving();
+    tracking.busy = tracking.moving ||
+                    car.getDoorState() != SimElevator::DoorState::CLOSED;
+}
+
+void SimMetrics::elevatorArrived(const SimElevator &car) {
+    ++collected.cars[car.carId - 1].stops;
+}
+
+void SimMetrics::movementChanged(const SimElevator &car) {
+    accumulate(car.carId - 1, car);
+
+    // A trip is a run of travel in one direction.
+    Direction dir = Direction::NONE;
+    if (car.getMovement() == SimElevator::MovementState::UPWARDS)
+        dir = Direction::UP;
+    else if (car.getMovement() == SimElevator::MovementState::DOWNWARDS)
+        dir = Direction::DOWN;
+
+    CarTracking &tracking = cars[car.carId - 1];
+    if (dir != Direction::NONE && dir != tracking.tripDir) {
+        ++collected.cars[car.carId - 1].trips;
+        tracking.tripDir = dir;
+    }
+}
+
+void SimMetrics::doorStateChanged(const SimElevator &car) {
+    accumulate(car.carId - 1, car);
+
+    if (car.getDoorState() == SimElevator::DoorState::OPENING)
+        ++collected.cars[car.carId - 1].doorCycles;
+}
+
+void SimMetrics::passengerBoarded(const SimElevator &,
+                                  const Passenger &passenger) {
+    collected.waitTimes.record(passenger.boardedMs - passenger.arrivalMs);
+}
+
+void SimMetrics::passengerAlighted(const SimElevator &,
+                                   const Passenger &passenger) {
+    long long now = building->getScheduler().now();
+    collected.rideTimes.record(now - passenger.boardedMs);
+    collected.journeyTimes.record(now - passenger.arrivalMs);
+
+    closeWindows(now, collected.handlingCapacity, windowEndMs,
+                 windowDeliveries);
+    ++windowDeliveries;
+}
@@ -0,0 +1,126 @@
+#ifndef SIMMETRICS_H
+#define SIMMETRICS_H
+
+#include <ostream>
+#include <vector>
+
+#include "Direction.h"
+#include "EnergyModel.h"
+#include "LogHistogram.h"
+#include "MetricsReport.h"
+#include "SimObserver.h"
+
+// Forward declarations
+class SimBuilding;
+class SimElevator;
+
+/** Service-level metrics of a simulation run.
+ *
+ * Observer collecting passenger latencies and per-car activity from the
+ * simulation events, at a few counter updates per event. Latencies are kept
+ * in LogHistograms, so memory stays constant however long the run. Passenger
+ * latencies need passengers, i.e. a TrafficGenerator on the same building.
+ * Collection starts at the scheduler's time when constructed.
+ *
+ * Data Members:
+ * + CarStats: MetricsReport::CarStats
+ *      Activity of one car since collection started.
+ *
+ * - building: SimBuilding *
+ *      Building observed. Must outlive the metrics.
+ * - startMs: long long
+ *      Scheduler time collection started at.
+ * - startEnergy: std::vector<EnergyModel::EnergyUse>
+ *      Energy each car had used when collection started, by car ID - 1.
+ * - collected: MetricsReport
+ *      Metrics collected so far, except time in the cars' current states
+ *      and the current handling capacity window.
+ * - windowEndMs: long long
+ * - windowDeliveries: unsigned long long
+ *      End of the current handling capacity window, and the passengers
+ *      delivered in it so far.
+ *
+ * - CarTracking: struct
+ *      State and time of a car's last change, to accumulate the time spent
+ *      in each state.
+ * - cars: std::vector<CarTracking>
+ *      Indexed by car ID - 1.
+ *
+ * Class Methods:
+ * + elapsedMs(): long long
+ *      Simulated time since collection started.
+ * + getWaitTimes(): const LogHistogram &
+ * + getRideTimes(): const LogHistogram &
+ * + getJourneyTimes(): const LogHistogram &
+ *      Passenger latency histograms.
+ * + getCarStats(int): CarStats
+ *      Activity of a car by ID, up to the current time.
+ *
+ * + report(): MetricsReport
+ *      Snapshot of every metric up to the current time, as one run.
+ * + writeJson(std::ostream &): void
+ * + writeCsv(std::ostream &): void
+ *      Export the snapshot (see MetricsReport).
+ *
+ * + elevatorArrived, movementChanged, doorStateChanged, passengerBoarded,
+ *   passengerAlighted: void
+ *      SimObserver overrides updating the metrics.
+ *
+ * - accumulate(int, const SimElevator &): void
+ *      Adds the time since the car's last change to its state totals, then
+ *      records its new state.
+ */
+class SimMetrics : public SimObserver {
+   public:
+    /* Public data structs */
+    typedef MetricsReport::CarStats CarStats;
+
+    explicit SimMetrics(SimBuilding *building);
+    ~SimMetrics() override;
+
+    SimMetrics(const SimMetrics &) = delete;
+    SimMetrics &operator=(const SimMetrics &) = delete;
+
+    /* Public methods */
+    long long elapsedMs() const;
+
+    const LogHistogram &getWaitTimes() const;
+    const LogHistogram &getRideTimes() const;
+    const LogHistogram &getJourneyTimes() const;
+
+    CarStats getCarStats(int carId) const;
+
+    MetricsReport report() const;
+    void writeJson(std::ostream &) const;
+    void writeCsv(std::ostream &) const;
+
+    void elevatorArrived(const SimElevator &) override;
+    void movementChanged(const SimElevator &) override;
+    void doorStateChanged(const SimElevator &) override;
+    void passengerBoarded(const SimElevator &, const Passenger &) override;
+    void passengerAlighted(const SimElevator &, const Passenger &) override;
+
+   private:
+    /* Private data structs */
+    typedef struct CarTracking {
+        long long lastChangeMs;
+        bool moving;
+        bool busy;
+        Direction tripDir;
+    } CarTracking;
+
+    /* Private data members */
+    SimBuilding *const building;
+    const long long startMs;
+    std::vector<EnergyModel::EnergyUse> startEnergy;
+
+    MetricsReport collected;
+    long long windowEndMs;
+    unsigned long long windowDeliveries;
+    std::vector<CarTracking> cars;
+
+    /* Private methods */
+    void accumulate(int carIndex, const SimElevator &);
+};
+
+#endif /* SIMMETRICS_H */
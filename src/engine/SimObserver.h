@@ -0,0 +1,56 @@
+#ifndef SIMOBSERVER_H
+#define SIMOBSERVER_H
+
+#include "Direction.h"
+#include "Passenger.h"
+
+// Forward declarations
+class SimElevator;
+
+/** Passive listener of simulation events.
+ *
+ * Registered on a SimBuilding with addObserver(); any number of observers
+ * (traffic generators, metrics, journals) can listen at once, unlike the
+ * single-owner Hooks used by the presenting UI. Every method defaults to
+ * doing nothing, so observers only override what they need.
+ *
+ * Class Methods:
+ * + hallCallChanged(int, Direction, bool): void
+ *      A floor's UP/DOWN call was set or cleared.
+ * + carCallChanged(const SimElevator &, int, bool): void
+ *      A car's destination panel call was set or cleared.
+ * + destinationAssigned(int, int, int, int): void
+ *      A destination request from a floor kiosk (origin, destination) moved
+ *      from one car to another, by car ID. 0 stands for no car: a new request
+ *      comes from car 0, and one waiting for a car goes to car 0.
+ * + elevatorArrived(const SimElevator &): void
+ *      A car stopped at its current floor to take passengers, before that
+ *      floor's hall calls are cleared.
+ * + movementChanged(const SimElevator &): void
+ * + doorStateChanged(const SimElevator &): void
+ *      A car's movement / door state changed. The car holds the new state.
+ *
+ * + passengerBoarded(const SimElevator &, const Passenger &): void
+ * + passengerAlighted(const SimElevator &, const Passenger &): void
+ *      A generated passenger got on / off a car, at the car's current floor.
+ */
+class SimObserver {
+   public:
+    virtual ~SimObserver() {}
+
+    virtual void hallCallChanged(int /*floorNum*/, Direction, bool /*active*/) {
+    }
+    virtual void carCallChanged(const SimElevator &, int /*floorNum*/,
+                                bool /*active*/) {}
+    virtual void destinationAssigned(int /*originFloorNum*/,
+                                     int /*destinationFloorNum*/,
+                                     int /*prevCarId*/, int /*carId*/) {}
+    virtual void elevatorArrived(const SimElevator &) {}
+    virtual void movementChanged(const SimElevator &) {}
+    virtual void doorStateChanged(const SimElevator &) {}
+
+    virtual void passengerBoarded(const SimElevator &, const Passenger &) {}
+    virtual void passengerAlighted(const SimElevator &, const Passenger &) {}
+};
+
+#endif /* SIMOBSERVER_H */
@@ -0,0 +1,54 @@
+#include "SimScheduler.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+SimScheduler::SimScheduler()
+    : currentTime(0), nextSeq(0), processedCount(0) {}
+
+SimScheduler::TimeMs SimScheduler::now() const { return currentTime; }
+
+bool SimScheduler::empty() const { return queue.empty(); }
+
+SimScheduler::TimeMs SimScheduler::nextEventTime() const {
+    if (queue.empty()) throw "ERROR: No events pending in scheduler";
+    return queue.front().time;
+}
+
+unsigned long long SimScheduler::processedEvents() const {
+    return processedCount;
+}
+
+bool SimScheduler::laterThan(const Event &a, const Event &b) {
+    // Heap comparator: earliest time first, ties in scheduling order.
+    return a.time > b.time || (a.time == b.time && a.seq > b.seq);
+}
+
+void SimScheduler::schedule(TimeMs delayMs, Action action) {
+    if (delayMs < 0) throw "ERROR: Cannot schedule an event in the past";
+
+    queue.push_back(Event{currentTime + delayMs, nextSeq++, std::move(action)});
+    std::push_heap(queue.begin(), queue.end(), &SimScheduler::laterThan);
+}
+
+bool SimScheduler::runNext() {
+    if (queue.empty()) return false;
+
+    std::pop_heap(queue.begin(), queue.end(), &SimScheduler::laterThan);
+    Event event = std::move(queue.back());
+    queue.pop_back();
+
+    // Jump straight to the event
+    currentTime = event.time;
+    ++processedCount;
+    event.action();
+
+    return true;
+}
+
+void SimScheduler::runUntil(TimeMs time) {
+    while (!queue.empty() && queue.front().time <= time) runNext();
+
+    if (time > currentTime) currentTime = time;
+}
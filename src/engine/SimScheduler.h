@@ -0,0 +1,88 @@
+#ifndef SIMSCHEDULER_H
+#define SIMSCHEDULER_H
+
+#include <functional>
+#include <vector>
+
+/** Discrete-event scheduler driving the simulation on a virtual clock.
+ *
+ * Holds a priority queue of timestamped actions. Running the scheduler jumps
+ * the virtual clock straight from one event to the next, so simulated time
+ * passes as fast as the events can be processed. Events scheduled for the
+ * same time run in the order they were scheduled. Real-time pacing is left to
+ * the caller, by only running events up to a wall-clock derived time.
+ *
+ * Data Members:
+ * + TimeMs: long long
+ *      Virtual time, in milliseconds since the start of the simulation.
+ * + Action: std::function<void()>
+ *      Callback run when an event is due.
+ *
+ * - Event: struct
+ *      Queued action with its due time and scheduling order.
+ * - queue: std::vector<Event>
+ *      Min-heap of pending events, earliest first.
+ * - currentTime: TimeMs
+ *      Current virtual time.
+ * - nextSeq: unsigned long long
+ *      Sequence number given to the next scheduled event.
+ * - processedCount: unsigned long long
+ *      Number of events run so far.
+ *
+ * Class Methods:
+ * + now(): TimeMs
+ *      Returns the current virtual time.
+ * + empty(): bool
+ *      Returns true if no events are pending.
+ * + nextEventTime(): TimeMs
+ *      Returns the due time of the earliest pending event. Throws if empty.
+ * + processedEvents(): unsigned long long
+ *      Returns the number of events run so far.
+ *
+ * + schedule(TimeMs, Action): void
+ *      Queues an action to run after the given delay from now.
+ *
+ * + runNext(): bool
+ *      Advances the clock to the earliest event and runs it. Returns false if
+ *      no events were pending.
+ * + runUntil(TimeMs): void
+ *      Runs every event due at or before the given time, including events
+ *      scheduled along the way, then advances the clock to that time.
+ */
+class SimScheduler {
+   public:
+    typedef long long TimeMs;
+    typedef std::function<void()> Action;
+
+    SimScheduler();
+
+    /* Public methods */
+    TimeMs now() const;
+    bool empty() const;
+    TimeMs nextEventTime() const;
+    unsigned long long processedEvents() const;
+
+    void schedule(TimeMs delayMs, Action);
+
+    bool runNext();
+    void runUntil(TimeMs time);
+
+   private:
+    /* Private data structs */
+    typedef struct Event {
+        TimeMs time;
+        unsigned long long seq;
+        Action action;
+    } Event;
+
+    /* Private data members */
+    std::vector<Event> queue;
+    TimeMs currentTime;
+    unsigned long long nextSeq;
+    unsigned long long processedCount;
+
+    /* Private methods */
+    static bool laterThan(const Event &, const Event &);
+};
+
+#endif /* SIMSCHEDULER_H */
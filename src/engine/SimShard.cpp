@@ -0,0 +1,210 @@
+#include "SimShard.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CarSnapshot.h"
+#include "SimBuilding.h"
+#include "SimElevator.h"
+#include "SimInput.h"
+#include "SimScheduler.h"
+
+const int SimShard::inboxCapacity;
+const int SimShard::snapshotCapacity;
+const int SimShard::logCapacity;
+const int SimShard::publishIntervalMs;
+
+SimShard::SimShard(int floorCount, int firstCarId,
+                   const std::vector<int> &initialFloorNums,
+                   const std::vector<CarConfig> &carConfigs,
+                   SimBuilding::DispatchMode dispatchMode,
+                   long long energyBudgetMs, bool idleParking,
+                   long long parkDelayMs, const std::string &dispatchPolicy,
+                   double timeScale)
+    : firstCarId(firstCarId),
+      carCount(int(initialFloorNums.size())),
+      building(new SimBuilding(floorCount, int(initialFloorNums.size()),
+                               initialFloorNums, carConfigs)),
+      timeScale(timeScale),
+      inbox(inboxCapacity),
+      snapshots(snapshotCapacity),
+      logs(logCapacity),
+      changed(true),
+      droppedLogCount(0),
+      running(false),
+      inputPosted(false) {
+    if (firstCarId < 1) throw "ERROR: Shard car IDs start from 1";
+    if (timeScale <= 0) throw "ERROR: Time scale must be positive";
+
+    building->setDispatchMode(dispatchMode);
+    building->setDispatchPolicy(dispatchPolicy);
+    building->setEnergyBudgetMs(energyBudgetMs);
+    building->setParkDelayMs(parkDelayMs);
+    building->setIdleParking(idleParking);
+
+    /* Watch for changes and messages, on the worker thread */
+    building->hooks.buildingDataChanged = [this]() { changed = true; };
+    building->hooks.hallCallChanged = [this](int, Direction, bool) {
+        changed = true;
+    };
+
+    // The owner has no engine to ask, so assignments are logged to the car.
+    building->hooks.destinationAssigned = [this](int originFloorNum,
+                                                 int destinationFloorNum,
+                                                 int, int carId) {
+        if (carId == 0) return;
+        log(this->firstCarId + carId - 1,
+            "Assigned: floor " + std::to_string(originFloorNum) + " to " +
+                std::to_string(destinationFloorNum));
+    };
+    for (int carId = 1; carId <= carCount; ++carId) {
+        SimElevator &car = building->getElevator_byCarId(carId);
+        int globalCarId = firstCarId + carId - 1;
+
+        car.hooks.carCallChanged = [this](int, bool) { changed = true; };
+        car.hooks.textOut = [this, globalCarId](const std::string &text) {
+            log(globalCarId, text);
+        };
+    }
+
+    // Sent before the worker exists, so this thread is the only producer.
+    publish();
+}
+
+SimShard::~SimShard() { stop(); }
+
+void SimShard::start() {
+    if (running.load() || worker.joinable()) return;
+
+    running.store(true);
+    worker = std::thread(&SimShard::run, this);
+}
+
+void SimShard::stop() {
+    {
+        std::lock_guard<std::mutex> guard(wakeLock);
+        running.store(false);
+    }
+    wake.notify_one();
+    if (worker.joinable()) worker.join();
+}
+
+bool SimShard::post(const SimInput &input) {
+    if (!inbox.tryPush(input)) return false;
+
+    {
+        std::lock_guard<std::mutex> guard(wakeLock);
+        inputPosted = true;
+    }
+    wake.notify_one();
+    return true;
+}
+
+bool SimShard::takeSnapshot(Snapshot &snapshot) {
+    // Only the newest matters, each one is complete.
+    bool taken = false;
+    while (snapshots.tryPop(snapshot)) taken = true;
+    return taken;
+}
+
+bool SimShard::takeLog(LogRecord &record) { return logs.tryPop(record); }
+
+unsigned long long SimShard::droppedLogs() const {
+    return droppedLogCount.load();
+}
+
+void SimShard::log(int carId, const std::string &text) {
+    LogRecord record{building->getScheduler().now(), carId, text};
+    if (!logs.tryPush(std::move(record))) ++droppedLogCount;
+}
+
+void SimShard::publish() {
+    Snapshot snapshot;
+    snapshot.timeMs = building->getScheduler().now();
+    snapshot.cars.reserve(carCount);
+    for (int carId = 1; carId <= carCount; ++carId) {
+        snapshot.cars.push_back(
+            CarSnapshot::of(building->getElevator_byCarId(carId),
+                            snapshot.timeMs));
+        snapshot.cars.back().carId = firstCarId + carId - 1;
+    }
+    snapshot.upCalls = building->getQueuedFloors(Direction::UP);
+    snapshot.downCalls = building->getQueuedFloors(Direction::DOWN);
+
+    // A full queue means the owner is behind; try again next pass.
+    if (snapshots.tryPush(std::move(snapshot))) changed = false;
+}
+
+void SimShard::run() {
+    typedef std::chrono::steady_clock Clock;
+    typedef std::chrono::duration<double, std::milli> Millis;
+
+    const Clock::time_point startTime = Clock::now();
+    Clock::time_point lastPublish =
+        startTime - std::chrono::milliseconds(publishIntervalMs);
+    SimScheduler &scheduler = building->getScheduler();
+
+    auto wallClockSimTime = [&]() {
+        return (long long)(Millis(Clock::now() - startTime).count() *
+                           timeScale);
+    };
+
+    while (running.load(std::memory_order_acquire)) {
+        // Inputs happen at the current wall-clock time in the simulation.
+        SimInput input;
+        while (inbox.tryPop(input)) {
+            scheduler.runUntil(wallClockSimTime());
+
+            if (input.carId != 0) input.carId -= firstCarId - 1;
+            try {
+                input.apply(*building);
+            } catch (const char *error) {
+                log(0, error);
+            }
+            changed = true;
+        }
+
+        scheduler.runUntil(wallClockSimTime());
+
+        // Kinematic cars pass floors between events.
+        bool moving = false;
+        for (int carId = 1; carId <= carCount && !moving; ++carId)
+            moving = building->getElevator_byCarId(carId).isInRun();
+        changed = changed || moving;
+
+        Clock::time_point now = Clock::now();
+        if (changed &&
+            now - lastPublish >= std::chrono::milliseconds(publishIntervalMs)) {
+            publish();
+            lastPublish = now;
+        }
+
+        // Sleep until the next event, and the next publish while there is
+        // one to make. Without either, only an input or stop() wakes it.
+        bool timed = changed || moving || !scheduler.empty();
+        Clock::time_point wakeTime =
+            lastPublish + std::chrono::milliseconds(publishIntervalMs);
+        if (!scheduler.empty()) {
+            Clock::time_point due =
+                startTime + std::chrono::duration_cast<Clock::duration>(
+                                Millis(scheduler.nextEventTime() / timeScale));
+            wakeTime = (changed || moving) ? std::min(wakeTime, due) : due;
+        }
+
+        std::unique_lock<std::mutex> guard(wakeLock);
+        auto woken = [this]() {
+            return inputPosted || !running.load(std::memory_order_acquire);
+        };
+        if (timed)
+            wake.wait_until(guard, wakeTime, woken);
+        else
+            wake.wait(guard, woken);
+        inputPosted = false;
+    }
+}
@@ -0,0 +1,167 @@
+#ifndef SIMSHARD_H
+#define SIMSHARD_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CarConfig.h"
+#include "CarSnapshot.h"
+#include "LogRecord.h"
+#include "SimBuilding.h"
+#include "SimInput.h"
+#include "SpscQueue.h"
+
+/** A group of cars simulated on its own worker thread.
+ *
+ * Owns a SimBuilding holding a contiguous range of the building's cars,
+ * zoned cars forming banks among them as in any SimBuilding, and runs it on
+ * a worker thread with its own event loop: the loop paces the shard's
+ * virtual clock against the wall clock, scaled by timeScale, as Building
+ * does on the GUI thread.
+ *
+ * The shard shares no mutable state with other threads. Inputs arrive over
+ * an SpscQueue from the thread owning the shard, and the worker sends back
+ * complete snapshots of its cars and hall calls, and its log messages, over
+ * two more. Car IDs in inputs, snapshots and messages are the building-wide
+ * IDs; the shard's own SimBuilding numbers its cars from 1. The car a
+ * destination request is assigned to is told as a message from that car.
+ *
+ * Data Members:
+ * + Snapshot: struct
+ *      State of the shard after one pass of its event loop.
+ *      - timeMs: simulated time of the snapshot.
+ *      - cars: state of each car, by index in the shard.
+ *      - upCalls / downCalls: hall calls held by the shard.
+ *
+ * + firstCarId: int
+ *      Building-wide ID of the shard's first car.
+ * + carCount: int
+ *      Number of cars in the shard.
+ *
+ * - building: std::unique_ptr<SimBuilding>
+ *      The shard's cars. Only the worker touches it once started.
+ * - timeScale: double
+ *      Simulated milliseconds per wall-clock millisecond.
+ * - inbox: SpscQueue<SimInput>
+ * - snapshots: SpscQueue<Snapshot>
+ * - logs: SpscQueue<LogRecord>
+ *      Inputs to the worker, and snapshots and messages from it.
+ * - changed: bool
+ *      Worker only. Whether the shard changed since its last snapshot.
+ *      Snapshots are sent at most every publishIntervalMs of wall-clock time,
+ *      the GUI can't show them any faster.
+ * - droppedLogCount: std::atomic<unsigned long long>
+ *      Messages dropped because the log queue was full.
+ * - running: std::atomic<bool>
+ * - worker: std::thread
+ *      The worker thread and its stop flag.
+ * - wakeLock: std::mutex
+ * - wake: std::condition_variable
+ * - inputPosted: bool
+ *      Wake the sleeping worker when an input is posted or the shard stops.
+ *      The queues have no wake-up of their own, and an idle shard shouldn't
+ *      poll them.
+ *
+ * Class Methods:
+ * + start(): void
+ * + stop(): void
+ *      Start the worker thread, or stop it and wait for it to finish.
+ *      Stopped shards can't be restarted. The destructor stops the shard.
+ *      A first snapshot is sent on construction, so the owner can present
+ *      the shard before it starts.
+ *
+ * + post(const SimInput &): bool
+ *      Owner thread only. Sends an input to the worker, applied at the
+ *      simulated time it is received at. Returns false if the inbox is full.
+ * + takeSnapshot(Snapshot &): bool
+ *      Owner thread only. Moves out the newest snapshot, skipping older
+ *      ones, or returns false if none arrived since the last call.
+ * + takeLog(LogRecord &): bool
+ *      Owner thread only. Moves out the oldest message, or returns false.
+ * + droppedLogs(): unsigned long long
+ *      Returns how many messages were dropped so far.
+ *
+ * - run(): void
+ *      The worker's event loop: applies queued inputs, runs every event due
+ *      by the wall clock, publishes, then sleeps until the next event, the
+ *      next publish while a change or a moving car waits for one, or an
+ *      input, whichever comes first. A shard with nothing to do sleeps
+ *      until an input arrives.
+ * - publish(): void
+ *      Sends a snapshot of the shard, if there is room for it.
+ * - log(int, const std::string &): void
+ *      Sends a message, counting it as dropped if there is no room.
+ */
+class SimShard {
+   public:
+    /* Public data structs */
+    typedef struct Snapshot {
+        long long timeMs;
+        std::vector<CarSnapshot> cars;
+        std::vector<int> upCalls;
+        std::vector<int> downCalls;
+    } Snapshot;
+
+    SimShard(int floorCount, int firstCarId,
+             const std::vector<int> &initialFloorNums,
+             const std::vector<CarConfig> &carConfigs,
+             SimBuilding::DispatchMode, long long energyBudgetMs = 0,
+             bool idleParking = false,
+             long long parkDelayMs = SimBuilding::defaultParkDelayMs,
+             const std::string &dispatchPolicy =
+                 SimBuilding::defaultDispatchPolicy,
+             double timeScale = 1.0);
+    ~SimShard();
+
+    SimShard(const SimShard &) = delete;
+    SimShard &operator=(const SimShard &) = delete;
+
+    /* Public data members */
+    const int firstCarId;
+    const int carCount;
+
+    /* Public methods */
+    void start();
+    void stop();
+
+    bool post(const SimInput &);
+    bool takeSnapshot(Snapshot &);
+    bool takeLog(LogRecord &);
+    unsigned long long droppedLogs() const;
+
+   private:
+    /* Private data members */
+    static const int inboxCapacity = 1024;
+    static const int snapshotCapacity = 4;
+    static const int logCapacity = 4096;
+    static const int publishIntervalMs = 8;
+
+    std::unique_ptr<SimBuilding> building;
+    const double timeScale;
+
+    SpscQueue<SimInput> inbox;
+    SpscQueue<Snapshot> snapshots;
+    SpscQueue<LogRecord> logs;
+
+    bool changed;
+    std::atomic<unsigned long long> droppedLogCount;
+
+    std::atomic<bool> running;
+    std::thread worker;
+
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    bool inputPosted;
+
+    /* Private methods */
+    void run();
+    void publish();
+    void log(int carId, const std::string &text);
+};
+
+#endif /* SIMSHARD_H */
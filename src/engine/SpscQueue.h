@@ -0,0 +1,97 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/** Bounded lock-free queue between one producer and one consumer thread.
+ *
+ * A ring of preallocated slots with a head index written only by the
+ * consumer and a tail index written only by the producer. Each side reads
+ * the other's index with acquire and publishes its own with release, so a
+ * value is fully written before the consumer can see it, and fully moved out
+ * before the producer can reuse its slot. Neither side ever blocks: pushing
+ * to a full queue or popping an empty one returns false.
+ *
+ * The indices are padded out to separate cache lines, so the two threads
+ * don't invalidate each other's line on every operation. Padding rather than
+ * alignas keeps the queue allocatable with plain new before C++17.
+ *
+ * Data Members:
+ * - slots: std::vector<T>
+ *      Ring storage, a power of two in size.
+ * - mask: size_t
+ *      Size of the ring minus one, mapping an index to its slot.
+ * - head: std::atomic<size_t>
+ *      Index of the next value to pop. Written by the consumer.
+ * - tail: std::atomic<size_t>
+ *      Index of the next slot to push to. Written by the producer.
+ * - frontPad / headPad / tailPad: char[]
+ *      Keep the indices off the line holding slots and mask, and fill the
+ *      rest of each index's line.
+ *
+ * Class Methods:
+ * + capacity(): size_t
+ *      Returns how many values the queue can hold, the requested capacity
+ *      rounded up to a power of two.
+ * + tryPush(T): bool
+ *      Producer only. Appends a value, or returns false if the queue is full.
+ * + tryPop(T &): bool
+ *      Consumer only. Moves the oldest value out, or returns false if the
+ *      queue is empty.
+ */
+template <typename T>
+class SpscQueue {
+   public:
+    explicit SpscQueue(size_t capacity)
+        : slots(roundUp(capacity)), mask(slots.size() - 1), head(0), tail(0) {}
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /* Public methods */
+    size_t capacity() const { return slots.size(); }
+
+    bool tryPush(T value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == slots.size())
+            return false;
+
+        slots[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T &value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+
+        value = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+   private:
+    /* Private data members */
+    std::vector<T> slots;
+    const size_t mask;
+
+    static const size_t cacheLineSize = 64;
+
+    char frontPad[cacheLineSize];
+    std::atomic<size_t> head;
+    char headPad[cacheLineSize - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> tail;
+    char tailPad[cacheLineSize - sizeof(std::atomic<size_t>)];
+
+    /* Private methods */
+    static size_t roundUp(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        return size;
+    }
+};
+
+#endif /* SPSCQUEUE_H */
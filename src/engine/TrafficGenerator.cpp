@@ -0,0 +1,440 @@
+#include "TrafficGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "FloorBitset.h"
+#include "SimBuilding.h"
+#include "SimElevator.h"
+
+namespace {
+
+const int lobbyFloorNum = 1;
+
+// Passenger weights
+const double meanMassKg = 75;
+const double massSpreadKg = 15;
+const int minMassKg = 40;
+const int maxMassKg = 150;
+
+// Weights putting all demand on one floor, or spreading it evenly over a range
+// of floor numbers.
+std::vector<double> onlyFloor(int floorCount, int floorNum) {
+    std::vector<double> weights(floorCount, 0.0);
+    weights[floorNum - 1] = 1.0;
+    return weights;
+}
+
+std::vector<double> floorRange(int floorCount, int fromFloorNum,
+                               int toFloorNum) {
+    std::vector<double> weights(floorCount, 0.0);
+    for (int floorNum = fromFloorNum; floorNum <= toFloorNum; ++floorNum)
+        weights[floorNum - 1] = 1.0;
+    return weights;
+}
+
+}  // namespace
+
+TrafficGenerator::TrafficGenerator(SimBuilding *building, unsigned seed)
+    : building(building),
+      rng(seed),
+      waiting(building->floorCount),
+      riding(building->elevatorCount),
+      leftBehindFloorNums(building->elevatorCount, 0),
+      alive(std::make_shared<bool>(true)),
+      running(false),
+      arrivalGeneration(0),
+      generatedCount(0),
+      deliveredCount(0) {
+    if (building->floorCount < 2)
+        throw "ERROR: Traffic needs at least two floors";
+
+    setProfile(Profile::INTERFLOOR);
+    building->addObserver(this);
+}
+
+TrafficGenerator::~TrafficGenerator() {
+    *alive = false;
+    building->removeObserver(this);
+}
+
+void TrafficGenerator::setProfile(Profile profile) {
+    int floorCount = building->floorCount;
+    std::vector<double> all = floorRange(floorCount, 1, floorCount);
+
+    flows.clear();
+    if (profile == Profile::INTERFLOOR) {
+        flows.push_back(Flow{std::discrete_distribution<int>(all.begin(),
+                                                             all.end()),
+                             std::discrete_distribution<int>(all.begin(),
+                                                             all.end())});
+        flowPicker = std::discrete_distribution<int>({1.0});
+        return;
+    }
+
+    // Lobby to upper floors, between upper floors, upper floors to lobby
+    std::vector<double> lobby = onlyFloor(floorCount, lobbyFloorNum);
+    std::vector<double> upper =
+        floorRange(floorCount, lobbyFloorNum + 1, floorCount);
+
+    flows.push_back(
+        Flow{std::discrete_distribution<int>(lobby.begin(), lobby.end()),
+             std::discrete_distribution<int>(upper.begin(), upper.end())});
+    flows.push_back(
+        Flow{std::discrete_distribution<int>(upper.begin(), upper.end()),
+             std::discrete_distribution<int>(upper.begin(), upper.end())});
+    flows.push_back(
+        Flow{std::discrete_distribution<int>(upper.begin(), upper.end()),
+             std::discrete_distribution<int>(lobby.begin(), lobby.end())});
+
+    if (profile == Profile::UP_PEAK)
+        flowPicker = std::discrete_distribution<int>({0.85, 0.10, 0.05});
+    else
+        flowPicker = std::discrete_distribution<int>({0.05, 0.10, 0.85});
+}
+
+void TrafficGenerator::setOriginDestinationMatrix(
+    const std::vector<std::vector<double>> &weights) {
+    int floorCount = building->floorCount;
+    if (int(weights.size()) != floorCount)
+        throw "ERROR: Origin-destination matrix must have a row per floor";
+
+    // One flow per origin floor, picked by the row's total weight.
+    std::vector<Flow> rowFlows;
+    std::vector<double> rowTotals;
+    for (int f_ind = 0; f_ind < floorCount; ++f_ind) {
+        const std::vector<double> &row = weights[f_ind];
+        if (int(row.size()) != floorCount)
+            throw "ERROR: Origin-destination matrix must have a column per "
+                  "floor";
+
+        double total = 0;
+        for (int d_ind = 0; d_ind < floorCount; ++d_ind) {
+            if (row[d_ind] < 0)
+                throw "ERROR: Origin-destination weights can't be negative";
+            if (d_ind != f_ind) total += row[d_ind];
+        }
+        if (total == 0) continue;
+
+        // Trips to the same floor are never generated.
+        std::vector<double> destinations(row);
+        destinations[f_ind] = 0;
+
+        std::vector<double> origin = onlyFloor(floorCount, f_ind + 1);
+        rowFlows.push_back(Flow{
+            std::discrete_distribution<int>(origin.begin(), origin.end()),
+            std::discrete_distribution<int>(destinations.begin(),
+                                            destinations.end())});
+        rowTotals.push_back(total);
+    }
+
+    if (rowFlows.empty())
+        throw "ERROR: Origin-destination matrix has no trips between floors";
+
+    flows.swap(rowFlows);
+    flowPicker =
+        std::discrete_distribution<int>(rowTotals.begin(), rowTotals.end());
+}
+
+void TrafficGenerator::setRateSchedule(const std::vector<RatePoint> &points) {
+    for (size_t p_ind = 0; p_ind < points.size(); ++p_ind) {
+        if (points[p_ind].passengersPerMinute < 0)
+            throw "ERROR: Passenger arrival rate can't be negative";
+        if (p_ind > 0 && points[p_ind].timeMs <= points[p_ind - 1].timeMs)
+            throw "ERROR: Rate schedule times must be ascending";
+    }
+    rates = points;
+
+    // Arrivals already scheduled were sampled from the old rates.
+    if (running) {
+        stop();
+        start();
+    }
+}
+
+void TrafficGenerator::setConstantRate(double passengersPerMinute) {
+    setRateSchedule({RatePoint{0, passengersPerMinute}});
+}
+
+void TrafficGenerator::start() {
+    if (running) return;
+    running = true;
+    scheduleNextArrival();
+}
+
+void TrafficGenerator::stop() {
+    if (!running) return;
+    running = false;
+    ++arrivalGeneration;  // Orphans the arrival already scheduled
+}
+
+unsigned long long TrafficGenerator::passengersGenerated() const {
+    return generatedCount;
+}
+
+unsigned long long TrafficGenerator::passengersWaiting() const {
+    unsigned long long count = 0;
+    for (const std::deque<Passenger> &floorQueue : waiting)
+        count += floorQueue.size();
+    return count;
+}
+
+unsigned long long TrafficGenerator::passengersRiding() const {
+    unsigned long long count = 0;
+    for (const std::vector<Passenger> &carLoad : riding)
+        count += carLoad.size();
+    return count;
+}
+
+unsigned long long TrafficGenerator::passengersDelivered() const {
+    return deliveredCount;
+}
+
+double TrafficGenerator::rateAt(long long timeMs,
+                                long long &nextChangeMs) const {
+    // Rates are few; a linear walk is fine.
+    double rate = 0;
+    nextChangeMs = -1;
+    for (const RatePoint &point : rates) {
+        if (point.timeMs > timeMs) {
+            nextChangeMs = point.timeMs;
+            break;
+        }
+        rate = point.passengersPerMinute;
+    }
+    return rate;
+}
+
+void TrafficGenerator::scheduleNextArrival() {
+    SimScheduler &scheduler = building->getScheduler();
+    long long now = scheduler.now();
+
+    long long nextChangeMs;
+    double perMinute = rateAt(now, nextChangeMs);
+
+    // Arrivals are memoryless, so when the rate changes before the next
+    // arrival, sampling simply restarts from the change with the new rate.
+    long long delayMs = -1;
+    bool arrival = false;
+    if (perMinute > 0) {
+        std::exponential_distribution<double> gap(perMinute / 60000.0);
+        double sampledMs = std::ceil(gap(rng));
+        if (nextChangeMs < 0 || now + sampledMs < nextChangeMs) {
+            delayMs = (long long)sampledMs;
+            arrival = true;
+        }
+    }
+    if (!arrival) {
+        if (nextChangeMs < 0) return;  // No arrivals ever again
+        delayMs = nextChangeMs - now;
+    }
+
+    std::shared_ptr<bool> token = alive;
+    unsigned generation = arrivalGeneration;
+    scheduler.schedule(delayMs, [this, token, generation, arrival]() {
+        if (!*token || generation != arrivalGeneration) return;
+        if (arrival) generatePassenger();
+        scheduleNextArrival();
+    });
+}
+
+void TrafficGenerator::generatePassenger() {
+    Flow &flow = flows[flowPicker(rng)];
+
+    int originFloorNum = flow.origins(rng) + 1;
+    int destinationFloorNum = flow.destinations(rng) + 1;
+    while (destinationFloorNum == originFloorNum)
+        destinationFloorNum = flow.destinations(rng) + 1;
+
+    std::normal_distribution<double> mass(meanMassKg, massSpreadKg);
+    int massKg = std::max(minMassKg,
+                          std::min(maxMassKg, int(std::lround(mass(rng)))));
+
+    int legFloorNum =
+        building->legFloorNum(originFloorNum, destinationFloorNum);
+    if (legFloorNum == FloorBitset::NO_FLOOR) return;
+
+    Passenger passenger{generatedCount++, originFloorNum,
+                        destinationFloorNum, legFloorNum, massKg,
+                        building->getScheduler().now(), -1, 0};
+    waiting[originFloorNum - 1].push_back(passenger);
+
+    // Without destination dispatch, the kiosk presses the hall call for the
+    // passenger. With it, the car assigned is told through
+    // destinationAssigned().
+    building->requestDestination(originFloorNum, destinationFloorNum);
+}
+
+void TrafficGenerator::elevatorArrived(const SimElevator &car) {
+    int floorNum = car.currentFloorNum;
+    SimElevator &stopped = building->getElevator_byCarId(car.carId);
+    std::vector<Passenger> &load = riding[car.carId - 1];
+    int loadKg = car.getLoadKg();
+    int transfers = 0;
+
+    // Riders for this floor alight, some of them to change cars.
+    std::vector<Passenger> changing;
+    for (size_t p_ind = 0; p_ind < load.size();) {
+        if (load[p_ind].legFloorNum == floorNum) {
+            if (load[p_ind].destinationFloorNum == floorNum) {
+                for (SimObserver *observer : building->getObservers())
+                    observer->passengerAlighted(car, load[p_ind]);
+                ++deliveredCount;
+            } else {
+                changing.push_back(load[p_ind]);
+            }
+
+            loadKg -= load[p_ind].massKg;
+            ++transfers;
+            load[p_ind] = load.back();
+            load.pop_back();
+        } else {
+            ++p_ind;
+        }
+    }
+
+    // Passengers board in turn while the car looks to have room, and press
+    // their destinations. Not again on the same stop: a car that keeps
+    // reopening there has left the rest behind already. Only those whose leg
+    // the car serves board; with destination dispatch, only those assigned
+    // to the car, if it picked them up.
+    std::deque<Passenger> &floorQueue = waiting[floorNum - 1];
+    int &leftBehind = leftBehindFloorNums[car.carId - 1];
+    bool assigned = building->getDispatchMode() ==
+                    SimBuilding::DispatchMode::DESTINATION;
+    bool boarding =
+        assigned ? building->canServeHallCalls(car) : car.isInService();
+    if (!floorQueue.empty() && boarding && leftBehind != floorNum) {
+        long long now = building->getScheduler().now();
+        for (size_t p_ind = 0; p_ind < floorQueue.size();) {
+            Passenger passenger = floorQueue[p_ind];
+            if ((assigned && passenger.carId != car.carId) ||
+                !car.servesFloor(passenger.legFloorNum)) {
+                ++p_ind;
+                continue;
+            }
+            if (int(load.size()) >= car.ratedPersons()) break;
+            ++transfers;
+
+            // Too heavy: the weighing device trips once the passenger is in,
+            // and they step back off.
+            if (loadKg + passenger.massKg > car.config.ratedLoadKg) {
+                stepOff(car.carId, passenger.massKg,
+                        transfers++ * (long long)car.config.transferMs);
+                break;
+            }
+            floorQueue.erase(floorQueue.begin() + p_ind);
+            loadKg += passenger.massKg;
+
+            // A passenger changing cars boarded their first one already.
+            passenger.carId = car.carId;
+            if (passenger.boardedMs < 0) {
+                passenger.boardedMs = now;
+                for (SimObserver *observer : building->getObservers())
+                    observer->passengerBoarded(car, passenger);
+            }
+
+            load.push_back(passenger);
+            stopped.setCarCall(passenger.legFloorNum, true);
+        }
+    }
+
+    // The building clears this floor's hall calls in the car's bank once it
+    // has stopped, and takes up the requests of those assigned to it.
+    // Whoever is left calls again once it has gone, see movementChanged().
+    // Those waiting for another bank keep their calls.
+    for (const Passenger &passenger : floorQueue)
+        if ((!assigned || (boarding && passenger.carId == car.carId)) &&
+            car.servesFloor(passenger.legFloorNum))
+            leftBehind = floorNum;
+
+    // Those changing cars wait here for their next leg.
+    for (Passenger &passenger : changing) {
+        passenger.legFloorNum =
+            building->legFloorNum(floorNum, passenger.destinationFloorNum);
+        passenger.carId = 0;
+        floorQueue.push_back(passenger);
+        requestLegLater(floorNum, passenger.destinationFloorNum);
+    }
+
+    stopped.setLoad(loadKg, int(load.size()));
+    if (transfers > 0)
+        stopped.holdDoors(transfers * (long long)car.config.transferMs);
+}
+
+void TrafficGenerator::movementChanged(const SimElevator &car) {
+    int &leftBehind = leftBehindFloorNums[car.carId - 1];
+    if (!car.isMoving() || leftBehind == 0) return;
+
+    // Passengers left behind call again once the car has gone, so they
+    // aren't handed straight back to it.
+    pressHallCallsLater(leftBehind, car.carId);
+    leftBehind = 0;
+}
+
+void TrafficGenerator::destinationAssigned(int originFloorNum,
+                                           int destinationFloorNum,
+                                           int prevCarId, int carId) {
+    // Passengers with the same leg and car are interchangeable.
+    for (Passenger &passenger : waiting[originFloorNum - 1]) {
+        if (passenger.legFloorNum == destinationFloorNum &&
+            passenger.carId == prevCarId) {
+            passenger.carId = carId;
+            return;
+        }
+    }
+}
+
+void TrafficGenerator::pressHallCallsLater(int floorNum, int carId) {
+    std::shared_ptr<bool> token = alive;
+    building->getScheduler().schedule(0, [this, token, floorNum, carId]() {
+        if (!*token) return;
+
+        // At a kiosk, only those the car left behind ask again.
+        if (building->getDispatchMode() ==
+            SimBuilding::DispatchMode::DESTINATION) {
+            for (Passenger &passenger : waiting[floorNum - 1]) {
+                if (passenger.carId != carId) continue;
+                passenger.carId = 0;
+                building->requestDestination(floorNum,
+                                             passenger.destinationFloorNum);
+            }
+            return;
+        }
+
+        for (const Passenger &passenger : waiting[floorNum - 1])
+            building->requestDestination(floorNum,
+                                         passenger.destinationFloorNum);
+    });
+}
+
+void TrafficGenerator::requestLegLater(int floorNum, int destinationFloorNum) {
+    std::shared_ptr<bool> token = alive;
+    building->getScheduler().schedule(
+        0, [this, token, floorNum, destinationFloorNum]() {
+            if (!*token) return;
+            building->requestDestination(floorNum, destinationFloorNum);
+        });
+}
+
+void TrafficGenerator::stepOff(int carId, int massKg, long long delayMs) {
+    // On the scale once in, off it again a transfer later.
+    std::shared_ptr<bool> token = alive;
+    building->getScheduler().schedule(delayMs, [this, token, carId, massKg]() {
+        if (!*token) return;
+        SimElevator &car = building->getElevator_byCarId(carId);
+        car.setLoad(car.getLoadKg() + massKg, car.getPassengerCount() + 1);
+
+        building->getScheduler().schedule(
+            car.config.transferMs, [this, token, carId, massKg]() {
+                if (!*token) return;
+                SimElevator &weighed = building->getElevator_byCarId(carId);
+                weighed.setLoad(weighed.getLoadKg() - massKg,
+                                weighed.getPassengerCount() - 1);
+            });
+    });
+}
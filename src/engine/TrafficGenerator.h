@@ -0,0 +1,209 @@
+#ifndef TRAFFICGENERATOR_H
+#define TRAFFICGENERATOR_H
+
+#include <deque>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Passenger.h"
+#include "SimObserver.h"
+
+// Forward declarations
+class SimBuilding;
+class SimElevator;
+
+/** Seeded passenger demand for a SimBuilding.
+ *
+ * Generates passenger arrivals as a Poisson process whose rate follows a
+ * piecewise-constant schedule, each with an origin and destination floor
+ * drawn from the configured demand. Arriving passengers press the hall call
+ * towards their destination; when any car stops at their floor they board and
+ * press their destination on its panel, and alight when it stops there.
+ * The building's observers are told as passengers board and alight.
+ *
+ * Passengers have a weight, and cars carry the load of their riders. They
+ * board in turn while a car looks to have room, judged by the persons its
+ * rated load allows; the car's weighing device still trips if their actual
+ * weight is too much, and the last one in steps back off. Each passenger
+ * boarding or alighting holds the doors for the car's transferMs. Passengers
+ * a car leaves behind call again once it has departed.
+ *
+ * In a zoned building, passengers only board cars stopping at the end of
+ * their leg (see SimBuilding::legFloorNum()), and those changing cars get off
+ * at the transfer floor and call again there. They are reported boarding
+ * their first car and alighting from their last, so the metrics measure the
+ * whole trip. Trips between floors no banks connect are not generated.
+ *
+ * Under destination dispatch (SimBuilding::DispatchMode::DESTINATION),
+ * passengers enter their destination at the floor's kiosk instead, and only
+ * board the car assigned to them, which already knows where they go.
+ * Arrivals are scheduled on the building's SimScheduler, so the generator
+ * runs at whatever pace the scheduler is driven.
+ *
+ * Enums:
+ * + Profile
+ *      Built-in demand patterns, the lobby being floor 1.
+ *      - UP_PEAK: 85% lobby to upper floors, 10% between upper floors, 5%
+ *        upper floors to lobby.
+ *      - DOWN_PEAK: the mirror image, 85% upper floors to lobby.
+ *      - INTERFLOOR: uniform origins and destinations.
+ *
+ * Data Members:
+ * + RatePoint: struct
+ *      Arrival rate, in passengers per minute, applying from a simulated time
+ *      until the next point.
+ *
+ * - Flow: struct
+ *      Share of the demand with its own origin and destination weights.
+ *
+ * - building: SimBuilding *
+ *      Building the passengers travel in. Must outlive the generator.
+ * - rng: std::mt19937
+ *      Generator-owned random engine, seeded on construction.
+ * - flows: std::vector<Flow>
+ * - flowPicker: std::discrete_distribution<int>
+ *      Demand, as flows picked by their share.
+ * - rates: std::vector<RatePoint>
+ *      Arrival rate schedule, ascending in time.
+ * - waiting: std::vector<std::deque<Passenger>>
+ *      Passengers waiting at each floor, indexed by floor number - 1.
+ * - riding: std::vector<std::vector<Passenger>>
+ *      Passengers in each car, indexed by car ID - 1.
+ * - leftBehindFloorNums: std::vector<int>
+ *      Floor each car left passengers waiting at on its current stop, or 0,
+ *      indexed by car ID - 1.
+ * - alive: std::shared_ptr<bool>
+ *      Token captured by scheduled events, cleared when the generator is
+ *      destroyed so events left in the scheduler do nothing.
+ * - running: bool
+ *      Whether arrivals are being generated.
+ * - arrivalGeneration: unsigned
+ *      Incremented on stop(), orphaning the arrival already scheduled.
+ * - generatedCount / deliveredCount: unsigned long long
+ *      Passengers generated and delivered to their destination so far.
+ *
+ * Class Methods:
+ * + setProfile(Profile): void
+ *      Replaces the demand with a built-in profile.
+ * + setOriginDestinationMatrix(std::vector<std::vector<double>>): void
+ *      Replaces the demand with a floorCount x floorCount matrix of relative
+ *      trip weights, row = origin floor - 1, column = destination floor - 1.
+ * + setRateSchedule(std::vector<RatePoint>): void
+ * + setConstantRate(double): void
+ *      Replaces the arrival rate schedule. Before the first point the rate is
+ *      zero; after the last point its rate applies indefinitely.
+ *
+ * + start(): void
+ *      Schedules arrivals from the scheduler's current time.
+ * + stop(): void
+ *      Cancels further arrivals. Passengers already generated keep going.
+ *
+ * + passengersGenerated(): unsigned long long
+ * + passengersWaiting(): unsigned long long
+ * + passengersRiding(): unsigned long long
+ * + passengersDelivered(): unsigned long long
+ *      Passenger counts by journey stage.
+ *
+ * + elevatorArrived(const SimElevator &): void
+ *      SimObserver override. Riders for this floor alight, waiting passengers
+ *      board and press their destinations, and the car's load and door hold
+ *      are updated.
+ * + movementChanged(const SimElevator &): void
+ *      SimObserver override. Passengers a departing car left behind call
+ *      again.
+ * + destinationAssigned(int, int, int, int): void
+ *      SimObserver override. Moves a waiting passenger with the trip to the
+ *      car assigned.
+ *
+ * - rateAt(long long, long long &): double
+ *      Returns the arrival rate at a time, and when it next changes.
+ * - scheduleNextArrival(): void
+ *      Samples the next arrival time and schedules it.
+ * - generatePassenger(): void
+ *      Draws a trip and a weight, queues the passenger and presses their hall
+ *      call, or requests their destination at the kiosk.
+ * - pressHallCallsLater(int, int): void
+ *      Presses the hall calls of everyone waiting at a floor, once the
+ *      current event is done. At a kiosk, the passengers assigned to the car
+ *      (by ID) request their destinations again instead.
+ * - requestLegLater(int, int): void
+ *      Has a passenger who changes cars at a floor call for the next leg to
+ *      their destination, once the current event is done.
+ * - stepOff(int, int, long long): void
+ *      After a delay, weighs a passenger of the given weight in a car (by
+ *      ID), and takes them off the scale again a transfer later.
+ */
+class TrafficGenerator : public SimObserver {
+   public:
+    /* Public enums */
+    enum class Profile { UP_PEAK, DOWN_PEAK, INTERFLOOR };
+
+    /* Public data structs */
+    typedef struct RatePoint {
+        long long timeMs;
+        double passengersPerMinute;
+    } RatePoint;
+
+    TrafficGenerator(SimBuilding *building, unsigned seed);
+    ~TrafficGenerator() override;
+
+    TrafficGenerator(const TrafficGenerator &) = delete;
+    TrafficGenerator &operator=(const TrafficGenerator &) = delete;
+
+    /* Public methods */
+    void setProfile(Profile);
+    void setOriginDestinationMatrix(
+        const std::vector<std::vector<double>> &weights);
+    void setRateSchedule(const std::vector<RatePoint> &);
+    void setConstantRate(double passengersPerMinute);
+
+    void start();
+    void stop();
+
+    unsigned long long passengersGenerated() const;
+    unsigned long long passengersWaiting() const;
+    unsigned long long passengersRiding() const;
+    unsigned long long passengersDelivered() const;
+
+    void elevatorArrived(const SimElevator &) override;
+    void movementChanged(const SimElevator &) override;
+    void destinationAssigned(int originFloorNum, int destinationFloorNum,
+                             int prevCarId, int carId) override;
+
+   private:
+    /* Private data structs */
+    typedef struct Flow {
+        std::discrete_distribution<int> origins;
+        std::discrete_distribution<int> destinations;
+    } Flow;
+
+    /* Private data members */
+    SimBuilding *const building;
+    std::mt19937 rng;
+
+    std::vector<Flow> flows;
+    std::discrete_distribution<int> flowPicker;
+    std::vector<RatePoint> rates;
+
+    std::vector<std::deque<Passenger>> waiting;
+    std::vector<std::vector<Passenger>> riding;
+    std::vector<int> leftBehindFloorNums;
+
+    std::shared_ptr<bool> alive;
+    bool running;
+    unsigned arrivalGeneration;
+
+    unsigned long long generatedCount;
+    unsigned long long deliveredCount;
+
+    /* Private methods */
+    double rateAt(long long timeMs, long long &nextChangeMs) const;
+    void scheduleNextArrival();
+    void generatePassenger();
+    void pressHallCallsLater(int floorNum, int carId);
+    void requestLegLater(int floorNum, int destinationFloorNum);
+    void stepOff(int carId, int massKg, long long delayMs);
+};
+
+#endif /* TRAFFICGENERATOR_H */
@@ -0,0 +1,70 @@
+#include "TrajectoryDigest.h"
+
+#include <cstdint>
+
+#include "SimBuilding.h"
+#include "SimElevator.h"
+
+namespace {
+
+const uint64_t fnvOffset = 14695981039346656037ULL;
+const uint64_t fnvPrime = 1099511628211ULL;
+
+// Event tags, so different events with equal operands hash apart.
+enum EventTag { HALL_CALL = 1, CAR_CALL, ARRIVED, MOVEMENT, DOOR };
+
+}  // namespace
+
+TrajectoryDigest::TrajectoryDigest(SimBuilding *building)
+    : building(building), hash(fnvOffset) {
+    building->addObserver(this);
+}
+
+TrajectoryDigest::~TrajectoryDigest() { building->removeObserver(this); }
+
+uint64_t TrajectoryDigest::value() const { return hash; }
+
+void TrajectoryDigest::mix(long long value) {
+    for (int byte = 0; byte < 8; ++byte) {
+        hash ^= uint64_t(value >> (8 * byte)) & 0xff;
+        hash *= fnvPrime;
+    }
+}
+
+void TrajectoryDigest::mixEvent(int tag, const SimElevator &car) {
+    mix(tag);
+    mix(building->getScheduler().now());
+    mix(car.carId);
+    mix(car.currentFloorNum);
+    mix(int(car.getMovement()));
+    mix(int(car.getDoorState()));
+    mix(int(car.getEmergency()));
+}
+
+void TrajectoryDigest::hallCallChanged(int floorNum, Direction dir,
+                                       bool active) {
+    mix(HALL_CALL);
+    mix(building->getScheduler().now());
+    mix(floorNum);
+    mix(int(dir));
+    mix(active);
+}
+
+void TrajectoryDigest::carCallChanged(const SimElevator &car, int floorNum,
+                                      bool active) {
+    mixEvent(CAR_CALL, car);
+    mix(floorNum);
+    mix(active);
+}
+
+void TrajectoryDigest::elevatorArrived(const SimElevator &car) {
+    mixEvent(ARRIVED, car);
+}
+
+void TrajectoryDigest::movementChanged(const SimElevator &car) {
+    mixEvent(MOVEMENT, car);
+}
+
+void TrajectoryDigest::doorStateChanged(const SimElevator &car) {
+    mixEvent(DOOR, car);
+}
@@ -0,0 +1,66 @@
+#ifndef TRAJECTORYDIGEST_H
+#define TRAJECTORYDIGEST_H
+
+#include <cstdint>
+
+#include "SimObserver.h"
+
+// Forward declarations
+class SimBuilding;
+class SimElevator;
+
+/** Running hash of everything that happens in a simulation.
+ *
+ * Observer folding every event (hall and car calls, arrivals, movement and
+ * door changes), with its simulated time, car and resulting state, into a
+ * 64-bit FNV-1a hash. Two runs with equal digests took the same trajectory,
+ * so a replay can be checked against its recording.
+ *
+ * Data Members:
+ * - building: SimBuilding *
+ *      Building observed. Must outlive the digest.
+ * - hash: uint64_t
+ *      Digest of the events so far.
+ *
+ * Class Methods:
+ * + value(): uint64_t
+ *      Returns the digest of the events so far.
+ *
+ * + hallCallChanged, carCallChanged, elevatorArrived, movementChanged,
+ *   doorStateChanged: void
+ *      SimObserver overrides folding the event into the digest.
+ *
+ * - mix(long long): void
+ *      Folds a value into the digest, byte by byte.
+ * - mixEvent(int, const SimElevator &): void
+ *      Folds an event tag, the time and the car's state into the digest.
+ */
+class TrajectoryDigest : public SimObserver {
+   public:
+    explicit TrajectoryDigest(SimBuilding *building);
+    ~TrajectoryDigest() override;
+
+    TrajectoryDigest(const TrajectoryDigest &) = delete;
+    TrajectoryDigest &operator=(const TrajectoryDigest &) = delete;
+
+    /* Public methods */
+    uint64_t value() const;
+
+    void hallCallChanged(int floorNum, Direction, bool active) override;
+    void carCallChanged(const SimElevator &, int floorNum,
+                        bool active) override;
+    void elevatorArrived(const SimElevator &) override;
+    void movementChanged(const SimElevator &) override;
+    void doorStateChanged(const SimElevator &) override;
+
+   private:
+    /* Private data members */
+    SimBuilding *const building;
+    uint64_t hash;
+
+    /* Private methods */
+    void mix(long long);
+    void mixEvent(int tag, const SimElevator &);
+};
+
+#endif /* TRAJECTORYDIGEST_H */
@@ -0,0 +1,128 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Pool and worker index of the current thread, if it is a worker.
+thread_local const WorkStealingPool *currentPool = nullptr;
+thread_local unsigned currentWorker = 0;
+
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(unsigned count)
+    : queued(0), unfinished(0), stopping(false), nextWorker(0) {
+    if (count == 0) count = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned w_ind = 0; w_ind < count; ++w_ind)
+        workers.emplace_back(new Worker);
+    for (unsigned w_ind = 0; w_ind < count; ++w_ind)
+        threads.emplace_back(&WorkStealingPool::workerLoop, this, w_ind);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (std::thread &thread : threads) thread.join();
+}
+
+unsigned WorkStealingPool::threadCount() const {
+    return unsigned(threads.size());
+}
+
+void WorkStealingPool::submit(Task task) {
+    unsigned target;
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        if (currentPool == this) {
+            target = currentWorker;  // Keep spawned work local
+        } else {
+            target = nextWorker;
+            nextWorker = (nextWorker + 1) % workers.size();
+        }
+        ++unfinished;
+
+        // Counted while holding stateLock, so sleeping workers can't miss it.
+        std::lock_guard<std::mutex> workerGuard(workers[target]->lock);
+        workers[target]->tasks.push_back(std::move(task));
+        ++queued;
+    }
+    workAvailable.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> guard(stateLock);
+    allDone.wait(guard, [this]() { return unfinished == 0; });
+
+    if (firstError) {
+        std::exception_ptr error = firstError;
+        firstError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+bool WorkStealingPool::takeTask(unsigned self, Task &task) {
+    // Own newest task first, while it's likely still in cache
+    {
+        Worker &own = *workers[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --queued;
+            return true;
+        }
+    }
+
+    // Then steal the oldest task of another worker
+    for (size_t offset = 1; offset < workers.size(); ++offset) {
+        Worker &victim = *workers[(self + offset) % workers.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --queued;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(unsigned self) {
+    currentPool = this;
+    currentWorker = self;
+
+    for (;;) {
+        Task task;
+        if (!takeTask(self, task)) {
+            std::unique_lock<std::mutex> guard(stateLock);
+            workAvailable.wait(guard,
+                               [this]() { return stopping || queued > 0; });
+            if (stopping && queued == 0) return;
+            continue;
+        }
+
+        std::exception_ptr error;
+        try {
+            task();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> guard(stateLock);
+        if (error && !firstError) firstError = error;
+        if (--unfinished == 0) allDone.notify_all();
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** Fixed-size thread pool balancing tasks by work stealing.
+ *
+ * Every worker thread owns a task deque. Tasks submitted from outside the
+ * pool are dealt round-robin to the workers; tasks submitted by a running
+ * task go to its own worker. A worker runs its newest task first, and when
+ * out of tasks steals the oldest task of another worker, so uneven tasks
+ * keep every thread busy. Idle workers sleep until tasks are submitted.
+ *
+ * Data Members:
+ * + Task: std::function<void()>
+ *
+ * - Worker: struct
+ *      A worker's task deque and the lock guarding it.
+ * - workers: std::vector<std::unique_ptr<Worker>>
+ * - threads: std::vector<std::thread>
+ *      Worker deques and threads, by worker index.
+ *
+ * - stateLock: std::mutex
+ * - workAvailable: std::condition_variable
+ * - allDone: std::condition_variable
+ *      Sleeping and waking of idle workers and of wait().
+ * - queued: std::atomic<size_t>
+ *      Tasks sitting in a deque.
+ * - unfinished: size_t
+ *      Tasks submitted and not yet finished. Guarded by stateLock.
+ * - stopping: bool
+ *      Set when the pool is destroyed. Guarded by stateLock.
+ * - nextWorker: unsigned
+ *      Worker receiving the next outside submission. Guarded by stateLock.
+ * - firstError: std::exception_ptr
+ *      First exception thrown by a task since the last wait().
+ *
+ * Class Methods:
+ * + threadCount(): unsigned
+ *      Number of worker threads.
+ * + submit(Task): void
+ *      Queues a task.
+ * + wait(): void
+ *      Blocks until every task submitted so far has finished. Rethrows the
+ *      first exception a task threw, if any. Must not be called by a task.
+ *
+ * - takeTask(unsigned, Task &): bool
+ *      Takes a task for a worker, its own newest or another's oldest.
+ * - workerLoop(unsigned): void
+ *      Body of a worker thread.
+ */
+class WorkStealingPool {
+   public:
+    typedef std::function<void()> Task;
+
+    // 0 threads uses one per hardware thread.
+    explicit WorkStealingPool(unsigned threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    /* Public methods */
+    unsigned threadCount() const;
+
+    void submit(Task);
+    void wait();
+
+   private:
+    /* Private data structs */
+    typedef struct Worker {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    } Worker;
+
+    /* Private data members */
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex stateLock;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
+    std::atomic<size_t> queued;
+    size_t unfinished;
+    bool stopping;
+    unsigned nextWorker;
+    std::exception_ptr firstError;
+
+    /* Private methods */
+    bool takeTask(unsigned self, Task &);
+    void workerLoop(unsigned self);
+};
+
+#endif /* WORKSTEALINGPOOL_H */
@@ -0,0 +1,65 @@
+# Widget-free simulation engine. Plain C++, no Qt dependency, so it can be
+# included in headless targets as well as the GUI.
+
+# Worker threads for parallel replications and engine shards
+CONFIG += thread
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/BuildingConfig.cpp \
+    $$PWD/CarSnapshot.cpp \
+    $$PWD/DemandModel.cpp \
+    $$PWD/EnergyModel.cpp \
+    $$PWD/EtaMatrix.cpp \
+    $$PWD/FleetState.cpp \
+    $$PWD/FlightTable.cpp \
+    $$PWD/FloorBitset.cpp \
+    $$PWD/InputJournal.cpp \
+    $$PWD/LogFileSink.cpp \
+    $$PWD/LogHistogram.cpp \
+    $$PWD/MetricsReport.cpp \
+    $$PWD/MonteCarloRunner.cpp \
+    $$PWD/ShardedEngine.cpp \
+    $$PWD/SimBuilding.cpp \
+    $$PWD/SimElevator.cpp \
+    $$PWD/SimInput.cpp \
+    $$PWD/SimMetrics.cpp \
+    $$PWD/SimScheduler.cpp \
+    $$PWD/SimShard.cpp \
+    $$PWD/TrafficGenerator.cpp \
+    $$PWD/TrajectoryDigest.cpp \
+    $$PWD/WorkStealingPool.cpp
+
+HEADERS += \
+    $$PWD/BuildingConfig.h \
+    $$PWD/CarConfig.h \
+    $$PWD/CarSnapshot.h \
+    $$PWD/DemandModel.h \
+    $$PWD/Direction.h \
+    $$PWD/DispatchPolicy.h \
+    $$PWD/EnergyModel.h \
+    $$PWD/EtaMatrix.h \
+    $$PWD/FleetState.h \
+    $$PWD/FlightTable.h \
+    $$PWD/FloorBitset.h \
+    $$PWD/InputJournal.h \
+    $$PWD/LogFileSink.h \
+    $$PWD/LogHistogram.h \
+    $$PWD/LogRecord.h \
+    $$PWD/MetricsReport.h \
+    $$PWD/MonteCarloRunner.h \
+    $$PWD/Passenger.h \
+    $$PWD/ShardedEngine.h \
+    $$PWD/SimBuilding.h \
+    $$PWD/SimElevator.h \
+    $$PWD/SimInput.h \
+    $$PWD/SimMetrics.h \
+    $$PWD/SimObserver.h \
+    $$PWD/SimScheduler.h \
+    $$PWD/SimShard.h \
+    $$PWD/SpscQueue.h \
+    $$PWD/TrafficGenerator.h \
+    $$PWD/TrajectoryDigest.h \
+    $$PWD/WorkStealingPool.h
@@ -1,10 +1,251 @@
 #include <QApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QStringList>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "Building.h"
+#include "BuildingConfig.h"
+#include "InputJournal.h"
+#include "SimBuilding.h"
+#include "SimMetrics.h"
+#include "TrajectoryDigest.h"
 #include "mainwindow.h"
 
+namespace {
+
+// Beyond this many button widgets, auto mode paints buttons instead.
+const long long maxButtonWidgets = 2000;
+
+// Registered dispatch policy names, as "a, b or c"
+std::string policyList() {
+    std::vector<std::string> names = SimBuilding::dispatchPolicyNames();
+    std::string list;
+    for (size_t n_ind = 0; n_ind < names.size(); ++n_ind) {
+        if (n_ind > 0) list += n_ind + 1 < names.size() ? ", " : " or ";
+        list += names[n_ind];
+    }
+    return list;
+}
+
+// Replays a journal headless and at full speed, then reports the run.
+int replayJournal(const QString &path, const QString &dispatch,
+                  const QString &policy) {
+    std::ifstream in(path.toStdString(), std::ios::binary);
+    if (!in) {
+        std::cerr << "Can't open " << path.toStdString() << "\n";
+        return 1;
+    }
+
+    try {
+        InputJournal journal = InputJournal::load(in);
+        std::unique_ptr<SimBuilding> building = journal.createBuilding();
+
+        // Another dispatch mode or policy takes another trajectory, so the
+        // recorded digest only verifies replays under the recorded ones.
+        bool overridden = !dispatch.isEmpty() || !policy.isEmpty();
+        if (dispatch == "nearest")
+            building->setDispatchMode(SimBuilding::DispatchMode::NEAREST_CALL);
+        else if (dispatch == "group")
+            building->setDispatchMode(SimBuilding::DispatchMode::GROUP);
+        else if (dispatch == "destination")
+            building->setDispatchMode(SimBuilding::DispatchMode::DESTINATION);
+        else if (!dispatch.isEmpty())
+            throw "ERROR: Dispatch mode must be group, nearest or destination";
+        if (!policy.isEmpty())
+            building->setDispatchPolicy(policy.toStdString());
+
+        TrajectoryDigest digest(building.get());
+        SimMetrics metrics(building.get());
+        journal.replay(*building);
+
+        bool verifiable = !overridden && journal.hasStoredDigest();
+        bool matches = digest.value() == journal.getDigest();
+
+        std::cout << "Inputs: " << journal.getEntries().size() << "\n"
+                  << "End time: " << journal.getEndMs() << " ms\n"
+                  << "Digest: "
+                  << (!verifiable ? "not verified"
+                                  : matches ? "matches recording" : "MISMATCH")
+                  << "\n";
+        metrics.writeJson(std::cout);
+        std::cout << "\n";
+
+        return (verifiable && !matches) ? 2 : 0;
+    } catch (const char *error) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+}
+
+// Builds the building profile from --config, --floors, --cars, --set,
+// --dispatch and --policy, later options overriding earlier ones. Throws on
+// bad settings.
+BuildingConfig loadConfig(const QCommandLineParser &parser) {
+    BuildingConfig config;
+
+    if (parser.isSet("config")) {
+        std::ifstream in(parser.value("config").toStdString());
+        if (!in) throw "ERROR: Can't open building profile";
+        config = BuildingConfig::load(in);
+    }
+    if (parser.isSet("floors"))
+        config.set("floors", parser.value("floors").toStdString());
+    if (parser.isSet("cars"))
+        config.set("cars", parser.value("cars").toStdString());
+    for (const QString &setting : parser.values("set")) {
+        int equals = setting.indexOf('=');
+        if (equals < 0) throw "ERROR: --set takes key=value";
+        config.set(setting.left(equals).trimmed().toStdString(),
+                   setting.mid(equals + 1).trimmed().toStdString());
+    }
+    if (parser.isSet("dispatch"))
+        config.set("dispatch", parser.value("dispatch").toStdString());
+    if (parser.isSet("policy"))
+        config.set("policy", parser.value("policy").toStdString());
+
+    // Fails here rather than in the GUI if a setting doesn't fit the size.
+    config.carConfigs();
+    return config;
+}
+
+}  // namespace
+
 int main(int argc, char *argv[]) {
+    QStringList arguments;
+    for (int a_ind = 0; a_ind < argc; ++a_ind)
+        arguments << QString::fromLocal8Bit(argv[a_ind]);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption recordOption(
+        "record", "Record every input to <file> for replay.", "file");
+    QCommandLineOption replayOption(
+        "replay", "Replay <file> headless and print its metrics.", "file");
+    QCommandLineOption dispatchOption(
+        "dispatch",
+        "Dispatch <mode>: group, nearest or destination. Overrides the "
+        "building profile, or the recording when replaying.",
+        "mode");
+    QCommandLineOption policyOption(
+        "policy",
+        "Dispatch policy <name> cars pick their next floor by: " +
+            QString::fromStdString(policyList()) +
+            ". Overrides the building profile, or the recording when "
+            "replaying.",
+        "name");
+    QCommandLineOption buttonsOption(
+        "buttons",
+        "Show buttons as <mode>: widgets, delegate, or auto to paint them "
+        "for large buildings.",
+        "mode", "auto");
+    QCommandLineOption configOption(
+        "config", "Load the building profile <file>.", "file");
+    QCommandLineOption floorsOption("floors", "Number of floors.", "count");
+    QCommandLineOption carsOption("cars", "Number of elevators.", "count");
+    QCommandLineOption logFileOption(
+        "log-file", "Also write the event log to <file> as JSON Lines.",
+        "file");
+    QCommandLineOption logLinesOption(
+        "log-lines", "Show at most <count> event log lines.", "count",
+        "1000");
+    QCommandLineOption setOption(
+        "set", "Building profile setting, e.g. doorWaitMs=2000. Repeatable.",
+        "key=value");
+    QCommandLineOption shardsOption(
+        "shards",
+        "Simulate the cars on <count> worker threads, 0 for the GUI thread. "
+        "Sharded runs can't be recorded.",
+        "count", "0");
+    parser.addOption(recordOption);
+    parser.addOption(replayOption);
+    parser.addOption(dispatchOption);
+    parser.addOption(policyOption);
+    parser.addOption(buttonsOption);
+    parser.addOption(configOption);
+    parser.addOption(floorsOption);
+    parser.addOption(carsOption);
+    parser.addOption(setOption);
+    parser.addOption(logFileOption);
+    parser.addOption(logLinesOption);
+    parser.addOption(shardsOption);
+    parser.parse(arguments);
+
+    if (parser.isSet("help")) {
+        std::cout << parser.helpText().toStdString();
+        return 0;
+    }
+
+    // Replays need no display, so they run before any GUI exists.
+    if (parser.isSet(replayOption))
+        return replayJournal(parser.value(replayOption),
+                             parser.value(dispatchOption),
+                             parser.value(policyOption));
+
+    BuildingConfig config;
+    try {
+        config = loadConfig(parser);
+    } catch (const char *error) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+
+    bool validShards;
+    int shards = parser.value(shardsOption).toInt(&validShards);
+    if (!validShards || shards < 0 || shards > config.elevatorCount) {
+        std::cerr << "Shards must be from 0 to the number of elevators\n";
+        return 1;
+    }
+    if (shards > 0 && parser.isSet(recordOption)) {
+        std::cerr << "Sharded runs can't be recorded\n";
+        return 1;
+    }
+
+    // Delegate-painted buttons keep large buildings fast to start and scroll.
+    QString buttons = parser.value(buttonsOption);
+    long long buttonWidgets =
+        (long long)config.elevatorCount * (config.floorCount + 6) +
+        2LL * config.floorCount;
+    if (buttons == "auto")
+        buttons = buttonWidgets > maxButtonWidgets ? "delegate" : "widgets";
+    if (buttons != "widgets" && buttons != "delegate") {
+        std::cerr << "Buttons mode must be widgets, delegate or auto\n";
+        return 1;
+    }
+
     QApplication a(argc, argv);
-    MainWindow w;
+    MainWindow w(config,
+                 buttons == "delegate" ? Building::ButtonMode::DELEGATE
+                                       : Building::ButtonMode::WIDGETS,
+                 shards);
+    try {
+        bool validLines;
+        int logLines = parser.value(logLinesOption).toInt(&validLines);
+        if (!validLines) throw "ERROR: Event log lines must be a number";
+        w.getLogModel()->setCapacity(logLines);
+
+        if (parser.isSet(logFileOption))
+            w.openLogFile(parser.value(logFileOption).toStdString());
+    } catch (const char *error) {
+        std::cerr << error << "\n";
+        return 1;
+    }
     w.show();
-    return a.exec();
+    int status = a.exec();
+
+    if (parser.isSet(recordOption)) {
+        std::ofstream out(parser.value(recordOption).toStdString(),
+                          std::ios::binary);
+        w.getBuildingModel()->finishedJournal().save(out);
+        if (!out) {
+            std::cerr << "Can't write "
+                      << parser.value(recordOption).toStdString() << "\n";
+            return 1;
+        }
+    }
+    return status;
 }
@@ -1,25 +1,54 @@
 #include "mainwindow.h"
 
+#include <algorithm>
+
+#include <QAbstractItemView>
 #include <QBoxLayout>
+#include <QHeaderView>
 #include <QLCDNumber>
 #include <QLabel>
-#include <QScrollBar>
+#include <QListView>
+#include <QPushButton>
 #include <QSizePolicy>
+#include <QSpinBox>
 #include <QString>
 #include <QVector>
 #include <QVectorIterator>
 #include <QWidget>
 
 #include "Building.h"
+#include "BuildingConfig.h"
+#include "ButtonDelegate.h"
+#include "DataButton.h"
 #include "Elevator.h"
+#include "EventLogModel.h"
+#include "FloorBitset.h"
+#include "LogFileSink.h"
+#include "LogRecord.h"
+#include "SimBuilding.h"
+#include "SimInput.h"
 #include "ui_mainwindow.h"
 
-MainWindow::MainWindow(QWidget *parent)
+MainWindow::MainWindow(const BuildingConfig &config,
+                       Building::ButtonMode buttonMode, int shardCount,
+                       QWidget *parent)
     : QMainWindow(parent), ui(new Ui::MainWindow) {
     ui->setupUi(this);
 
+    // Button states are styled by one sheet, parsed once for every button.
+    setStyleSheet(DataButton::styleSheet());
+
     /* Initialize building data model */
-    buildingModel = new Building(FLOOR_COUNT, ELEVATOR_COUNT, 4, 1);
+    buildingModel = new Building(config, 4, 1, buttonMode, shardCount);
+    bool delegateButtons = buttonMode == Building::ButtonMode::DELEGATE;
+
+    /* Initialize event log view */
+    logModel = new EventLogModel(1000, this);
+    ui->logView->setModel(logModel);
+
+    // Follow the newest messages, as a console would.
+    connect(logModel, &EventLogModel::rowsInserted, ui->logView,
+            &QListView::scrollToBottom);
 
     /* Initialize building view */
     buildingView = ui->buildingView;
@@ -27,21 +56,42 @@ MainWindow::MainWindow(QWidget *parent)
     // Make rows and columns stretch to parent
     buildingView->setModel(buildingModel);
 
-    // Set sizes for columns
-    buildingView->horizontalHeader()->setSectionResizeMode(
-        QHeaderView::ResizeToContents);
-    buildingView->horizontalHeader()->setMinimumSectionSize(150);
-    buildingView->horizontalHeader()->setMaximumSectionSize(150);
-
-    // Set sizes for rows
-    buildingView->verticalHeader()->setMinimumSectionSize(50);
-    buildingView->verticalHeader()->setSectionResizeMode(
-        QHeaderView::ResizeToContents);
-
-    // Add buttons for each floor in the building UI.
-    for (int f = 0; f < buildingModel->floorCount; ++f) {
-        addIndexWidgets(f, buildingModel->elevatorCount,
-                        buildingModel->getFloorButtons_byIndex(f));
+    if (delegateButtons) {
+        buildingView->setItemDelegate(
+            new ButtonDelegate(buildingModel, buildingView));
+        buildingView->setSelectionMode(QAbstractItemView::NoSelection);
+
+        // Fixed sizes, so the view never measures every row and column.
+        buildingView->horizontalHeader()->setSectionResizeMode(
+            QHeaderView::Fixed);
+        buildingView->horizontalHeader()->setDefaultSectionSize(150);
+        buildingView->verticalHeader()->setSectionResizeMode(
+            QHeaderView::Fixed);
+        buildingView->verticalHeader()->setDefaultSectionSize(50);
+
+        // Car panel rows are measured once.
+        for (int row = buildingModel->floorCount;
+             row < buildingModel->rowCount(); ++row)
+            buildingView->resizeRowToContents(row);
+    } else {
+        // Set sizes for columns
+        buildingView->horizontalHeader()->setSectionResizeMode(
+            QHeaderView::ResizeToContents);
+        buildingView->horizontalHeader()->setMinimumSectionSize(150);
+        buildingView->horizontalHeader()->setMaximumSectionSize(150);
+
+        // Set sizes for rows
+        buildingView->verticalHeader()->setMinimumSectionSize(50);
+        buildingView->verticalHeader()->setSectionResizeMode(
+            QHeaderView::ResizeToContents);
+    }
+
+    // Add buttons for each floor in the building UI, unless delegate-painted.
+    if (!delegateButtons) {
+        for (int f = 0; f < buildingModel->floorCount; ++f) {
+            addIndexWidgets(f, buildingModel->elevatorCount,
+                            buildingModel->getFloorButtons_byIndex(f));
+        }
     }
 
     // Add building-wide emergency simulation buttons.
@@ -57,6 +107,10 @@ MainWindow::MainWindow(QWidget *parent)
         buildingButtonLayout->addWidget(i.next());
     }
 
+    // Destination dispatch takes requests at a kiosk instead.
+    if (config.dispatchMode == SimBuilding::DispatchMode::DESTINATION)
+        addDestinationKiosk();
+
     /**
      * Add panel and display buttons for each elevator, connect to text output,
      * add buttons to simulate emergency situations.
@@ -64,13 +118,15 @@ MainWindow::MainWindow(QWidget *parent)
     for (int e = 0; e < buildingModel->elevatorCount; ++e) {
         Elevator *el = buildingModel->getElevator_byIndex(e);
 
-        // Receive text output signals for displaying in inline console
-        connect(el, &Elevator::textOut, this, [e, this](const QString &text) {
-            this->inlineConsoleDisplay(
-                QString("Elevator %1: ")
-                    .arg(this->buildingModel->index_to_carId(e))
-                    .append(text));
-        });
+        // Receive text output signals for the event log
+        int carId = buildingModel->index_to_carId(e);
+        connect(el, &Elevator::textOut, this,
+                [carId, this](const QString &text) {
+                    this->logMessage(carId, text);
+                });
+
+        // Delegate-painted car panels need no widgets.
+        if (delegateButtons) continue;
 
         // Row to put widgets on
         int addRowIndex = buildingModel->floorCount;
@@ -102,13 +158,13 @@ MainWindow::MainWindow(QWidget *parent)
         textDisplay->setWordWrap(true);
 
         // Initial values
-        floorDisplay->display(el->currentFloorNum);
+        floorDisplay->display(el->currentFloorNum());
         textDisplay->setText(el->getTextDisplay());
 
         // Update displays when there is a change to elevator data
         connect(el, &Elevator::elevatorDataChanged, floorDisplay,
                 [el, floorDisplay, textDisplay]() {
-                    floorDisplay->display(el->currentFloorNum);
+                    floorDisplay->display(el->currentFloorNum());
                     textDisplay->setText(el->getTextDisplay());
                 });
 
@@ -131,6 +187,8 @@ MainWindow::~MainWindow() {
     delete ui;
 }
 
+Building *MainWindow::getBuildingModel() { return buildingModel; }
+
 void MainWindow::addIndexWidgets(int rowIndex, int colIndex,
                                  QVector<QWidget *> widgetsToAdd,
                                  QBoxLayout::Direction layoutType) {
@@ -172,11 +230,70 @@ void MainWindow::addIndexWidgets(int rowIndex, int colIndex,
                                      newContainer);
 }
 
-void MainWindow::inlineConsoleDisplay(const QString &text) {
-    QLabel *prevTextLabel = ui->textOutput;
-    prevTextLabel->setText(QString("%1\n%2").arg(prevTextLabel->text(), text));
+void MainWindow::addDestinationKiosk() {
+    QSpinBox *originBox = new QSpinBox();
+    QSpinBox *destinationBox = new QSpinBox();
+    QPushButton *requestButton = new QPushButton("Request");
+    QLabel *assignmentLabel = new QLabel("Choose floors");
+
+    originBox->setRange(1, buildingModel->floorCount);
+    originBox->setPrefix("From F");
+    destinationBox->setRange(1, buildingModel->floorCount);
+    destinationBox->setPrefix("To F");
+    destinationBox->setValue(std::min(2, buildingModel->floorCount));
+    assignmentLabel->setMinimumWidth(150);
+
+    connect(requestButton, &QPushButton::clicked, this,
+            [this, originBox, destinationBox, assignmentLabel]() {
+                int originFloorNum = originBox->value();
+                int destinationFloorNum = destinationBox->value();
+                if (originFloorNum == destinationFloorNum) {
+                    assignmentLabel->setText("Choose another floor");
+                    return;
+                }
+
+                // Zoned cars may not link the floors.
+                if (buildingModel->legFloorNum(originFloorNum,
+                                               destinationFloorNum) ==
+                    FloorBitset::NO_FLOOR) {
+                    assignmentLabel->setText("No elevator links those floors");
+                    return;
+                }
+
+                // Answered by destinationAssigned, unless no car is free.
+                assignmentLabel->setText(buildingModel->isSharded()
+                                             ? "Sent, see the log"
+                                             : "Please wait");
+                buildingModel->applyInput(SimInput::destinationCall(
+                    originFloorNum, destinationFloorNum));
+            });
+    connect(buildingModel, &Building::destinationAssigned, assignmentLabel,
+            [assignmentLabel](int originFloorNum, int destinationFloorNum,
+                              int carId) {
+                if (carId == 0) return;
+                assignmentLabel->setText(QString("F%1 to F%2: Elevator %3")
+                                             .arg(originFloorNum)
+                                             .arg(destinationFloorNum)
+                                             .arg(carId));
+            });
+
+    QHBoxLayout *buildingButtonLayout = ui->buildingButtonLayout;
+    buildingButtonLayout->addWidget(originBox);
+    buildingButtonLayout->addWidget(destinationBox);
+    buildingButtonLayout->addWidget(requestButton);
+    buildingButtonLayout->addWidget(assignmentLabel);
+}
+
+EventLogModel *MainWindow::getLogModel() { return logModel; }
+
+void MainWindow::openLogFile(const std::string &path) {
+    logSink.reset(new LogFileSink(path));
+}
+
+void MainWindow::logMessage(int carId, const QString &text) {
+    LogRecord record{buildingModel->simulatedTimeMs(), carId,
+                     text.toStdString()};
 
-    // Scroll to the bottom of the inline terminal.
-    QScrollBar *sb = ui->outputScroll->verticalScrollBar();
-    sb->setValue(sb->maximum());
+    if (logSink) logSink->write(record);
+    logModel->append(record);
 }
@@ -6,8 +6,13 @@
 #include <QTableView>
 #include <QVector>
 #include <QWidget>
+#include <memory>
+#include <string>
 
-class Building;
+#include "Building.h"
+#include "BuildingConfig.h"
+#include "EventLogModel.h"
+#include "LogFileSink.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -17,12 +22,13 @@ QT_END_NAMESPACE
 
 /** Main Qt Window
  *
- * Data Members:
- * - FLOOR_COUNT: int
- * - ELEVATOR_COUNT: int
- *      Program constants. GUI can accommodate for any number of floors and
- *      elevators (minimum 1 for each). Must be modified before compiling.
+ * Shows the building described by a BuildingConfig. GUI can accommodate for
+ * any number of floors and elevators (minimum 1 for each). Large buildings
+ * should use Building::ButtonMode::DELEGATE, which paints the floor and car
+ * panel buttons instead of creating widgets, and may split their cars over
+ * shardCount worker threads (0 runs them on the GUI thread).
  *
+ * Data Members:
  * - ui: Ui::MainWindow *
  *      Qt MainWindow object.
  *
@@ -30,42 +36,66 @@ QT_END_NAMESPACE
  * - buildingView: QTableView *
  *      Model/View for Building to be displayed in the main window.
  *
+ * - logModel: EventLogModel *
+ *      Bounded log of the elevators' messages, shown in the log view.
+ * - logSink: std::unique_ptr<LogFileSink>
+ *      File the messages are also written to, if one was opened.
+ *
  * Class Methods:
+ * + getBuildingModel(): Building *
+ *      Returns the building model shown in the window.
+ * + getLogModel(): EventLogModel *
+ *      Returns the event log model, e.g. to set its capacity.
+ * + openLogFile(const std::string &): void
+ *      Also writes every message to a file, as JSON Lines on a background
+ *      thread. Throws if the file can't be opened.
+ *
  * - addIndexWidgets(int rowIndex, int colIndex,
  *                   QVector<QWidget *> widgetsToAdd,
  *                   QBoxLayout::Direction layoutType): void
  *      Adds widgets to the building view at the specified index.
  *      Horizontal layout unless specified otherwise.
+ * - addDestinationKiosk(): void
+ *      Adds a destination dispatch kiosk next to the building buttons: pick
+ *      an origin and destination floor, request, and read the elevator to
+ *      take. Stands in for the kiosks of every floor.
  *
  * Slots:
- * - inlineConsoleDisplay(const QString &): void
- *      Prints specified text to the text log in the UI.
+ * - logMessage(int, const QString &): void
+ *      Adds a car's message, stamped with the simulated time, to the event
+ *      log and the log file.
  */
 class MainWindow : public QMainWindow {
     Q_OBJECT
 
    public:
-    MainWindow(QWidget *parent = nullptr);
+    explicit MainWindow(
+        const BuildingConfig &config = BuildingConfig(),
+        Building::ButtonMode buttonMode = Building::ButtonMode::WIDGETS,
+        int shardCount = 0, QWidget *parent = nullptr);
     ~MainWindow();
 
-   private:
-    /* PROGRAM CONSTANTS */
-    // GUI can accommodate any number of floors or elevators, must be recompiled
-    // every time consts are changed.
-    static const int FLOOR_COUNT = 7;
-    static const int ELEVATOR_COUNT = 3;
+    /* Public methods */
+    Building *getBuildingModel();
+    EventLogModel *getLogModel();
+    void openLogFile(const std::string &path);
 
+   private:
     /* Private data members */
     Ui::MainWindow *ui;
     Building *buildingModel;
     QTableView *buildingView;
 
+    EventLogModel *logModel;
+    std::unique_ptr<LogFileSink> logSink;
+
     /* Private methods */
     void addIndexWidgets(
         int rowIndex, int colIndex, QVector<QWidget *> widgetsToAdd,
         QBoxLayout::Direction layoutType = QBoxLayout::Direction::LeftToRight);
+    void addDestinationKiosk();
 
    private slots:
-    void inlineConsoleDisplay(const QString &text);
+    void logMessage(int carId, const QString &text);
 };
 #endif  // MAINWINDOW_H